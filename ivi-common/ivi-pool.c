@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026 The wayland-ivi-extension contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ivi-pool.h"
+
+union ivi_pool_align {
+    long long ll;
+    long double ld;
+    void *p;
+};
+
+#define IVI_POOL_ALIGN(size) \
+    (((size) + sizeof(union ivi_pool_align) - 1) & \
+     ~(sizeof(union ivi_pool_align) - 1))
+
+struct ivi_pool_slab {
+    struct ivi_pool_slab *next;
+};
+
+struct ivi_pool_object {
+    struct ivi_pool_object *next;
+};
+
+static size_t
+pool_stride(const struct ivi_pool *pool)
+{
+    size_t size = pool->object_size;
+
+    if (size < sizeof(struct ivi_pool_object))
+        size = sizeof(struct ivi_pool_object);
+
+    return IVI_POOL_ALIGN(size);
+}
+
+static int
+pool_grow(struct ivi_pool *pool)
+{
+    size_t header = IVI_POOL_ALIGN(sizeof(struct ivi_pool_slab));
+    size_t stride = pool_stride(pool);
+    uint32_t count = pool->objects_per_slab ? pool->objects_per_slab : 1;
+    struct ivi_pool_slab *slab;
+    char *objects;
+    uint32_t i;
+
+    slab = malloc(header + stride * count);
+    if (slab == NULL)
+        return -1;
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->stats.slabs++;
+
+    /* thread the new objects in address order onto the free list */
+    objects = (char *)slab + header;
+    for (i = count; i > 0; i--) {
+        struct ivi_pool_object *obj =
+            (struct ivi_pool_object *)(objects + stride * (i - 1));
+
+        obj->next = pool->free_list;
+        pool->free_list = obj;
+    }
+
+    return 0;
+}
+
+void *
+ivi_pool_zalloc(struct ivi_pool *pool)
+{
+    struct ivi_pool_object *obj;
+
+    if (pool->free_list == NULL && pool_grow(pool) < 0)
+        return NULL;
+
+    obj = pool->free_list;
+    pool->free_list = obj->next;
+
+    pool->stats.allocs++;
+    pool->stats.in_use++;
+    if (pool->stats.in_use > pool->stats.peak)
+        pool->stats.peak = pool->stats.in_use;
+
+    memset(obj, 0, pool->object_size);
+    return obj;
+}
+
+void
+ivi_pool_free(struct ivi_pool *pool, void *object)
+{
+    struct ivi_pool_object *obj = object;
+
+    if (obj == NULL)
+        return;
+
+    obj->next = pool->free_list;
+    pool->free_list = obj;
+
+    pool->stats.frees++;
+    pool->stats.in_use--;
+}
+
+void
+ivi_pool_get_stats(const struct ivi_pool *pool, struct ivi_pool_stats *stats)
+{
+    *stats = pool->stats;
+}
+
+int
+ivi_pool_release(struct ivi_pool *pool)
+{
+    struct ivi_pool_slab *slab, *next;
+
+    if (pool->stats.in_use != 0)
+        return -1;
+
+    for (slab = pool->slabs; slab != NULL; slab = next) {
+        next = slab->next;
+        free(slab);
+    }
+
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->stats.slabs = 0;
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 The wayland-ivi-extension contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef IVI_COMMON_IVI_POOL_H_
+#define IVI_COMMON_IVI_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fixed-size object pool. Objects are carved out of slabs which are only
+ * returned to the heap by ivi_pool_release(), so churning objects of the
+ * same type reuses memory instead of going through malloc/free.
+ * Shared by ivi-controller and ilmControl. Not thread safe; the compositor
+ * only touches it from the main loop, ilmControl with the context mutex held.
+ */
+
+struct ivi_pool_slab;
+struct ivi_pool_object;
+
+struct ivi_pool_stats {
+    uint32_t in_use;
+    uint32_t peak;
+    uint32_t slabs;
+    uint64_t allocs;
+    uint64_t frees;
+};
+
+struct ivi_pool {
+    const char *name;
+    size_t object_size;
+    uint32_t objects_per_slab;
+
+    struct ivi_pool_slab *slabs;
+    struct ivi_pool_object *free_list;
+
+    struct ivi_pool_stats stats;
+};
+
+#define IVI_POOL_INITIALIZER(type, per_slab) \
+    { .name = #type, .object_size = sizeof(type), .objects_per_slab = (per_slab) }
+
+/* returns zeroed memory, or NULL if a new slab could not be allocated */
+void *
+ivi_pool_zalloc(struct ivi_pool *pool);
+
+void
+ivi_pool_free(struct ivi_pool *pool, void *object);
+
+/* copies the current statistics, e.g. to report them while running */
+void
+ivi_pool_get_stats(const struct ivi_pool *pool, struct ivi_pool_stats *stats);
+
+/* frees all slabs; only allowed once no object is in use */
+int
+ivi_pool_release(struct ivi_pool *pool);
+
+#endif /* IVI_COMMON_IVI_POOL_H_ */
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2026 The wayland-ivi-extension contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "ivi-trace.h"
+
+static uint64_t
+get_monotonic_nsec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+struct ivi_trace *
+ivi_trace_create(uint32_t size)
+{
+    struct ivi_trace *trace;
+    uint32_t count = 1;
+
+    if (size == 0)
+        return NULL;
+
+    while (count < size && count < (1u << 31))
+        count <<= 1;
+
+    trace = calloc(1, sizeof *trace);
+    if (trace == NULL)
+        return NULL;
+
+    trace->events = calloc(count, sizeof *trace->events);
+    if (trace->events == NULL) {
+        free(trace);
+        return NULL;
+    }
+
+    trace->mask = count - 1;
+    trace->pid = getpid();
+
+    return trace;
+}
+
+void
+ivi_trace_destroy(struct ivi_trace *trace)
+{
+    if (trace == NULL)
+        return;
+
+    free(trace->events);
+    free(trace);
+}
+
+void
+ivi_trace_event(struct ivi_trace *trace, enum ivi_trace_phase phase,
+                const char *name, uint64_t id,
+                const char *arg_name, uint32_t arg)
+{
+    struct ivi_trace_event *event;
+    uint64_t slot;
+
+    if (trace == NULL)
+        return;
+
+    /* the oldest events are overwritten */
+    slot = __atomic_fetch_add(&trace->head, 1, __ATOMIC_RELAXED);
+    event = &trace->events[slot & trace->mask];
+
+    /* seqlock, the dump skips the event until seq is published again */
+    __atomic_store_n(&event->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    event->time_ns = get_monotonic_nsec();
+    event->name = name;
+    event->arg_name = arg_name;
+    event->arg = arg;
+    event->id = id;
+    event->tid = (pid_t)syscall(SYS_gettid);
+    event->phase = (char)phase;
+    __atomic_store_n(&event->seq, slot + 1, __ATOMIC_RELEASE);
+}
+
+struct ivi_trace_scope
+ivi_trace_scope_begin(struct ivi_trace *trace, const char *name)
+{
+    struct ivi_trace_scope scope = {
+        .trace = trace,
+        .name = name,
+    };
+
+    ivi_trace_event(trace, IVI_TRACE_BEGIN, name, 0, NULL, 0);
+    return scope;
+}
+
+void
+ivi_trace_scope_end(struct ivi_trace_scope *scope)
+{
+    ivi_trace_event(scope->trace, IVI_TRACE_END, scope->name, 0, NULL, 0);
+}
+
+static void
+write_event(FILE *fp, struct ivi_trace *trace,
+            const struct ivi_trace_event *event, int first)
+{
+    fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"ivi\",\"ph\":\"%c\","
+            "\"ts\":%llu.%03u,\"pid\":%d,\"tid\":%d",
+            first ? "" : ",\n",
+            event->name, event->phase,
+            (unsigned long long)(event->time_ns / 1000),
+            (unsigned)(event->time_ns % 1000),
+            (int)trace->pid, (int)event->tid);
+
+    /* ids are strings, JSON numbers lose precision above 2^53 */
+    switch (event->phase) {
+    case IVI_TRACE_FLOW_START:
+    case IVI_TRACE_FLOW_STEP:
+        fprintf(fp, ",\"id\":\"0x%llx\"", (unsigned long long)event->id);
+        break;
+    case IVI_TRACE_FLOW_END:
+        /* bind to the enclosing slice instead of the next one */
+        fprintf(fp, ",\"id\":\"0x%llx\",\"bp\":\"e\"",
+                (unsigned long long)event->id);
+        break;
+    case IVI_TRACE_INSTANT:
+        fprintf(fp, ",\"s\":\"t\"");
+        break;
+    default:
+        break;
+    }
+
+    if (event->arg_name != NULL)
+        fprintf(fp, ",\"args\":{\"%s\":%u}", event->arg_name, event->arg);
+
+    fprintf(fp, "}");
+}
+
+/* copies the event of index i, returns 0 if it is not completely written */
+static int
+read_event(struct ivi_trace *trace, uint64_t i, struct ivi_trace_event *copy)
+{
+    struct ivi_trace_event *event = &trace->events[i & trace->mask];
+
+    if (__atomic_load_n(&event->seq, __ATOMIC_ACQUIRE) != i + 1)
+        return 0;
+
+    memcpy(copy, event, sizeof *copy);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    /* overwritten by a writer which wrapped around while copying */
+    return __atomic_load_n(&event->seq, __ATOMIC_RELAXED) == i + 1;
+}
+
+int
+ivi_trace_dump(struct ivi_trace *trace, const char *filename)
+{
+    struct ivi_trace_event event;
+    uint64_t first, head, i;
+    int written = 0;
+    FILE *fp;
+
+    if (trace == NULL || filename == NULL)
+        return -1;
+
+    fp = fopen(filename, "w");
+    if (fp == NULL)
+        return -1;
+
+    head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+    first = 0;
+    if (head > (uint64_t)trace->mask + 1)
+        first = head - trace->mask - 1;
+
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (i = first; i < head; i++) {
+        if (read_event(trace, i, &event))
+            write_event(fp, trace, &event, !written++);
+    }
+    fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    return fclose(fp) == 0 ? 0 : -1;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 The wayland-ivi-extension contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef IVI_COMMON_IVI_TRACE_H_
+#define IVI_COMMON_IVI_TRACE_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Ring buffer of trace events, written out in the Chrome trace event JSON
+ * format, which chrome://tracing and the Perfetto UI can open. Timestamps
+ * are CLOCK_MONOTONIC, so the traces of the compositor and of ilmControl
+ * clients line up when they are loaded together. Flow events with the same
+ * id connect the slices of different processes.
+ * Shared by the compositor and ilmControl. Writers reserve their slot with
+ * an atomic increment, so several threads record without taking a lock.
+ */
+
+enum ivi_trace_phase {
+    IVI_TRACE_BEGIN = 'B',
+    IVI_TRACE_END = 'E',
+    IVI_TRACE_INSTANT = 'i',
+    IVI_TRACE_FLOW_START = 's',
+    IVI_TRACE_FLOW_STEP = 't',
+    IVI_TRACE_FLOW_END = 'f',
+};
+
+struct ivi_trace_event {
+    /* index of the event plus one once it is written, 0 while it is */
+    uint64_t seq;
+    uint64_t time_ns;
+    /* name and arg_name must be string literals or live as long as the trace */
+    const char *name;
+    const char *arg_name;
+    uint64_t id;
+    uint32_t arg;
+    pid_t tid;
+    char phase;
+};
+
+struct ivi_trace {
+    struct ivi_trace_event *events;
+    uint32_t mask;
+    uint64_t head;
+    pid_t pid;
+};
+
+struct ivi_trace_scope {
+    struct ivi_trace *trace;
+    const char *name;
+};
+
+/* size is rounded up to a power of two, returns NULL for a size of 0 */
+struct ivi_trace *
+ivi_trace_create(uint32_t size);
+
+void
+ivi_trace_destroy(struct ivi_trace *trace);
+
+/* ignored if trace is NULL, so callers do not need to check if tracing is on */
+void
+ivi_trace_event(struct ivi_trace *trace, enum ivi_trace_phase phase,
+                const char *name, uint64_t id,
+                const char *arg_name, uint32_t arg);
+
+/* events which are overwritten while they are dumped are left out */
+int
+ivi_trace_dump(struct ivi_trace *trace, const char *filename);
+
+struct ivi_trace_scope
+ivi_trace_scope_begin(struct ivi_trace *trace, const char *name);
+
+void
+ivi_trace_scope_end(struct ivi_trace_scope *scope);
+
+/* begin event now and end event when the enclosing block is left */
+#define IVI_TRACE_SCOPE(trace, name) \
+    struct ivi_trace_scope ivi_trace_scope_ \
+        __attribute__((cleanup(ivi_trace_scope_end))) = \
+        ivi_trace_scope_begin((trace), (name))
+
+#endif /* IVI_COMMON_IVI_TRACE_H_ */
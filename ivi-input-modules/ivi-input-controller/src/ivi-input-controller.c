@@ -82,8 +82,23 @@ struct input_context {
     struct wl_listener surface_destroyed;
     struct wl_listener compositor_destroy_listener;
     struct wl_listener seat_create_listener;
+
+    /* registered with the request statistics of ivishell */
+    struct ivi_stats_table stats;
+};
+
+enum input_request {
+    INPUT_REQUEST_SET_INPUT_FOCUS,
+    INPUT_REQUEST_SET_INPUT_ACCEPTANCE,
 };
 
+#define INPUT_STATS_SCOPE(ctx, request, client) \
+    IVI_TRACE_SCOPE((ctx)->ivishell->trace, \
+                    ivi_input_interface. \
+                        methods[INPUT_REQUEST_ ## request].name); \
+    IVI_STATS_SCOPE(&(ctx)->ivishell->stats, &(ctx)->stats, \
+                    INPUT_REQUEST_ ## request, (client))
+
 enum kbd_events {
     KEYBOARD_ENTER,
     KEYBOARD_LEAVE,
@@ -1103,6 +1118,8 @@ input_set_input_focus(struct wl_client *client,
 {
     struct input_controller *controller = wl_resource_get_user_data(resource);
     struct input_context *ctx = controller->input_context;
+    INPUT_STATS_SCOPE(ctx, SET_INPUT_FOCUS, client);
+
     setup_input_focus(ctx, surface, device, enabled);
 }
 
@@ -1192,6 +1209,8 @@ input_set_input_acceptance(struct wl_client *client,
 {
     struct input_controller *controller = wl_resource_get_user_data(resource);
     struct input_context *ctx = controller->input_context;
+    INPUT_STATS_SCOPE(ctx, SET_INPUT_ACCEPTANCE, client);
+
     setup_input_acceptance(ctx, surface, seat, accepted);
 }
 
@@ -1290,6 +1309,7 @@ destroy_input_context(struct input_context *ctx)
     wl_list_remove(&ctx->seat_create_listener.link);
     wl_list_remove(&ctx->surface_created.link);
     wl_list_remove(&ctx->surface_destroyed.link);
+    ivi_stats_table_release(&ctx->stats);
     free(ctx);
 }
 
@@ -1348,6 +1368,9 @@ create_input_context(struct ivishell *shell)
     wl_list_init(&ctx->controller_list);
     wl_list_init(&ctx->seat_list);
 
+    if (ivi_stats_table_init(&ctx->stats, &ivi_input_interface) == 0)
+        ivi_stats_add_table(&shell->stats, &ctx->stats);
+
     /* Add signal handlers for ivi surfaces. */
     ctx->surface_created.notify = handle_surface_create;
     ctx->surface_destroyed.notify = handle_surface_destroy;
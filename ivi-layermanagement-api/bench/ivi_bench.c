@@ -0,0 +1,959 @@
+/*
+ * Copyright (C) 2026 The wayland-ivi-extension contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * ivi-bench: end-to-end benchmark of the ivi_wm control path.
+ *
+ * Starts weston with the headless backend, the pixman renderer and
+ * ivi-controller.so, forks synthetic wl_shm ivi clients and drives
+ * ilmControl workloads against them. Throughput, latency percentiles and
+ * the CPU time spent in the compositor are reported as JSON.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <wayland-client.h>
+
+#include "ilm_control.h"
+#include "ivi-application-client-protocol.h"
+
+#define BENCH_SURFACE_BASE  0x10000
+#define BENCH_LAYER_ID      0xbe4c
+#define BENCH_STARTUP_MSEC  10000
+#define BENCH_NOTIFY_MSEC   1000
+
+struct bench_options {
+    int clients;
+    int iterations;
+    int width;
+    int height;
+    const char *weston;
+    const char *workloads;
+    const char *output;
+    int spawn;
+    pid_t compositor_pid;
+};
+
+struct bench_context {
+    struct bench_options opts;
+    char socket_name[64];
+    char config_path[256];
+    char log_path[256];
+    pid_t compositor;
+    pid_t *client_pids;
+    t_ilm_surface *surfaces;
+    t_ilm_uint screen;
+    t_ilm_uint screen_width;
+    t_ilm_uint screen_height;
+    t_ilm_layer *saved_order;      /* render order found on the screen */
+    t_ilm_uint saved_count;
+    t_ilm_float opacity;           /* opacity last set on the surfaces */
+    uint32_t rng;
+};
+
+struct bench_result {
+    const char *name;
+    int ops;
+    int errors;
+    double seconds;
+    double cpu_seconds;            /* < 0 if the compositor is unknown */
+    double *latency_us;
+};
+
+struct bench_workload {
+    const char *name;
+    int (*setup)(struct bench_context *ctx);
+    int (*run_op)(struct bench_context *ctx, int iteration);
+    void (*teardown)(struct bench_context *ctx);
+};
+
+static pthread_mutex_t notify_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t notify_cond = PTHREAD_COND_INITIALIZER;
+static int notify_count;
+
+static double
+now_usec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void
+sleep_msec(int msec)
+{
+    struct timespec ts = { msec / 1000, (msec % 1000) * 1000000L };
+
+    nanosleep(&ts, NULL);
+}
+
+static uint32_t
+next_random(struct bench_context *ctx)
+{
+    /* xorshift32, deterministic so runs are comparable */
+    ctx->rng ^= ctx->rng << 13;
+    ctx->rng ^= ctx->rng >> 17;
+    ctx->rng ^= ctx->rng << 5;
+
+    return ctx->rng;
+}
+
+static double
+read_process_cpu(pid_t pid)
+{
+    char path[64];
+    char buf[1024];
+    unsigned long utime, stime;
+    char *p;
+    FILE *f;
+    size_t len;
+
+    if (pid <= 0)
+        return -1.0;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    f = fopen(path, "r");
+    if (f == NULL)
+        return -1.0;
+
+    len = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[len] = '\0';
+
+    /* the command name may contain spaces, fields continue after ')' */
+    p = strrchr(buf, ')');
+    if (p == NULL ||
+        sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+               &utime, &stime) != 2)
+        return -1.0;
+
+    return (double)(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+/* synthetic client, runs in a forked child */
+
+struct bench_client {
+    struct wl_display *display;
+    struct wl_compositor *compositor;
+    struct wl_shm *shm;
+    struct ivi_application *ivi_application;
+};
+
+static void
+registry_handle_global(void *data, struct wl_registry *registry,
+                       uint32_t name, const char *interface, uint32_t version)
+{
+    struct bench_client *client = data;
+
+    if (strcmp(interface, "wl_compositor") == 0) {
+        client->compositor =
+            wl_registry_bind(registry, name, &wl_compositor_interface, 1);
+    } else if (strcmp(interface, "wl_shm") == 0) {
+        client->shm = wl_registry_bind(registry, name, &wl_shm_interface, 1);
+    } else if (strcmp(interface, "ivi_application") == 0) {
+        client->ivi_application =
+            wl_registry_bind(registry, name, &ivi_application_interface, 1);
+    }
+}
+
+static void
+registry_handle_global_remove(void *data, struct wl_registry *registry,
+                              uint32_t name)
+{
+}
+
+static const struct wl_registry_listener registry_listener = {
+    registry_handle_global,
+    registry_handle_global_remove
+};
+
+static int
+create_shm_file(off_t size)
+{
+    const char template[] = "/ivi-bench-XXXXXX";
+    const char *runtimedir = getenv("XDG_RUNTIME_DIR");
+    char *name;
+    int fd;
+
+    if (runtimedir == NULL)
+        return -1;
+
+    name = malloc(strlen(runtimedir) + sizeof(template));
+    if (name == NULL)
+        return -1;
+
+    fd = mkostemp(strcat(strcpy(name, runtimedir), template), O_CLOEXEC);
+    if (fd >= 0) {
+        unlink(name);
+        if (ftruncate(fd, size) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    free(name);
+
+    return fd;
+}
+
+static int
+run_client(const char *socket_name, t_ilm_surface id, int width, int height)
+{
+    struct bench_client client = { 0 };
+    struct wl_registry *registry;
+    struct wl_surface *surface;
+    struct wl_shm_pool *pool;
+    struct wl_buffer *buffer;
+    int stride = width * 4;
+    int size = stride * height;
+    uint32_t *pixels;
+    int fd, i;
+
+    client.display = wl_display_connect(socket_name);
+    if (client.display == NULL)
+        return EXIT_FAILURE;
+
+    registry = wl_display_get_registry(client.display);
+    wl_registry_add_listener(registry, &registry_listener, &client);
+    wl_display_roundtrip(client.display);
+
+    if (!client.compositor || !client.shm || !client.ivi_application) {
+        fprintf(stderr, "ivi-bench client: required globals missing\n");
+        return EXIT_FAILURE;
+    }
+
+    fd = create_shm_file(size);
+    if (fd < 0)
+        return EXIT_FAILURE;
+
+    pixels = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (pixels == MAP_FAILED) {
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    for (i = 0; i < width * height; i++)
+        pixels[i] = 0xff000000 | (id * 0x00102030);
+
+    pool = wl_shm_create_pool(client.shm, fd, size);
+    buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride,
+                                       WL_SHM_FORMAT_XRGB8888);
+    wl_shm_pool_destroy(pool);
+    close(fd);
+
+    surface = wl_compositor_create_surface(client.compositor);
+    ivi_application_surface_create(client.ivi_application, id, surface);
+
+    wl_surface_attach(surface, buffer, 0, 0);
+    wl_surface_damage(surface, 0, 0, width, height);
+    wl_surface_commit(surface);
+
+    /* stay connected until the benchmark is done */
+    while (wl_display_dispatch(client.display) != -1)
+        ;
+
+    return EXIT_SUCCESS;
+}
+
+/* compositor */
+
+static int
+write_weston_config(struct bench_context *ctx)
+{
+    FILE *f = fopen(ctx->config_path, "w");
+
+    if (f == NULL) {
+        fprintf(stderr, "ivi-bench: cannot write %s\n", ctx->config_path);
+        return -1;
+    }
+
+    fprintf(f, "[core]\n"
+               "shell=ivi-shell.so\n"
+               "idle-time=0\n"
+               "\n"
+               "[ivi-shell]\n"
+               "ivi-module=ivi-controller.so\n");
+    fclose(f);
+
+    return 0;
+}
+
+static int
+start_compositor(struct bench_context *ctx)
+{
+    const char *runtimedir = getenv("XDG_RUNTIME_DIR");
+    char socket_path[512];
+    char arg_socket[96], arg_config[288], arg_log[288];
+    int waited;
+
+    if (runtimedir == NULL) {
+        fprintf(stderr, "ivi-bench: XDG_RUNTIME_DIR is not set\n");
+        return -1;
+    }
+
+    snprintf(ctx->socket_name, sizeof(ctx->socket_name),
+             "ivi-bench-%d", (int)getpid());
+    snprintf(ctx->config_path, sizeof(ctx->config_path),
+             "%s/%s.ini", runtimedir, ctx->socket_name);
+    snprintf(ctx->log_path, sizeof(ctx->log_path),
+             "%s/%s.log", runtimedir, ctx->socket_name);
+    snprintf(socket_path, sizeof(socket_path),
+             "%s/%s", runtimedir, ctx->socket_name);
+
+    if (write_weston_config(ctx) < 0)
+        return -1;
+
+    snprintf(arg_socket, sizeof(arg_socket), "--socket=%s", ctx->socket_name);
+    snprintf(arg_config, sizeof(arg_config), "--config=%s", ctx->config_path);
+    snprintf(arg_log, sizeof(arg_log), "--log=%s", ctx->log_path);
+
+    ctx->compositor = fork();
+    if (ctx->compositor < 0)
+        return -1;
+
+    if (ctx->compositor == 0) {
+        execlp(ctx->opts.weston, ctx->opts.weston,
+               "--backend=headless-backend.so", "--use-pixman",
+               "--width=1920", "--height=1080",
+               arg_socket, arg_config, arg_log, (char *)NULL);
+        fprintf(stderr, "ivi-bench: cannot execute %s: %s\n",
+                ctx->opts.weston, strerror(errno));
+        _exit(EXIT_FAILURE);
+    }
+
+    for (waited = 0; waited < BENCH_STARTUP_MSEC; waited += 10) {
+        if (access(socket_path, F_OK) == 0)
+            return 0;
+
+        if (waitpid(ctx->compositor, NULL, WNOHANG) == ctx->compositor) {
+            fprintf(stderr, "ivi-bench: weston exited, see %s\n", ctx->log_path);
+            ctx->compositor = 0;
+            return -1;
+        }
+        sleep_msec(10);
+    }
+
+    fprintf(stderr, "ivi-bench: weston did not create %s\n", socket_path);
+    return -1;
+}
+
+static void
+stop_process(pid_t pid)
+{
+    if (pid <= 0)
+        return;
+
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+}
+
+/* scene */
+
+static int
+spawn_clients(struct bench_context *ctx)
+{
+    int i;
+
+    ctx->client_pids = calloc(ctx->opts.clients, sizeof(pid_t));
+    ctx->surfaces = calloc(ctx->opts.clients, sizeof(t_ilm_surface));
+    if (ctx->client_pids == NULL || ctx->surfaces == NULL)
+        return -1;
+
+    for (i = 0; i < ctx->opts.clients; i++) {
+        pid_t pid;
+
+        ctx->surfaces[i] = BENCH_SURFACE_BASE + i;
+
+        pid = fork();
+        if (pid < 0)
+            return -1;
+
+        if (pid == 0) {
+            _exit(run_client(ctx->opts.spawn ? ctx->socket_name : NULL,
+                             ctx->surfaces[i], ctx->opts.width,
+                             ctx->opts.height));
+        }
+        ctx->client_pids[i] = pid;
+    }
+
+    return 0;
+}
+
+static int
+wait_for_surfaces(struct bench_context *ctx)
+{
+    int waited;
+
+    for (waited = 0; waited < BENCH_STARTUP_MSEC; waited += 10) {
+        t_ilm_surface *ids = NULL;
+        t_ilm_int count = 0;
+        int found = 0;
+        int i, j;
+
+        if (ilm_getSurfaceIDs(&count, &ids) == ILM_SUCCESS) {
+            for (i = 0; i < ctx->opts.clients; i++) {
+                for (j = 0; j < count; j++) {
+                    if (ids[j] == ctx->surfaces[i]) {
+                        found++;
+                        break;
+                    }
+                }
+            }
+        }
+        free(ids);
+
+        if (found == ctx->opts.clients)
+            return 0;
+
+        sleep_msec(10);
+    }
+
+    fprintf(stderr, "ivi-bench: not all %d client surfaces appeared\n",
+            ctx->opts.clients);
+    return -1;
+}
+
+static int
+setup_scene(struct bench_context *ctx)
+{
+    struct ilmScreenProperties props;
+    t_ilm_layer layer = BENCH_LAYER_ID;
+    t_ilm_layer *order;
+    t_ilm_uint *screens = NULL;
+    t_ilm_uint screen_count = 0;
+    int i;
+
+    if (ilm_getScreenIDs(&screen_count, &screens) != ILM_SUCCESS ||
+        screen_count == 0) {
+        fprintf(stderr, "ivi-bench: no screen\n");
+        free(screens);
+        return -1;
+    }
+    ctx->screen = screens[0];
+    free(screens);
+
+    /* with --no-spawn the screen may show other layers, the bench layer
+     * goes on top of them and the order is restored afterwards */
+    if (ilm_getPropertiesOfScreen(ctx->screen, &props) != ILM_SUCCESS)
+        return -1;
+    ctx->screen_width = props.screenWidth;
+    ctx->screen_height = props.screenHeight;
+    ctx->saved_order = props.layerIds;
+    ctx->saved_count = props.layerCount;
+
+    if (ilm_layerCreateWithDimension(&layer, ctx->screen_width,
+                                     ctx->screen_height) != ILM_SUCCESS)
+        return -1;
+
+    ilm_layerSetDestinationRectangle(layer, 0, 0, ctx->screen_width,
+                                     ctx->screen_height);
+    ilm_layerSetSourceRectangle(layer, 0, 0, ctx->screen_width,
+                                ctx->screen_height);
+    ilm_layerSetVisibility(layer, ILM_TRUE);
+
+    for (i = 0; i < ctx->opts.clients; i++) {
+        ilm_surfaceSetSourceRectangle(ctx->surfaces[i], 0, 0,
+                                      ctx->opts.width, ctx->opts.height);
+        ilm_surfaceSetDestinationRectangle(ctx->surfaces[i], 0, 0,
+                                           ctx->opts.width, ctx->opts.height);
+        ilm_surfaceSetVisibility(ctx->surfaces[i], ILM_TRUE);
+        ilm_surfaceSetOpacity(ctx->surfaces[i], 1.0f);
+    }
+    ctx->opacity = 1.0f;
+
+    order = calloc(ctx->saved_count + 1, sizeof(*order));
+    if (order == NULL)
+        return -1;
+    if (ctx->saved_count)
+        memcpy(order, ctx->saved_order, ctx->saved_count * sizeof(*order));
+    order[ctx->saved_count] = layer;
+
+    ilm_layerSetRenderOrder(layer, ctx->surfaces, ctx->opts.clients);
+    ilm_displaySetRenderOrder(ctx->screen, order, ctx->saved_count + 1);
+    free(order);
+
+    return (ilm_commitChanges() == ILM_SUCCESS) ? 0 : -1;
+}
+
+static void
+restore_scene(struct bench_context *ctx)
+{
+    ilm_displaySetRenderOrder(ctx->screen, ctx->saved_order, ctx->saved_count);
+    ilm_layerRemove(BENCH_LAYER_ID);
+    ilm_commitChanges();
+}
+
+/* workloads, each op is timed from its first request to the end of its
+ * round trip */
+
+/* every op has to change the opacity, an unchanged value is not notified */
+static t_ilm_float
+toggle_opacity(struct bench_context *ctx)
+{
+    ctx->opacity = (ctx->opacity == 1.0f) ? 0.5f : 1.0f;
+    return ctx->opacity;
+}
+
+static int
+properties_op(struct bench_context *ctx, int iteration)
+{
+    t_ilm_float opacity = toggle_opacity(ctx);
+    t_ilm_uint range_x = ctx->screen_width > (t_ilm_uint)ctx->opts.width ?
+                         ctx->screen_width - ctx->opts.width : 1;
+    t_ilm_uint range_y = ctx->screen_height > (t_ilm_uint)ctx->opts.height ?
+                         ctx->screen_height - ctx->opts.height : 1;
+    int i;
+    (void)iteration;
+
+    for (i = 0; i < ctx->opts.clients; i++) {
+        ilm_surfaceSetOpacity(ctx->surfaces[i], opacity);
+        ilm_surfaceSetDestinationRectangle(ctx->surfaces[i],
+                                           next_random(ctx) % range_x,
+                                           next_random(ctx) % range_y,
+                                           ctx->opts.width, ctx->opts.height);
+    }
+
+    return (ilm_commitChanges() == ILM_SUCCESS) ? 0 : -1;
+}
+
+static int
+render_order_op(struct bench_context *ctx, int iteration)
+{
+    int i;
+    (void)iteration;
+
+    /* Fisher-Yates shuffle of the surfaces on the layer */
+    for (i = ctx->opts.clients - 1; i > 0; i--) {
+        int j = next_random(ctx) % (i + 1);
+        t_ilm_surface tmp = ctx->surfaces[i];
+
+        ctx->surfaces[i] = ctx->surfaces[j];
+        ctx->surfaces[j] = tmp;
+    }
+
+    if (ilm_layerSetRenderOrder(BENCH_LAYER_ID, ctx->surfaces,
+                                ctx->opts.clients) != ILM_SUCCESS)
+        return -1;
+
+    return (ilm_commitChanges() == ILM_SUCCESS) ? 0 : -1;
+}
+
+static void
+surface_notification(t_ilm_surface surface, struct ilmSurfaceProperties *props,
+                     t_ilm_notification_mask mask)
+{
+    (void)surface;
+    (void)props;
+
+    if (!(mask & ILM_NOTIFICATION_OPACITY))
+        return;
+
+    pthread_mutex_lock(&notify_mutex);
+    notify_count++;
+    pthread_cond_signal(&notify_cond);
+    pthread_mutex_unlock(&notify_mutex);
+}
+
+static int
+subscriptions_setup(struct bench_context *ctx)
+{
+    int i;
+
+    for (i = 0; i < ctx->opts.clients; i++) {
+        if (ilm_surfaceAddNotification(ctx->surfaces[i],
+                                       surface_notification) != ILM_SUCCESS)
+            return -1;
+    }
+
+    return 0;
+}
+
+static int
+subscriptions_op(struct bench_context *ctx, int iteration)
+{
+    t_ilm_float opacity = toggle_opacity(ctx);
+    struct timespec deadline;
+    int expected;
+    int ret = 0;
+    int i;
+    (void)iteration;
+
+    pthread_mutex_lock(&notify_mutex);
+    notify_count = 0;
+    pthread_mutex_unlock(&notify_mutex);
+
+    for (i = 0; i < ctx->opts.clients; i++)
+        ilm_surfaceSetOpacity(ctx->surfaces[i], opacity);
+
+    if (ilm_commitChanges() != ILM_SUCCESS)
+        return -1;
+
+    /* the op ends when every subscriber was notified */
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += BENCH_NOTIFY_MSEC / 1000;
+    expected = ctx->opts.clients;
+
+    pthread_mutex_lock(&notify_mutex);
+    while (notify_count < expected && ret == 0)
+        ret = pthread_cond_timedwait(&notify_cond, &notify_mutex, &deadline);
+    pthread_mutex_unlock(&notify_mutex);
+
+    return (ret == 0) ? 0 : -1;
+}
+
+static void
+subscriptions_teardown(struct bench_context *ctx)
+{
+    int i;
+
+    for (i = 0; i < ctx->opts.clients; i++)
+        ilm_surfaceRemoveNotification(ctx->surfaces[i]);
+}
+
+static int
+screenshots_op(struct bench_context *ctx, int iteration)
+{
+    char path[512];
+    ilmErrorTypes err;
+
+    snprintf(path, sizeof(path), "%s/%s-shot.bmp", getenv("XDG_RUNTIME_DIR"),
+             ctx->socket_name[0] ? ctx->socket_name : "ivi-bench");
+
+    err = ilm_takeSurfaceScreenshot(path,
+                                    ctx->surfaces[iteration % ctx->opts.clients]);
+    unlink(path);
+
+    return (err == ILM_SUCCESS) ? 0 : -1;
+}
+
+static const struct bench_workload workloads[] = {
+    { "properties",    NULL,                properties_op,    NULL },
+    { "render-order",  NULL,                render_order_op,  NULL },
+    { "subscriptions", subscriptions_setup, subscriptions_op, subscriptions_teardown },
+    { "screenshots",   NULL,                screenshots_op,   NULL },
+};
+
+static int
+compare_double(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+
+    return (da > db) - (da < db);
+}
+
+static int
+run_workload(struct bench_context *ctx, const struct bench_workload *workload,
+             struct bench_result *result)
+{
+    pid_t compositor = ctx->opts.spawn ? ctx->compositor : ctx->opts.compositor_pid;
+    double cpu_start, cpu_end, start;
+    int i;
+
+    memset(result, 0, sizeof(*result));
+    result->name = workload->name;
+    result->latency_us = calloc(ctx->opts.iterations, sizeof(double));
+    if (result->latency_us == NULL)
+        return -1;
+
+    if (workload->setup && workload->setup(ctx) < 0) {
+        fprintf(stderr, "ivi-bench: setup of %s failed\n", workload->name);
+        free(result->latency_us);
+        return -1;
+    }
+
+    cpu_start = read_process_cpu(compositor);
+    start = now_usec();
+
+    for (i = 0; i < ctx->opts.iterations; i++) {
+        double op_start = now_usec();
+
+        if (workload->run_op(ctx, i) < 0)
+            result->errors++;
+
+        result->latency_us[result->ops++] = now_usec() - op_start;
+    }
+
+    result->seconds = (now_usec() - start) / 1e6;
+    cpu_end = read_process_cpu(compositor);
+    result->cpu_seconds = (cpu_start >= 0 && cpu_end >= 0) ?
+                          cpu_end - cpu_start : -1.0;
+
+    if (workload->teardown)
+        workload->teardown(ctx);
+
+    qsort(result->latency_us, result->ops, sizeof(double), compare_double);
+
+    return 0;
+}
+
+static double
+percentile(const struct bench_result *result, int pct)
+{
+    int idx;
+
+    if (result->ops == 0)
+        return 0.0;
+
+    idx = (result->ops * pct) / 100;
+    if (idx >= result->ops)
+        idx = result->ops - 1;
+
+    return result->latency_us[idx];
+}
+
+static void
+write_json(FILE *out, struct bench_context *ctx,
+           struct bench_result *results, int n_results)
+{
+    int i;
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"benchmark\": \"ivi-bench\",\n");
+    fprintf(out, "  \"clients\": %d,\n", ctx->opts.clients);
+    fprintf(out, "  \"iterations\": %d,\n", ctx->opts.iterations);
+    fprintf(out, "  \"surface_size\": [%d, %d],\n",
+            ctx->opts.width, ctx->opts.height);
+    fprintf(out, "  \"workloads\": [\n");
+
+    for (i = 0; i < n_results; i++) {
+        struct bench_result *r = &results[i];
+
+        fprintf(out, "    {\n");
+        fprintf(out, "      \"name\": \"%s\",\n", r->name);
+        fprintf(out, "      \"ops\": %d,\n", r->ops);
+        fprintf(out, "      \"errors\": %d,\n", r->errors);
+        fprintf(out, "      \"seconds\": %.6f,\n", r->seconds);
+        fprintf(out, "      \"ops_per_sec\": %.1f,\n",
+                r->seconds > 0 ? r->ops / r->seconds : 0.0);
+        fprintf(out, "      \"latency_us\": { \"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f },\n",
+                percentile(r, 50), percentile(r, 99),
+                r->ops ? r->latency_us[r->ops - 1] : 0.0);
+        if (r->cpu_seconds >= 0)
+            fprintf(out, "      \"compositor_cpu_sec\": %.3f\n", r->cpu_seconds);
+        else
+            fprintf(out, "      \"compositor_cpu_sec\": null\n");
+        fprintf(out, "    }%s\n", (i + 1 < n_results) ? "," : "");
+    }
+
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+static void
+usage(int ret)
+{
+    fprintf(stderr, "usage: ivi-bench [OPTION]\n"
+                    "    -h,  --help                  display this help and exit.\n"
+                    "    -c,  --clients <n>           number of synthetic shm clients (default 16)\n"
+                    "    -i,  --iterations <n>        operations per workload (default 1000)\n"
+                    "    -s,  --size <w>x<h>          surface size (default 64x64)\n"
+                    "    -w,  --workloads <list>      comma separated, default all of\n"
+                    "                                 properties,render-order,subscriptions,screenshots\n"
+                    "    -o,  --output <file>         write the JSON report to file instead of stdout\n"
+                    "         --weston <path>         weston binary to start (default weston)\n"
+                    "         --no-spawn              use the compositor at WAYLAND_DISPLAY\n"
+                    "         --compositor-pid <pid>  compositor to measure with --no-spawn\n");
+    exit(ret);
+}
+
+static void
+parse_options(struct bench_options *opts, int argc, char *argv[])
+{
+    static const struct option options[] = {
+        { "help",           no_argument,       NULL, 'h' },
+        { "clients",        required_argument, NULL, 'c' },
+        { "iterations",     required_argument, NULL, 'i' },
+        { "size",           required_argument, NULL, 's' },
+        { "workloads",      required_argument, NULL, 'w' },
+        { "output",         required_argument, NULL, 'o' },
+        { "weston",         required_argument, NULL, 'W' },
+        { "no-spawn",       no_argument,       NULL, 'n' },
+        { "compositor-pid", required_argument, NULL, 'p' },
+        { 0,                0,                 NULL, 0 }
+    };
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "hc:i:s:w:o:", options, NULL)) != -1) {
+        switch (opt) {
+        case 'h':
+            usage(EXIT_SUCCESS);
+            break;
+        case 'c':
+            opts->clients = atoi(optarg);
+            break;
+        case 'i':
+            opts->iterations = atoi(optarg);
+            break;
+        case 's':
+            if (sscanf(optarg, "%dx%d", &opts->width, &opts->height) != 2)
+                usage(EXIT_FAILURE);
+            break;
+        case 'w':
+            opts->workloads = optarg;
+            break;
+        case 'o':
+            opts->output = optarg;
+            break;
+        case 'W':
+            opts->weston = optarg;
+            break;
+        case 'n':
+            opts->spawn = 0;
+            break;
+        case 'p':
+            opts->compositor_pid = atoi(optarg);
+            break;
+        default:
+            usage(EXIT_FAILURE);
+            break;
+        }
+    }
+
+    if (opts->clients <= 0 || opts->iterations <= 0 ||
+        opts->width <= 0 || opts->height <= 0)
+        usage(EXIT_FAILURE);
+}
+
+static int
+is_workload_selected(const char *list, const char *name)
+{
+    size_t len = strlen(name);
+    const char *p = list;
+
+    if (list == NULL)
+        return 1;
+
+    while ((p = strstr(p, name)) != NULL) {
+        if ((p == list || p[-1] == ',') && (p[len] == ',' || p[len] == '\0'))
+            return 1;
+        p += len;
+    }
+
+    return 0;
+}
+
+static void
+cleanup(struct bench_context *ctx)
+{
+    int i;
+
+    if (ctx->client_pids) {
+        for (i = 0; i < ctx->opts.clients; i++)
+            stop_process(ctx->client_pids[i]);
+    }
+    free(ctx->client_pids);
+    free(ctx->surfaces);
+    free(ctx->saved_order);
+
+    stop_process(ctx->compositor);
+    if (ctx->config_path[0])
+        unlink(ctx->config_path);
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct bench_context ctx;
+    struct bench_result results[sizeof(workloads) / sizeof(workloads[0])];
+    int n_results = 0;
+    int ret = EXIT_FAILURE;
+    FILE *out = stdout;
+    size_t i;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.opts.clients = 16;
+    ctx.opts.iterations = 1000;
+    ctx.opts.width = 64;
+    ctx.opts.height = 64;
+    ctx.opts.weston = "weston";
+    ctx.opts.spawn = 1;
+    ctx.rng = 0x1b873593;
+
+    parse_options(&ctx.opts, argc, argv);
+
+    if (ctx.opts.spawn) {
+        if (start_compositor(&ctx) < 0)
+            goto out;
+        setenv("WAYLAND_DISPLAY", ctx.socket_name, 1);
+    }
+
+    /* fork the clients before ilmControl starts its thread */
+    if (spawn_clients(&ctx) < 0)
+        goto out;
+
+    if (ilm_init() != ILM_SUCCESS) {
+        fprintf(stderr, "ivi-bench: ilm_init failed\n");
+        goto out;
+    }
+
+    if (wait_for_surfaces(&ctx) < 0 || setup_scene(&ctx) < 0)
+        goto out_ilm;
+
+    for (i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+        if (!is_workload_selected(ctx.opts.workloads, workloads[i].name))
+            continue;
+
+        if (run_workload(&ctx, &workloads[i], &results[n_results]) < 0)
+            goto out_results;
+        n_results++;
+    }
+
+    if (ctx.opts.output) {
+        out = fopen(ctx.opts.output, "w");
+        if (out == NULL) {
+            fprintf(stderr, "ivi-bench: cannot write %s\n", ctx.opts.output);
+            goto out_results;
+        }
+    }
+
+    write_json(out, &ctx, results, n_results);
+    if (out != stdout)
+        fclose(out);
+    ret = EXIT_SUCCESS;
+
+out_results:
+    for (i = 0; i < (size_t)n_results; i++)
+        free(results[i].latency_us);
+    restore_scene(&ctx);
+out_ilm:
+    ilm_destroy();
+out:
+    cleanup(&ctx);
+    return ret;
+}
@@ -232,6 +232,117 @@ struct ilmScreenProperties
     t_ilm_char connectorName[256];  /*!< name of the connector of the screen */
 };
 
+/**
+ * \brief Number of latency buckets of a request histogram
+ * \ingroup ilmControl
+ **/
+#define ILM_STATS_HISTOGRAM_BUCKETS 16
+
+/**
+ * \brief Typedef for representing the statistics of a compositor request
+ * \ingroup ilmControl
+ **/
+struct ilmRequestStats
+{
+    t_ilm_char interfaceName[64];   /*!< protocol interface of the request */
+    t_ilm_char requestName[64];     /*!< name of the request */
+    t_ilm_uint count;               /*!< number of handled requests */
+    t_ilm_float totalTimeUs;        /*!< time spent in the handler in microseconds */
+    t_ilm_uint maxTimeUs;           /*!< slowest call in microseconds */
+    t_ilm_uint histogram[ILM_STATS_HISTOGRAM_BUCKETS]; /*!< calls below 1us, then per power of two microseconds */
+};
+
+/**
+ * \brief Typedef for representing the request count of a compositor client
+ * \ingroup ilmControl
+ **/
+struct ilmClientStats
+{
+    t_ilm_int pid;                  /*!< process id of the client */
+    t_ilm_uint requestCount;        /*!< number of requests sent by the client */
+};
+
+/**
+ * \brief Number of frame interval buckets of the screen statistics
+ * \ingroup ilmControl
+ **/
+#define ILM_SCREEN_INTERVAL_BUCKETS 8
+
+/**
+ * \brief Typedef for representing the repaint statistics of a screen
+ * \ingroup ilmControl
+ **/
+struct ilmScreenStats
+{
+    t_ilm_uint frameCount;          /*!< number of repaints */
+    t_ilm_int refreshRate;          /*!< refresh rate of the current mode in mHz */
+    t_ilm_float totalRepaintTimeUs; /*!< time spent in repaints in microseconds */
+    t_ilm_uint maxRepaintTimeUs;    /*!< slowest repaint in microseconds */
+    t_ilm_uint repaintHistogram[ILM_STATS_HISTOGRAM_BUCKETS]; /*!< repaints below 1us, then per power of two microseconds */
+    t_ilm_uint intervalHistogram[ILM_SCREEN_INTERVAL_BUCKETS]; /*!< intervals of 1, 2, ... refresh periods, the last also counts longer ones */
+    t_ilm_uint missedVblanks;       /*!< vblanks missed by late frames */
+    t_ilm_uint overBudgetFrames;    /*!< frames composited after their vblank */
+    t_ilm_float meanViewCount;      /*!< views composited per frame */
+    t_ilm_uint maxViewCount;        /*!< most views composited in one frame */
+};
+
+/**
+ * \brief Typedef for representing the statistics of an ilmControl object pool
+ * \ingroup ilmControl
+ **/
+struct ilmPoolStats
+{
+    t_ilm_char name[64];            /*!< type of the pooled objects */
+    t_ilm_uint inUse;               /*!< objects currently allocated */
+    t_ilm_uint peak;                /*!< most objects allocated at the same time */
+    t_ilm_uint slabs;               /*!< slabs currently held by the pool */
+    t_ilm_uint allocs;              /*!< allocations, wraps around at 2^32 */
+    t_ilm_uint frees;               /*!< frees, wraps around at 2^32 */
+};
+
+/**
+ * \brief Typedef for representing the visible area of a surface on a screen
+ * \ingroup ilmControl
+ **/
+struct ilmSurfaceCoverage
+{
+    t_ilm_surface surfaceId;        /*!< id of the surface */
+    t_ilm_uint area;                /*!< pixels of the screen covered by the surface */
+    t_ilm_uint visibleArea;         /*!< pixels in which the surface is seen */
+};
+
+/**
+ * \brief Enumeration of the startup stages of a surface
+ * \ingroup ilmControl
+ **/
+typedef enum e_ilmLifecycleStage
+{
+    ILM_LIFECYCLE_FIRST_COMMIT = 0,     /*!< first commit with a buffer attached */
+    ILM_LIFECYCLE_FIRST_CONFIGURE = 1,  /*!< first configure event */
+    ILM_LIFECYCLE_FIRST_LAYER_ADD = 2,  /*!< first committed render order of a layer with the surface */
+    ILM_LIFECYCLE_FIRST_VISIBLE = 3,    /*!< first commit which made the surface visible */
+    ILM_LIFECYCLE_FIRST_FRAME = 4,      /*!< first repainted output frame showing the surface */
+    ILM_LIFECYCLE_STAGES = 5
+} ilmLifecycleStage;
+
+/**
+ * \brief Value of a lifecycle stage which was not reached yet
+ * \ingroup ilmControl
+ **/
+#define ILM_LIFECYCLE_NOT_REACHED 0xffffffffu
+
+/**
+ * \brief Typedef for representing the startup timestamps of a surface
+ * \ingroup ilmControl
+ **/
+struct ilmSurfaceLifecycle
+{
+    t_ilm_surface surfaceId;        /*!< id of the surface */
+    t_ilm_int pid;                  /*!< process id of the client which created the surface */
+    t_ilm_uint createdTimeMs;       /*!< CLOCK_MONOTONIC time of the creation in milliseconds */
+    t_ilm_uint stageTimeUs[ILM_LIFECYCLE_STAGES]; /*!< microseconds from the creation to each stage */
+};
+
 /**
  * enum representing the possible flags for changed properties in notification callbacks.
  */
@@ -245,18 +356,26 @@ typedef enum
     ILM_NOTIFICATION_CONTENT_AVAILABLE = ILM_BIT(6),
     ILM_NOTIFICATION_CONTENT_REMOVED = ILM_BIT(7),
     ILM_NOTIFICATION_CONFIGURED = ILM_BIT(8),
+    ILM_NOTIFICATION_STALLED = ILM_BIT(9),
+    ILM_NOTIFICATION_RECOVERED = ILM_BIT(10),
+    ILM_NOTIFICATION_OCCLUDED = ILM_BIT(11),
+    ILM_NOTIFICATION_REVEALED = ILM_BIT(12),
     ILM_NOTIFICATION_ALL = 0xffff
 } t_ilm_notification_mask;
 
 /**
- * Typedef for notification callback on property changes of a layer
+ * Typedef for notification callback on property changes of a layer.
+ * Changes applied within the same frame are reported with a single call,
+ * mask holds all of the changed properties.
  */
 typedef void(*layerNotificationFunc)(t_ilm_layer layer,
                                         struct ilmLayerProperties*,
                                         t_ilm_notification_mask mask);
 
 /**
- * Typedef for notification callback on property changes of a surface
+ * Typedef for notification callback on property changes of a surface.
+ * Changes applied within the same frame are reported with a single call,
+ * mask holds all of the changed properties.
  */
 typedef void(*surfaceNotificationFunc)(t_ilm_surface surface,
                                         struct ilmSurfaceProperties*,
@@ -123,6 +123,78 @@ ilmErrorTypes ilm_getSurfaceIDs(t_ilm_int* pLength, t_ilm_surface** ppArray);
  */
 ilmErrorTypes ilm_getSurfaceIDsOnLayer(t_ilm_layer layer, t_ilm_int* pLength, t_ilm_surface** ppArray);
 
+/**
+ * \brief Get the screen Ids without allocating memory
+ * \ingroup ilmControl
+ * \param[in] capacity number of elements pIDs can hold
+ * \param[out] pNumberOfIDs pointer where the number of Screen Ids is returned,
+ *                          also if pIDs is too small or NULL
+ * \param[out] pIDs caller provided array where the IDs should be stored,
+ *                  NULL to query the required capacity only
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_INVALID_ARGUMENTS if capacity is too small
+ * \return ILM_FAILED if the client can not call the method on the service.
+ */
+ilmErrorTypes ilm_getScreenIDsBuffer(t_ilm_int capacity, t_ilm_uint* pNumberOfIDs, t_ilm_uint* pIDs);
+
+/**
+ * \brief Get all LayerIds without allocating memory
+ * \ingroup ilmControl
+ * \param[in] capacity number of elements pArray can hold
+ * \param[out] pLength Pointer where the number of ids is stored,
+ *                     also if pArray is too small or NULL
+ * \param[out] pArray caller provided array where the ids should be stored,
+ *                    NULL to query the required capacity only
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_INVALID_ARGUMENTS if capacity is too small
+ * \return ILM_FAILED if the client can not call the method on the service.
+ */
+ilmErrorTypes ilm_getLayerIDsBuffer(t_ilm_int capacity, t_ilm_int* pLength, t_ilm_layer* pArray);
+
+/**
+ * \brief Get all SurfaceIds without allocating memory
+ * \ingroup ilmControl
+ * \param[in] capacity number of elements pArray can hold
+ * \param[out] pLength Pointer where the number of ids is stored,
+ *                     also if pArray is too small or NULL
+ * \param[out] pArray caller provided array where the ids should be stored,
+ *                    NULL to query the required capacity only
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_INVALID_ARGUMENTS if capacity is too small
+ * \return ILM_FAILED if the client can not call the method on the service.
+ */
+ilmErrorTypes ilm_getSurfaceIDsBuffer(t_ilm_int capacity, t_ilm_int* pLength, t_ilm_surface* pArray);
+
+/**
+ * \brief Get all LayerIds of the given screen without allocating memory
+ * \ingroup ilmControl
+ * \param[in] screenID The id of the screen to get the layer IDs of
+ * \param[in] capacity number of elements pArray can hold
+ * \param[out] pLength Pointer where the number of ids is stored,
+ *                     also if pArray is too small or NULL
+ * \param[out] pArray caller provided array where the ids should be stored,
+ *                    NULL to query the required capacity only
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_INVALID_ARGUMENTS if capacity is too small
+ * \return ILM_FAILED if the client can not call the method on the service.
+ */
+ilmErrorTypes ilm_getLayerIDsOnScreenBuffer(t_ilm_uint screenID, t_ilm_int capacity, t_ilm_int* pLength, t_ilm_layer* pArray);
+
+/**
+ * \brief Get all SurfaceIds of the given layer without allocating memory
+ * \ingroup ilmControl
+ * \param[in] layer Id of the Layer whose surfaces are to be returned
+ * \param[in] capacity number of elements pArray can hold
+ * \param[out] pLength Pointer where the number of ids is stored,
+ *                     also if pArray is too small or NULL
+ * \param[out] pArray caller provided array where the ids should be stored,
+ *                    NULL to query the required capacity only
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_INVALID_ARGUMENTS if capacity is too small
+ * \return ILM_FAILED if the client can not call the method on the service.
+ */
+ilmErrorTypes ilm_getSurfaceIDsOnLayerBuffer(t_ilm_layer layer, t_ilm_int capacity, t_ilm_int* pLength, t_ilm_surface* pArray);
+
 /**
  * \brief Create a layer which should be managed by the service
  * \ingroup ilmControl
@@ -400,6 +472,42 @@ ilmErrorTypes ilm_layerAddNotification(t_ilm_layer layer, layerNotificationFunc
  */
 ilmErrorTypes ilm_layerRemoveNotification(t_ilm_layer layer);
 
+/**
+ * \brief register for notification on selected property changes of layer
+ * \ingroup ilmControl
+ * \param[in] layer id of layer to register for notification
+ * \param[in] mask properties the callback is called for
+ * \param[in] callback pointer to function to be called for notification
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_INVALID_ARGUMENT if the given layer does not exist
+ */
+ilmErrorTypes ilm_layerAddNotificationWithMask(t_ilm_layer layer,
+                                               t_ilm_notification_mask mask,
+                                               layerNotificationFunc callback);
+
+/**
+ * \brief register for notification on property changes of all current and
+ *        future layers
+ * \ingroup ilmControl
+ * \param[in] mask properties the callback is called for
+ * \param[in] callback pointer to function to be called for notification
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support it
+ */
+ilmErrorTypes ilm_layerAddNotificationAll(t_ilm_notification_mask mask,
+                                          layerNotificationFunc callback);
+
+/**
+ * \brief remove notification registered by ilm_layerAddNotificationAll
+ * \ingroup ilmControl
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_INVALID_ARGUMENT if no such notification is registered
+ */
+ilmErrorTypes ilm_layerRemoveNotificationAll(void);
+
 /**
  * \brief register for notification on property changes of surface
  * \ingroup ilmClient
@@ -421,6 +529,41 @@ ilmErrorTypes ilm_surfaceAddNotification(t_ilm_surface surface, surfaceNotificat
  */
 ilmErrorTypes ilm_surfaceRemoveNotification(t_ilm_surface surface);
 
+/**
+ * \brief register for notification on selected property changes of surface
+ * \ingroup ilmControl
+ * \param[in] surface id of surface to register for notification
+ * \param[in] mask properties the callback is called for
+ * \param[in] callback pointer to function to be called for notification
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ */
+ilmErrorTypes ilm_surfaceAddNotificationWithMask(t_ilm_surface surface,
+                                                 t_ilm_notification_mask mask,
+                                                 surfaceNotificationFunc callback);
+
+/**
+ * \brief register for notification on property changes of all current and
+ *        future surfaces
+ * \ingroup ilmControl
+ * \param[in] mask properties the callback is called for
+ * \param[in] callback pointer to function to be called for notification
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support it
+ */
+ilmErrorTypes ilm_surfaceAddNotificationAll(t_ilm_notification_mask mask,
+                                            surfaceNotificationFunc callback);
+
+/**
+ * \brief remove notification registered by ilm_surfaceAddNotificationAll
+ * \ingroup ilmControl
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_INVALID_ARGUMENT if no such notification is registered
+ */
+ilmErrorTypes ilm_surfaceRemoveNotificationAll(void);
+
 /**
  * \brief register notification callback for creation/deletion of ilm surfaces/layers
  * \ingroup ilmControl
@@ -441,6 +584,114 @@ ilmErrorTypes ilm_registerNotification(notificationFunc callback, void *user_dat
  */
 ilmErrorTypes ilm_unregisterNotification();
 
+/**
+ * \brief Get the scene generation number of the compositor.
+ * The number is incremented by the compositor on every committed change of
+ * surfaces, layers and render orders. It is updated asynchronously and after
+ * every ilm_commitChanges, so no roundtrip is done by this call.
+ * \ingroup ilmControl
+ * \param[out] pGeneration pointer where the generation number is stored
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support it
+ */
+ilmErrorTypes ilm_getSceneGeneration(t_ilm_uint* pGeneration);
+
+/**
+ * \brief Get the request statistics of the compositor.
+ * The compositor counts the calls of every control and input request and
+ * measures the time spent in their handlers since it was started.
+ * Only requests which were called at least once are reported, clients are
+ * reported while they are connected.
+ * \ingroup ilmControl
+ * \param[out] pRequestCount pointer where the number of requests is stored
+ * \param[out] ppRequests array of request statistics,
+ *                        memory is allocated by the function and must be freed by caller
+ * \param[out] pClientCount pointer where the number of clients is stored
+ * \param[out] ppClients array of client statistics,
+ *                       memory is allocated by the function and must be freed by caller
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support it
+ */
+ilmErrorTypes ilm_getStats(t_ilm_uint* pRequestCount,
+                           struct ilmRequestStats** ppRequests,
+                           t_ilm_uint* pClientCount,
+                           struct ilmClientStats** ppClients);
+
+/**
+ * \brief Write the trace events recorded by this process to a file.
+ * Tracing is enabled by setting ILM_TRACE_FILE in the environment before
+ * ilmControl_init is called; the trace is also written to
+ * $ILM_TRACE_FILE.<pid> by ilmControl_destroy. The file is in the Chrome
+ * trace event format and can be merged with the trace of the compositor.
+ * \ingroup ilmControl
+ * \param[in] filename file to write, NULL for $ILM_TRACE_FILE.<pid>
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the file could not be written
+ * \return ILM_ERROR_NOT_IMPLEMENTED if tracing is not enabled
+ */
+ilmErrorTypes ilm_dumpTrace(const char* filename);
+
+/**
+ * \brief Get the statistics of the object pools of this process.
+ * ilmControl keeps its surface, layer and seat bookkeeping in slab pools;
+ * the statistics are local and need no call to the compositor.
+ * \ingroup ilmControl
+ * \param[out] pCount pointer where the number of pools is stored
+ * \param[out] ppStats array of pool statistics,
+ *                     memory is allocated by the function and must be freed by caller
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if ilmControl is not initialized, the arguments are invalid
+ *                    or memory could not be allocated
+ */
+ilmErrorTypes ilm_getPoolStats(t_ilm_uint* pCount, struct ilmPoolStats** ppStats);
+
+/**
+ * \brief Get the repaint statistics of a screen.
+ * The statistics cover all repaints since the output was created,
+ * compare two calls to see the effect of a layout change.
+ * \ingroup ilmControl
+ * \param[in] screenID id of the screen
+ * \param[out] pStats pointer where the statistics are stored
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support it
+ */
+ilmErrorTypes ilm_getScreenStats(t_ilm_display screenID,
+                                 struct ilmScreenStats* pStats);
+
+/**
+ * \brief Get the visible area of the surfaces composited on a screen.
+ * The compositor computes it after every repaint of the screen, the
+ * surfaces are ordered from the topmost to the bottommost one.
+ * \ingroup ilmControl
+ * \param[in] screenID id of the screen
+ * \param[out] pCount pointer where the number of surfaces is stored
+ * \param[out] ppCoverage array of surface coverages,
+ *                        memory is allocated by the function and must be freed by caller
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support it
+ */
+ilmErrorTypes ilm_getScreenCoverage(t_ilm_display screenID, t_ilm_uint* pCount,
+                                    struct ilmSurfaceCoverage** ppCoverage);
+
+/**
+ * \brief Get the startup timestamps of all surfaces.
+ * The compositor records when a surface is created and when it reaches
+ * each ilmLifecycleStage, up to the first frame which shows it.
+ * \ingroup ilmControl
+ * \param[out] pCount pointer where the number of surfaces is stored
+ * \param[out] ppLifecycles array of surface lifecycles,
+ *                          memory is allocated by the function and must be freed by caller
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support it
+ */
+ilmErrorTypes ilm_getSurfaceLifecycles(t_ilm_uint* pCount,
+                                       struct ilmSurfaceLifecycle** ppLifecycles);
+
 /**
  * \brief returns the global error flag.
  * When compositor sends an error, the error flag is set to appropriate error code
@@ -28,6 +28,8 @@ extern "C" {
 #include "ilm_common.h"
 #include "wayland-util.h"
 
+struct ivi_trace;
+
 struct wayland_context {
     struct wl_display *display;
     struct wl_registry *registry;
@@ -43,8 +45,25 @@ struct wayland_context {
     notificationFunc notification;
     void *notification_user_data;
 
+    surfaceNotificationFunc surface_notification_all;
+    t_ilm_notification_mask surface_notification_all_mask;
+    layerNotificationFunc layer_notification_all;
+    t_ilm_notification_mask layer_notification_all_mask;
+
     ilmErrorTypes error_flag;
 
+    uint32_t scene_generation;
+
+    /* filled by the statistics events during ilm_getStats */
+    struct wl_array request_stats;
+    struct wl_array client_stats;
+    /* filled by the surface_lifecycle events during ilm_getSurfaceLifecycles */
+    struct wl_array surface_lifecycles;
+
+    /* NULL unless ILM_TRACE_FILE is set */
+    struct ivi_trace *trace;
+    uint32_t trace_flow_seq;
+
     struct ivi_input *input_controller;
 };
 
@@ -78,6 +97,7 @@ struct surface_context {
     struct ilmSurfaceProperties prop;
     struct wl_list list_accepted_seats;
     surfaceNotificationFunc notification;
+    t_ilm_notification_mask notification_mask;
 
     struct wayland_context *ctx;
 };
@@ -26,11 +26,14 @@
 
 #include <unistd.h>
 #include <poll.h>
+#include <limits.h>
 
 #include <sys/mman.h>
 #include <sys/eventfd.h>
 
 #include "bitmap.h"
+#include "ivi-pool.h"
+#include "ivi-trace.h"
 #include "ilm_common.h"
 #include "ilm_control_platform.h"
 #include "wayland-util.h"
@@ -44,6 +47,7 @@ struct layer_context {
 
     struct ilmLayerProperties prop;
     layerNotificationFunc notification;
+    t_ilm_notification_mask notification_mask;
 
     struct wl_array render_order;
 
@@ -60,6 +64,11 @@ struct screen_context {
     int32_t transform;
 
     struct ilmScreenProperties prop;
+    /* filled by the stats event during ilm_getScreenStats */
+    struct ilmScreenStats stats;
+    /* filled by the coverage events during ilm_getScreenCoverage */
+    struct wl_array coverage;
+    int coverage_done;
 
     struct wl_array render_order;
 
@@ -71,6 +80,37 @@ struct screenshot_context {
     ilmErrorTypes result;
 };
 
+/* surface and layer contexts follow the compositor's object churn, keep
+ * them in slab pools; all access happens with the context mutex held */
+static struct ivi_pool surface_context_pool =
+    IVI_POOL_INITIALIZER(struct surface_context, 32);
+static struct ivi_pool layer_context_pool =
+    IVI_POOL_INITIALIZER(struct layer_context, 16);
+static struct ivi_pool accepted_seat_pool =
+    IVI_POOL_INITIALIZER(struct accepted_seat, 16);
+
+static void
+release_pool(struct ivi_pool *pool)
+{
+    /* ILM_POOL_STATS=1 dumps allocator statistics for debugging */
+    const char *env = getenv("ILM_POOL_STATS");
+    struct ivi_pool_stats stats;
+
+    ivi_pool_get_stats(pool, &stats);
+
+    if (env != NULL && atoi(env) != 0) {
+        fprintf(stderr, "ilmControl: pool %s: in use %u, peak %u, slabs %u, "
+                "allocs %llu, frees %llu\n", pool->name,
+                stats.in_use, stats.peak, stats.slabs,
+                (unsigned long long)stats.allocs,
+                (unsigned long long)stats.frees);
+    }
+
+    if (ivi_pool_release(pool) < 0)
+        fprintf(stderr, "ilmControl: pool %s still has %u objects in use\n",
+                pool->name, stats.in_use);
+}
+
 static inline void lock_context(struct ilm_control_context *ctx)
 {
    pthread_mutex_lock(&ctx->mutex);
@@ -196,6 +236,60 @@ static struct wl_output_listener output_listener = {
     output_listener_scale
 };
 
+static void
+notify_layer(struct layer_context *ctx_layer, t_ilm_notification_mask mask)
+{
+    struct wayland_context *ctx = ctx_layer->ctx;
+    t_ilm_notification_mask wanted;
+
+    ivi_trace_event(ctx->trace, IVI_TRACE_BEGIN, "layer_notification", 0,
+                    "layer_id", ctx_layer->id_layer);
+
+    if (ctx_layer->notification != NULL) {
+        wanted = mask & ctx_layer->notification_mask;
+        if (wanted)
+            ctx_layer->notification(ctx_layer->id_layer,
+                                    &ctx_layer->prop, wanted);
+    }
+
+    if (ctx->layer_notification_all != NULL) {
+        wanted = mask & ctx->layer_notification_all_mask;
+        if (wanted)
+            ctx->layer_notification_all(ctx_layer->id_layer,
+                                        &ctx_layer->prop, wanted);
+    }
+
+    ivi_trace_event(ctx->trace, IVI_TRACE_END, "layer_notification", 0,
+                    NULL, 0);
+}
+
+static void
+notify_surface(struct surface_context *ctx_surf, t_ilm_notification_mask mask)
+{
+    struct wayland_context *ctx = ctx_surf->ctx;
+    t_ilm_notification_mask wanted;
+
+    ivi_trace_event(ctx->trace, IVI_TRACE_BEGIN, "surface_notification", 0,
+                    "surface_id", ctx_surf->id_surface);
+
+    if (ctx_surf->notification != NULL) {
+        wanted = mask & ctx_surf->notification_mask;
+        if (wanted)
+            ctx_surf->notification(ctx_surf->id_surface,
+                                   &ctx_surf->prop, wanted);
+    }
+
+    if (ctx->surface_notification_all != NULL) {
+        wanted = mask & ctx->surface_notification_all_mask;
+        if (wanted)
+            ctx->surface_notification_all(ctx_surf->id_surface,
+                                          &ctx_surf->prop, wanted);
+    }
+
+    ivi_trace_event(ctx->trace, IVI_TRACE_END, "surface_notification", 0,
+                    NULL, 0);
+}
+
 static void
 wm_listener_layer_visibility(void *data, struct ivi_wm *controller,
                              uint32_t layer_id, int32_t visibility)
@@ -209,11 +303,7 @@ wm_listener_layer_visibility(void *data, struct ivi_wm *controller,
 
     ctx_layer->prop.visibility = (t_ilm_bool)visibility;
 
-    if (ctx_layer->notification != NULL) {
-        ctx_layer->notification(ctx_layer->id_layer,
-                                &ctx_layer->prop,
-                                ILM_NOTIFICATION_VISIBILITY);
-    }
+    notify_layer(ctx_layer, ILM_NOTIFICATION_VISIBILITY);
 }
 
 static void
@@ -229,11 +319,7 @@ wm_listener_layer_opacity(void *data, struct ivi_wm *controller,
 
     ctx_layer->prop.opacity = (t_ilm_float)wl_fixed_to_double(opacity);
 
-    if (ctx_layer->notification != NULL) {
-        ctx_layer->notification(ctx_layer->id_layer,
-                                &ctx_layer->prop,
-                                ILM_NOTIFICATION_OPACITY);
-    }
+    notify_layer(ctx_layer, ILM_NOTIFICATION_OPACITY);
 }
 
 static void
@@ -253,11 +339,7 @@ wm_listener_layer_source_rectangle(void *data, struct ivi_wm *controller,
     ctx_layer->prop.sourceWidth = (t_ilm_uint)width;
     ctx_layer->prop.sourceHeight = (t_ilm_uint)height;
 
-    if (ctx_layer->notification != NULL) {
-        ctx_layer->notification(ctx_layer->id_layer,
-                                &ctx_layer->prop,
-                                ILM_NOTIFICATION_SOURCE_RECT);
-    }
+    notify_layer(ctx_layer, ILM_NOTIFICATION_SOURCE_RECT);
 }
 
 static void
@@ -277,11 +359,7 @@ wm_listener_layer_destination_rectangle(void *data, struct ivi_wm *controller,
     ctx_layer->prop.destWidth = (t_ilm_uint)width;
     ctx_layer->prop.destHeight = (t_ilm_uint)height;
 
-    if (ctx_layer->notification != NULL) {
-        ctx_layer->notification(ctx_layer->id_layer,
-                                &ctx_layer->prop,
-                                ILM_NOTIFICATION_DEST_RECT);
-    }
+    notify_layer(ctx_layer, ILM_NOTIFICATION_DEST_RECT);
 }
 
 static void
@@ -294,7 +372,7 @@ wm_listener_layer_created(void *data, struct ivi_wm *controller, uint32_t layer_
     if(ctx_layer)
         return;
 
-    ctx_layer = calloc(1, sizeof *ctx_layer);
+    ctx_layer = ivi_pool_zalloc(&layer_context_pool);
     if (!ctx_layer) {
         fprintf(stderr, "Failed to allocate memory for layer_context\n");
         return;
@@ -330,7 +408,7 @@ wm_listener_layer_destroyed(void *data, struct ivi_wm *controller, uint32_t laye
                                      ctx_layer->ctx->notification_user_data);
     }
 
-    free(ctx_layer);
+    ivi_pool_free(&layer_context_pool, ctx_layer);
 }
 
 static void
@@ -395,11 +473,7 @@ wm_listener_surface_visibility(void *data, struct ivi_wm *controller,
 
     ctx_surf->prop.visibility = (t_ilm_bool)visibility;
 
-    if (ctx_surf->notification != NULL) {
-        ctx_surf->notification(ctx_surf->id_surface,
-                                &ctx_surf->prop,
-                                ILM_NOTIFICATION_VISIBILITY);
-    }
+    notify_surface(ctx_surf, ILM_NOTIFICATION_VISIBILITY);
 }
 
 static void
@@ -415,11 +489,7 @@ wm_listener_surface_opacity(void *data, struct ivi_wm *controller,
 
     ctx_surf->prop.opacity = (t_ilm_float)wl_fixed_to_double(opacity);
 
-    if (ctx_surf->notification != NULL) {
-        ctx_surf->notification(ctx_surf->id_surface,
-                                &ctx_surf->prop,
-                                ILM_NOTIFICATION_OPACITY);
-    }
+    notify_surface(ctx_surf, ILM_NOTIFICATION_OPACITY);
 }
 
 static void
@@ -436,11 +506,7 @@ wm_listener_surface_size(void *data, struct ivi_wm *controller,
     ctx_surf->prop.origSourceWidth = (t_ilm_uint)width;
     ctx_surf->prop.origSourceHeight = (t_ilm_uint)height;
 
-    if (ctx_surf->notification != NULL) {
-        ctx_surf->notification(ctx_surf->id_surface,
-                                &ctx_surf->prop,
-                                ILM_NOTIFICATION_CONFIGURED);
-    }
+    notify_surface(ctx_surf, ILM_NOTIFICATION_CONFIGURED);
 }
 
 static void
@@ -460,11 +526,7 @@ wm_listener_surface_source_rectangle(void *data, struct ivi_wm *controller,
     ctx_surf->prop.sourceWidth = (t_ilm_uint)width;
     ctx_surf->prop.sourceHeight = (t_ilm_uint)height;
 
-    if (ctx_surf->notification != NULL) {
-        ctx_surf->notification(ctx_surf->id_surface,
-                                &ctx_surf->prop,
-                                ILM_NOTIFICATION_SOURCE_RECT);
-    }
+    notify_surface(ctx_surf, ILM_NOTIFICATION_SOURCE_RECT);
 }
 
 static void
@@ -484,11 +546,7 @@ wm_listener_surface_destination_rectangle(void *data, struct ivi_wm *controller,
     ctx_surf->prop.destWidth = (t_ilm_uint)width;
     ctx_surf->prop.destHeight = (t_ilm_uint)height;
 
-    if (ctx_surf->notification != NULL) {
-        ctx_surf->notification(ctx_surf->id_surface,
-                                &ctx_surf->prop,
-                                ILM_NOTIFICATION_DEST_RECT);
-    }
+    notify_surface(ctx_surf, ILM_NOTIFICATION_DEST_RECT);
 }
 
 static void
@@ -518,7 +576,7 @@ wm_listener_surface_created(void *data, struct ivi_wm *controller,
     if(ctx_surf)
         return;
 
-    ctx_surf = calloc(1, sizeof *ctx_surf);
+    ctx_surf = ivi_pool_zalloc(&surface_context_pool);
     if (ctx_surf == NULL) {
         fprintf(stderr, "Failed to allocate memory for surface_context\n");
         return;
@@ -549,11 +607,7 @@ wm_listener_surface_destroyed(void *data, struct ivi_wm *controller,
     if(!ctx_surf)
         return;
 
-    if (ctx_surf->notification != NULL) {
-        ctx_surf->notification(ctx_surf->id_surface,
-                               &ctx_surf->prop,
-                               ILM_NOTIFICATION_CONTENT_REMOVED);
-    }
+    notify_surface(ctx_surf, ILM_NOTIFICATION_CONTENT_REMOVED);
 
     if (ctx_surf->ctx->notification != NULL) {
         ilmObjectType surface = ILM_SURFACE;
@@ -564,11 +618,11 @@ wm_listener_surface_destroyed(void *data, struct ivi_wm *controller,
     wl_list_for_each_safe(seat, seat_next, &ctx_surf->list_accepted_seats, link) {
         wl_list_remove(&seat->link);
         free(seat->seat_name);
-        free(seat);
+        ivi_pool_free(&accepted_seat_pool, seat);
     }
 
     wl_list_remove(&ctx_surf->link);
-    free(ctx_surf);
+    ivi_pool_free(&surface_context_pool, ctx_surf);
 }
 
 static void
@@ -604,6 +658,268 @@ wm_listener_surface_error(void *data, struct ivi_wm *controller,
         ctx->error_flag = error_code;
 }
 
+static uint32_t
+to_wm_property_mask(t_ilm_notification_mask mask)
+{
+    uint32_t wm_mask = 0;
+
+    if (mask & ILM_NOTIFICATION_VISIBILITY)
+        wm_mask |= IVI_WM_PROPERTY_VISIBILITY;
+
+    if (mask & ILM_NOTIFICATION_OPACITY)
+        wm_mask |= IVI_WM_PROPERTY_OPACITY;
+
+    if (mask & ILM_NOTIFICATION_SOURCE_RECT)
+        wm_mask |= IVI_WM_PROPERTY_SOURCE_RECTANGLE;
+
+    if (mask & ILM_NOTIFICATION_DEST_RECT)
+        wm_mask |= IVI_WM_PROPERTY_DESTINATION_RECTANGLE;
+
+    if (mask & ILM_NOTIFICATION_CONFIGURED)
+        wm_mask |= IVI_WM_PROPERTY_SIZE;
+
+    if (mask & (ILM_NOTIFICATION_STALLED | ILM_NOTIFICATION_RECOVERED))
+        wm_mask |= IVI_WM_PROPERTY_STALL;
+
+    if (mask & (ILM_NOTIFICATION_OCCLUDED | ILM_NOTIFICATION_REVEALED))
+        wm_mask |= IVI_WM_PROPERTY_OCCLUSION;
+
+    return wm_mask;
+}
+
+static t_ilm_notification_mask
+to_ilm_notification_mask(uint32_t mask)
+{
+    t_ilm_notification_mask ilm_mask = 0;
+
+    if (mask & IVI_WM_PROPERTY_VISIBILITY)
+        ilm_mask |= ILM_NOTIFICATION_VISIBILITY;
+
+    if (mask & IVI_WM_PROPERTY_OPACITY)
+        ilm_mask |= ILM_NOTIFICATION_OPACITY;
+
+    if (mask & IVI_WM_PROPERTY_SOURCE_RECTANGLE)
+        ilm_mask |= ILM_NOTIFICATION_SOURCE_RECT;
+
+    if (mask & IVI_WM_PROPERTY_DESTINATION_RECTANGLE)
+        ilm_mask |= ILM_NOTIFICATION_DEST_RECT;
+
+    if (mask & IVI_WM_PROPERTY_SIZE)
+        ilm_mask |= ILM_NOTIFICATION_CONFIGURED;
+
+    if (mask & IVI_WM_PROPERTY_STALL)
+        ilm_mask |= ILM_NOTIFICATION_STALLED | ILM_NOTIFICATION_RECOVERED;
+
+    if (mask & IVI_WM_PROPERTY_OCCLUSION)
+        ilm_mask |= ILM_NOTIFICATION_OCCLUDED | ILM_NOTIFICATION_REVEALED;
+
+    return ilm_mask;
+}
+
+static void
+wm_listener_surface_properties(void *data, struct ivi_wm *controller,
+                               uint32_t surface_id, uint32_t mask,
+                               int32_t visibility, wl_fixed_t opacity,
+                               int32_t source_x, int32_t source_y,
+                               int32_t source_width, int32_t source_height,
+                               int32_t dest_x, int32_t dest_y,
+                               int32_t dest_width, int32_t dest_height,
+                               int32_t width, int32_t height)
+{
+    struct wayland_context *ctx = data;
+    struct surface_context *ctx_surf;
+    (void)controller;
+
+    ctx_surf = get_surface_context(ctx, surface_id);
+    if(!ctx_surf)
+        return;
+
+    ctx_surf->prop.visibility = (t_ilm_bool)visibility;
+    ctx_surf->prop.opacity = (t_ilm_float)wl_fixed_to_double(opacity);
+    ctx_surf->prop.sourceX = (t_ilm_uint)source_x;
+    ctx_surf->prop.sourceY = (t_ilm_uint)source_y;
+    ctx_surf->prop.sourceWidth = (t_ilm_uint)source_width;
+    ctx_surf->prop.sourceHeight = (t_ilm_uint)source_height;
+    ctx_surf->prop.destX = (t_ilm_uint)dest_x;
+    ctx_surf->prop.destY = (t_ilm_uint)dest_y;
+    ctx_surf->prop.destWidth = (t_ilm_uint)dest_width;
+    ctx_surf->prop.destHeight = (t_ilm_uint)dest_height;
+
+    if (mask & IVI_WM_PROPERTY_SIZE) {
+        ctx_surf->prop.origSourceWidth = (t_ilm_uint)width;
+        ctx_surf->prop.origSourceHeight = (t_ilm_uint)height;
+    }
+
+    notify_surface(ctx_surf, to_ilm_notification_mask(mask));
+}
+
+static void
+wm_listener_layer_properties(void *data, struct ivi_wm *controller,
+                             uint32_t layer_id, uint32_t mask,
+                             int32_t visibility, wl_fixed_t opacity,
+                             int32_t source_x, int32_t source_y,
+                             int32_t source_width, int32_t source_height,
+                             int32_t dest_x, int32_t dest_y,
+                             int32_t dest_width, int32_t dest_height)
+{
+    struct wayland_context *ctx = data;
+    struct layer_context *ctx_layer;
+    (void)controller;
+
+    ctx_layer = wayland_controller_get_layer_context(ctx, layer_id);
+    if(!ctx_layer)
+        return;
+
+    ctx_layer->prop.visibility = (t_ilm_bool)visibility;
+    ctx_layer->prop.opacity = (t_ilm_float)wl_fixed_to_double(opacity);
+    ctx_layer->prop.sourceX = (t_ilm_uint)source_x;
+    ctx_layer->prop.sourceY = (t_ilm_uint)source_y;
+    ctx_layer->prop.sourceWidth = (t_ilm_uint)source_width;
+    ctx_layer->prop.sourceHeight = (t_ilm_uint)source_height;
+    ctx_layer->prop.destX = (t_ilm_uint)dest_x;
+    ctx_layer->prop.destY = (t_ilm_uint)dest_y;
+    ctx_layer->prop.destWidth = (t_ilm_uint)dest_width;
+    ctx_layer->prop.destHeight = (t_ilm_uint)dest_height;
+
+    notify_layer(ctx_layer, to_ilm_notification_mask(mask));
+}
+
+static void
+wm_listener_scene_generation(void *data, struct ivi_wm *controller,
+                             uint32_t generation)
+{
+    struct wayland_context *ctx = data;
+    (void)controller;
+
+    ivi_trace_event(ctx->trace, IVI_TRACE_INSTANT, "scene_generation", 0,
+                    "generation", generation);
+    ctx->scene_generation = generation;
+}
+
+static void
+wm_listener_request_stats(void *data, struct ivi_wm *controller,
+                          const char *interface, const char *request,
+                          uint32_t count, uint32_t total_us_hi,
+                          uint32_t total_us_lo, uint32_t max_us,
+                          struct wl_array *histogram)
+{
+    struct wayland_context *ctx = data;
+    struct ilmRequestStats *stats;
+    size_t size;
+    (void)controller;
+
+    stats = wl_array_add(&ctx->request_stats, sizeof *stats);
+    if (stats == NULL)
+        return;
+
+    memset(stats, 0, sizeof *stats);
+    strncpy(stats->interfaceName, interface, sizeof stats->interfaceName - 1);
+    strncpy(stats->requestName, request, sizeof stats->requestName - 1);
+    stats->count = count;
+    stats->totalTimeUs = (t_ilm_float)(((uint64_t)total_us_hi << 32) | total_us_lo);
+    stats->maxTimeUs = max_us;
+
+    size = histogram->size;
+    if (size > sizeof stats->histogram)
+        size = sizeof stats->histogram;
+    memcpy(stats->histogram, histogram->data, size);
+}
+
+static void
+wm_listener_client_stats(void *data, struct ivi_wm *controller,
+                         int32_t pid, uint32_t requests)
+{
+    struct wayland_context *ctx = data;
+    struct ilmClientStats *stats;
+    (void)controller;
+
+    stats = wl_array_add(&ctx->client_stats, sizeof *stats);
+    if (stats == NULL)
+        return;
+
+    stats->pid = pid;
+    stats->requestCount = requests;
+}
+
+static void
+wm_listener_surface_lifecycle(void *data, struct ivi_wm *controller,
+                              uint32_t surface_id, int32_t pid,
+                              uint32_t created_us_hi, uint32_t created_us_lo,
+                              struct wl_array *stages)
+{
+    struct wayland_context *ctx = data;
+    struct ilmSurfaceLifecycle *lifecycle;
+    uint64_t created_us = ((uint64_t)created_us_hi << 32) | created_us_lo;
+    size_t size;
+    int i;
+    (void)controller;
+
+    lifecycle = wl_array_add(&ctx->surface_lifecycles, sizeof *lifecycle);
+    if (lifecycle == NULL)
+        return;
+
+    lifecycle->surfaceId = surface_id;
+    lifecycle->pid = pid;
+    lifecycle->createdTimeMs = (t_ilm_uint)(created_us / 1000);
+
+    /* stages added by newer compositors are dropped */
+    for (i = 0; i < ILM_LIFECYCLE_STAGES; i++)
+        lifecycle->stageTimeUs[i] = ILM_LIFECYCLE_NOT_REACHED;
+
+    size = stages->size;
+    if (size > sizeof lifecycle->stageTimeUs)
+        size = sizeof lifecycle->stageTimeUs;
+    memcpy(lifecycle->stageTimeUs, stages->data, size);
+}
+
+static void
+wm_listener_surface_stalled(void *data, struct ivi_wm *controller,
+                            uint32_t surface_id, uint32_t since_commit)
+{
+    struct wayland_context *ctx = data;
+    struct surface_context *ctx_surf;
+    (void)controller;
+    (void)since_commit;
+
+    ctx_surf = get_surface_context(ctx, surface_id);
+    if(!ctx_surf)
+        return;
+
+    notify_surface(ctx_surf, ILM_NOTIFICATION_STALLED);
+}
+
+static void
+wm_listener_surface_recovered(void *data, struct ivi_wm *controller,
+                              uint32_t surface_id, uint32_t duration)
+{
+    struct wayland_context *ctx = data;
+    struct surface_context *ctx_surf;
+    (void)controller;
+    (void)duration;
+
+    ctx_surf = get_surface_context(ctx, surface_id);
+    if(!ctx_surf)
+        return;
+
+    notify_surface(ctx_surf, ILM_NOTIFICATION_RECOVERED);
+}
+
+static void
+wm_listener_surface_occluded(void *data, struct ivi_wm *controller,
+                             uint32_t surface_id, uint32_t occluded)
+{
+    struct wayland_context *ctx = data;
+    struct surface_context *ctx_surf;
+    (void)controller;
+
+    ctx_surf = get_surface_context(ctx, surface_id);
+    if(!ctx_surf)
+        return;
+
+    notify_surface(ctx_surf, occluded ? ILM_NOTIFICATION_OCCLUDED :
+                                        ILM_NOTIFICATION_REVEALED);
+}
+
 static struct ivi_wm_listener wm_listener=
 {
     wm_listener_surface_visibility,
@@ -623,6 +939,15 @@ static struct ivi_wm_listener wm_listener=
     wm_listener_surface_size,
     wm_listener_surface_stats,
     wm_listener_layer_surface_added,
+    wm_listener_surface_properties,
+    wm_listener_layer_properties,
+    wm_listener_scene_generation,
+    wm_listener_request_stats,
+    wm_listener_client_stats,
+    wm_listener_surface_lifecycle,
+    wm_listener_surface_stalled,
+    wm_listener_surface_recovered,
+    wm_listener_surface_occluded,
 };
 
 static void
@@ -690,12 +1015,79 @@ wm_screen_listener_error(void *data, struct ivi_wm_screen *controller,
         ctx_screen->ctx->error_flag = error_code;
 }
 
+static void
+wm_screen_listener_stats(void *data, struct ivi_wm_screen *controller,
+                         uint32_t frames, int32_t refresh,
+                         uint32_t repaint_us_hi, uint32_t repaint_us_lo,
+                         uint32_t repaint_max_us,
+                         struct wl_array *repaint_histogram,
+                         struct wl_array *interval_histogram,
+                         uint32_t missed_vblanks, uint32_t over_budget,
+                         wl_fixed_t views_mean, uint32_t views_max)
+{
+    struct screen_context *ctx_screen = data;
+    struct ilmScreenStats *stats = &ctx_screen->stats;
+    size_t size;
+    (void)controller;
+
+    memset(stats, 0, sizeof *stats);
+    stats->frameCount = frames;
+    stats->refreshRate = refresh;
+    stats->totalRepaintTimeUs =
+        (t_ilm_float)(((uint64_t)repaint_us_hi << 32) | repaint_us_lo);
+    stats->maxRepaintTimeUs = repaint_max_us;
+    stats->missedVblanks = missed_vblanks;
+    stats->overBudgetFrames = over_budget;
+    stats->meanViewCount = (t_ilm_float)wl_fixed_to_double(views_mean);
+    stats->maxViewCount = views_max;
+
+    size = repaint_histogram->size;
+    if (size > sizeof stats->repaintHistogram)
+        size = sizeof stats->repaintHistogram;
+    memcpy(stats->repaintHistogram, repaint_histogram->data, size);
+
+    size = interval_histogram->size;
+    if (size > sizeof stats->intervalHistogram)
+        size = sizeof stats->intervalHistogram;
+    memcpy(stats->intervalHistogram, interval_histogram->data, size);
+}
+
+static void
+wm_screen_listener_coverage(void *data, struct ivi_wm_screen *controller,
+                            uint32_t surface_id, uint32_t area,
+                            uint32_t visible_area)
+{
+    struct screen_context *ctx_screen = data;
+    struct ilmSurfaceCoverage *coverage;
+    (void)controller;
+
+    coverage = wl_array_add(&ctx_screen->coverage, sizeof *coverage);
+    if (coverage == NULL)
+        return;
+
+    coverage->surfaceId = surface_id;
+    coverage->area = area;
+    coverage->visibleArea = visible_area;
+}
+
+static void
+wm_screen_listener_coverage_done(void *data, struct ivi_wm_screen *controller)
+{
+    struct screen_context *ctx_screen = data;
+    (void)controller;
+
+    ctx_screen->coverage_done = 1;
+}
+
 static struct ivi_wm_screen_listener wm_screen_listener=
 {
     wm_screen_listener_screen_id,
     wm_screen_listener_layer_added,
     wm_screen_listener_connector_name,
-    wm_screen_listener_error
+    wm_screen_listener_error,
+    wm_screen_listener_stats,
+    wm_screen_listener_coverage,
+    wm_screen_listener_coverage_done
 };
 
 static struct seat_context *
@@ -817,7 +1209,7 @@ input_listener_input_acceptance(void *data,
             /* Remove this from the accepted seats */
             free(accepted_seat->seat_name);
             wl_list_remove(&accepted_seat->link);
-            free(accepted_seat);
+            ivi_pool_free(&accepted_seat_pool, accepted_seat);
             return;
         }
         accepted_seat_found = 1;
@@ -834,7 +1226,7 @@ input_listener_input_acceptance(void *data,
         return;
     }
 
-    accepted_seat = calloc(1, sizeof(*accepted_seat));
+    accepted_seat = ivi_pool_zalloc(&accepted_seat_pool);
     if (accepted_seat == NULL) {
         fprintf(stderr, "Failed to allocate memory for accepted seat\n");
         return;
@@ -858,11 +1250,20 @@ registry_handle_control(void *data,
                        uint32_t version)
 {
     struct wayland_context *ctx = data;
-    (void)version;
 
     if (strcmp(interface, "ivi_wm") == 0) {
+        /* version 2 coalesces property changes into one event per frame,
+         * the later versions add the diagnostics of the compositor:
+         * 3 the request statistics,
+         * 4 the trace flows,
+         * 5 the surface lifecycles,
+         * 6 the screen statistics,
+         * 7 the stall watchdog,
+         * 8 the occlusion events,
+         * 9 the screen coverage */
         ctx->controller = wl_registry_bind(registry, name,
-                                           &ivi_wm_interface, 1);
+                                           &ivi_wm_interface,
+                                           version < 9 ? version : 9);
         if (ctx->controller == NULL) {
             fprintf(stderr, "Failed to registry bind ivi_wm\n");
             return;
@@ -982,11 +1383,11 @@ static void destroy_control_resources(void)
                 wl_list_for_each_safe(seat, seat_next, &l->list_accepted_seats, link) {
                     wl_list_remove(&seat->link);
                     free(seat->seat_name);
-                    free(seat);
+                    ivi_pool_free(&accepted_seat_pool, seat);
                 }
 
                 wl_list_remove(&l->link);
-                free(l);
+                ivi_pool_free(&surface_context_pool, l);
             }
         }
 
@@ -996,7 +1397,7 @@ static void destroy_control_resources(void)
             wl_list_for_each_safe(l, n, &ctx->wl.list_layer, link) {
                 wl_list_remove(&l->link);
                 wl_array_release(&l->render_order);
-                free(l);
+                ivi_pool_free(&layer_context_pool, l);
             }
         }
 
@@ -1032,6 +1433,10 @@ static void destroy_control_resources(void)
         ctx->wl.input_controller = NULL;
     }
 
+    release_pool(&surface_context_pool);
+    release_pool(&layer_context_pool);
+    release_pool(&accepted_seat_pool);
+
     if (0 != pthread_mutex_destroy(&ctx->mutex)) {
         fprintf(stderr, "failed to destroy pthread_mutex\n");
     }
@@ -1044,6 +1449,49 @@ static void send_shutdown_event(struct ilm_control_context *ctx)
        ;
 }
 
+/* writes the trace to filename, or to $ILM_TRACE_FILE.<pid> if NULL */
+static int
+dump_trace(struct ilm_control_context *ctx, const char *filename)
+{
+    char path[PATH_MAX];
+    const char *trace_file;
+
+    if (ctx->wl.trace == NULL)
+        return -1;
+
+    if (filename == NULL) {
+        trace_file = getenv("ILM_TRACE_FILE");
+        if (trace_file == NULL)
+            return -1;
+
+        snprintf(path, sizeof path, "%s.%d", trace_file, (int)getpid());
+        filename = path;
+    }
+
+    if (ivi_trace_dump(ctx->wl.trace, filename) < 0) {
+        fprintf(stderr, "failed to write trace to %s\n", filename);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void
+init_trace(struct ilm_control_context *ctx)
+{
+    const char *size;
+    uint32_t events = 65536;
+
+    if (getenv("ILM_TRACE_FILE") == NULL)
+        return;
+
+    size = getenv("ILM_TRACE_BUFFER_SIZE");
+    if (size != NULL)
+        events = (uint32_t)strtoul(size, NULL, 0);
+
+    ctx->wl.trace = ivi_trace_create(events);
+}
+
 ILM_EXPORT void
 ilmControl_destroy(void)
 {
@@ -1069,6 +1517,9 @@ ilmControl_destroy(void)
     if (ctx->shutdown_fd > -1)
         close(ctx->shutdown_fd);
 
+    dump_trace(ctx, NULL);
+    ivi_trace_destroy(ctx->wl.trace);
+
     memset(ctx, 0, sizeof *ctx);
 }
 
@@ -1090,6 +1541,7 @@ ilmControl_init(t_ilm_nativedisplay nativedisplay)
     ctx->shutdown_fd = -1;
 
     ctx->wl.display = (struct wl_display*)nativedisplay;
+    init_trace(ctx);
 
     wl_list_init(&ctx->wl.list_screen);
     wl_list_init(&ctx->wl.list_layer);
@@ -1144,7 +1596,9 @@ control_thread(void *p_ret)
         while (wl_display_prepare_read_queue(display, queue) != 0)
         {
             lock_context(ctx);
+            ivi_trace_event(wl->trace, IVI_TRACE_BEGIN, "dispatch", 0, NULL, 0);
             wl_display_dispatch_queue_pending(display, queue);
+            ivi_trace_event(wl->trace, IVI_TRACE_END, "dispatch", 0, NULL, 0);
             unlock_context(ctx);
         }
 
@@ -1164,7 +1618,9 @@ control_thread(void *p_ret)
             wl_display_read_events(display);
 
             lock_context(ctx);
+            ivi_trace_event(wl->trace, IVI_TRACE_BEGIN, "dispatch", 0, NULL, 0);
             int ret = wl_display_dispatch_queue_pending(display, queue);
+            ivi_trace_event(wl->trace, IVI_TRACE_END, "dispatch", 0, NULL, 0);
             unlock_context(ctx);
 
             if (ret == -1)
@@ -1647,27 +2103,216 @@ ilm_getSurfaceIDsOnLayer(t_ilm_layer layer,
     return ILM_SUCCESS;
 }
 
-ILM_EXPORT ilmErrorTypes
-ilm_layerCreateWithDimension(t_ilm_layer* pLayerId,
-                                 t_ilm_uint width,
-                                 t_ilm_uint height)
+/*
+ * The *Buffer variants below fill a caller provided array instead of
+ * allocating one. Like the allocating getters they do a roundtrip first,
+ * so changes committed right before the call are included. Render orders
+ * reuse the wl_array of the context between calls.
+ */
+static ilmErrorTypes
+check_id_buffer(t_ilm_uint length, t_ilm_int capacity, const void *pArray)
 {
-    ilmErrorTypes returnValue = ILM_FAILED;
-    struct ilm_control_context *ctx = sync_and_acquire_instance();
-    uint32_t layerid = 0;
-    int32_t is_inside = 0;
+    if (pArray == NULL)
+        return ILM_SUCCESS;
 
-    do {
-        if (pLayerId == NULL) {
-            break;
+    if ((capacity < 0) || (length > (t_ilm_uint)capacity))
+        return ILM_ERROR_INVALID_ARGUMENTS;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+copy_render_order(struct wl_array *render_order, t_ilm_int capacity,
+                  t_ilm_int *pLength, t_ilm_uint *pArray)
+{
+    ilmErrorTypes returnValue;
+    t_ilm_uint length = render_order->size / sizeof(uint32_t);
+    uint32_t *id = NULL;
+
+    *pLength = length;
+    returnValue = check_id_buffer(length, capacity, pArray);
+
+    if ((returnValue == ILM_SUCCESS) && (pArray != NULL)) {
+        wl_array_for_each(id, render_order) {
+            *pArray = (t_ilm_uint) *id;
+            pArray++;
         }
+    }
 
-        if (*pLayerId != INVALID_ID) {
-            /* Return failed, if layerid is already inside list_layer */
-            is_inside = wayland_controller_is_inside_layer_list(
-                            &ctx->wl.list_layer, *pLayerId);
-            if (0 != is_inside) {
-                fprintf(stderr, "layerid=%d is already used.\n", *pLayerId);
+    /* keep the allocation for the next query */
+    render_order->size = 0;
+
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getScreenIDsBuffer(t_ilm_int capacity, t_ilm_uint* pNumberOfIDs,
+                       t_ilm_uint* pIDs)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct screen_context *ctx_scrn = NULL;
+    t_ilm_uint length;
+
+    if (pNumberOfIDs == NULL)
+        return ILM_FAILED;
+
+    if (impl_sync_and_acquire_instance(ctx) != ILM_SUCCESS)
+        return ILM_FAILED;
+
+    length = wl_list_length(&ctx->wl.list_screen);
+    *pNumberOfIDs = length;
+    returnValue = check_id_buffer(length, capacity, pIDs);
+
+    if ((returnValue == ILM_SUCCESS) && (pIDs != NULL)) {
+        // compositor sends screens in opposite order
+        wl_list_for_each_reverse(ctx_scrn, &ctx->wl.list_screen, link) {
+            *pIDs = ctx_scrn->id_screen;
+            pIDs++;
+        }
+    }
+
+    unlock_context(ctx);
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getLayerIDsBuffer(t_ilm_int capacity, t_ilm_int* pLength,
+                      t_ilm_layer* pArray)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct layer_context *ctx_layer = NULL;
+    t_ilm_uint length;
+
+    if (pLength == NULL)
+        return ILM_FAILED;
+
+    if (impl_sync_and_acquire_instance(ctx) != ILM_SUCCESS)
+        return ILM_FAILED;
+
+    length = wl_list_length(&ctx->wl.list_layer);
+    *pLength = length;
+    returnValue = check_id_buffer(length, capacity, pArray);
+
+    if ((returnValue == ILM_SUCCESS) && (pArray != NULL)) {
+        // compositor sends layers in opposite order
+        wl_list_for_each_reverse(ctx_layer, &ctx->wl.list_layer, link) {
+            *pArray = ctx_layer->id_layer;
+            pArray++;
+        }
+    }
+
+    unlock_context(ctx);
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getSurfaceIDsBuffer(t_ilm_int capacity, t_ilm_int* pLength,
+                        t_ilm_surface* pArray)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct surface_context *ctx_surf = NULL;
+    t_ilm_uint length;
+
+    if (pLength == NULL)
+        return ILM_FAILED;
+
+    if (impl_sync_and_acquire_instance(ctx) != ILM_SUCCESS)
+        return ILM_FAILED;
+
+    length = wl_list_length(&ctx->wl.list_surface);
+    *pLength = length;
+    returnValue = check_id_buffer(length, capacity, pArray);
+
+    if ((returnValue == ILM_SUCCESS) && (pArray != NULL)) {
+        wl_list_for_each_reverse(ctx_surf, &ctx->wl.list_surface, link) {
+            *pArray = ctx_surf->id_surface;
+            pArray++;
+        }
+    }
+
+    unlock_context(ctx);
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getLayerIDsOnScreenBuffer(t_ilm_uint screenId, t_ilm_int capacity,
+                              t_ilm_int* pLength, t_ilm_layer* pArray)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct screen_context *ctx_screen = NULL;
+
+    if (!ctx->initialized || (pLength == NULL))
+        return ILM_FAILED;
+
+    lock_context(ctx);
+
+    ctx_screen = get_screen_context_by_id(&ctx->wl, screenId);
+    if (ctx_screen != NULL) {
+        ctx_screen->render_order.size = 0;
+        ivi_wm_screen_get(ctx_screen->controller, IVI_WM_PARAM_RENDER_ORDER);
+
+        if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1)
+            returnValue = copy_render_order(&ctx_screen->render_order,
+                                            capacity, pLength, pArray);
+    }
+
+    unlock_context(ctx);
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getSurfaceIDsOnLayerBuffer(t_ilm_layer layer, t_ilm_int capacity,
+                               t_ilm_int* pLength, t_ilm_surface* pArray)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct layer_context *ctx_layer = NULL;
+
+    if (!ctx->initialized || (pLength == NULL))
+        return ILM_FAILED;
+
+    lock_context(ctx);
+
+    ctx_layer = (struct layer_context*)wayland_controller_get_layer_context(
+                    &ctx->wl, (uint32_t)layer);
+    if (ctx_layer != NULL) {
+        ctx_layer->render_order.size = 0;
+        ivi_wm_layer_get(ctx->wl.controller, layer, IVI_WM_PARAM_RENDER_ORDER);
+
+        if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1)
+            returnValue = copy_render_order(&ctx_layer->render_order,
+                                            capacity, pLength, pArray);
+    }
+
+    unlock_context(ctx);
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_layerCreateWithDimension(t_ilm_layer* pLayerId,
+                                 t_ilm_uint width,
+                                 t_ilm_uint height)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = sync_and_acquire_instance();
+    uint32_t layerid = 0;
+    int32_t is_inside = 0;
+
+    do {
+        if (pLayerId == NULL) {
+            break;
+        }
+
+        if (*pLayerId != INVALID_ID) {
+            /* Return failed, if layerid is already inside list_layer */
+            is_inside = wayland_controller_is_inside_layer_list(
+                            &ctx->wl.list_layer, *pLayerId);
+            if (0 != is_inside) {
+                fprintf(stderr, "layerid=%d is already used.\n", *pLayerId);
                 break;
             }
             layerid = *pLayerId;
@@ -2192,21 +2837,81 @@ ilm_takeSurfaceScreenshot(t_ilm_const_string filename,
     return returnValue;
 }
 
+static void
+layer_sync_add(struct wayland_context *ctx, t_ilm_layer layer,
+               t_ilm_notification_mask mask)
+{
+    if (ivi_wm_get_version(ctx->controller) >= IVI_WM_LAYER_SYNC_MASK_SINCE_VERSION)
+        ivi_wm_layer_sync_mask(ctx->controller, layer, to_wm_property_mask(mask));
+    else
+        ivi_wm_layer_sync(ctx->controller, layer, IVI_WM_SYNC_ADD);
+}
+
+static ilmErrorTypes
+layer_add_notification(struct ilm_control_context *ctx, t_ilm_layer layer,
+                       t_ilm_notification_mask mask,
+                       layerNotificationFunc callback)
+{
+    struct layer_context *ctx_layer = NULL;
+
+    ctx_layer = (struct layer_context*)wayland_controller_get_layer_context(
+                    &ctx->wl, (uint32_t)layer);
+    if (ctx_layer == NULL)
+        return ILM_ERROR_INVALID_ARGUMENTS;
+
+    ctx_layer->notification = callback;
+    ctx_layer->notification_mask = mask;
+    layer_sync_add(&ctx->wl, layer, mask);
+    if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) == -1)
+        fprintf(stderr, "wl_display_roundtrip queue failed\n");
+
+    return ILM_SUCCESS;
+}
+
 ILM_EXPORT ilmErrorTypes
 ilm_layerAddNotification(t_ilm_layer layer,
                              layerNotificationFunc callback)
 {
     ilmErrorTypes returnValue = ILM_FAILED;
     struct ilm_control_context *ctx = sync_and_acquire_instance();
-    struct layer_context *ctx_layer = NULL;
 
-    ctx_layer = (struct layer_context*)wayland_controller_get_layer_context(
-                    &ctx->wl, (uint32_t)layer);
-    if (ctx_layer == NULL) {
+    returnValue = layer_add_notification(ctx, layer, ILM_NOTIFICATION_ALL,
+                                         callback);
+
+    release_instance();
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_layerAddNotificationWithMask(t_ilm_layer layer,
+                                 t_ilm_notification_mask mask,
+                                 layerNotificationFunc callback)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = sync_and_acquire_instance();
+
+    returnValue = layer_add_notification(ctx, layer, mask, callback);
+
+    release_instance();
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_layerAddNotificationAll(t_ilm_notification_mask mask,
+                            layerNotificationFunc callback)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = sync_and_acquire_instance();
+
+    if (callback == NULL) {
         returnValue = ILM_ERROR_INVALID_ARGUMENTS;
+    } else if (ivi_wm_get_version(ctx->wl.controller) <
+               IVI_WM_LAYER_SYNC_ALL_SINCE_VERSION) {
+        returnValue = ILM_ERROR_NOT_IMPLEMENTED;
     } else {
-        ctx_layer->notification = callback;
-        ivi_wm_layer_sync(ctx->wl.controller, layer, IVI_WM_SYNC_ADD);
+        ctx->wl.layer_notification_all = callback;
+        ctx->wl.layer_notification_all_mask = mask;
+        ivi_wm_layer_sync_all(ctx->wl.controller, to_wm_property_mask(mask));
         if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) == -1)
             fprintf(stderr, "wl_display_roundtrip queue failed\n");
 
@@ -2217,6 +2922,27 @@ ilm_layerAddNotification(t_ilm_layer layer,
     return returnValue;
 }
 
+ILM_EXPORT ilmErrorTypes
+ilm_layerRemoveNotificationAll(void)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = sync_and_acquire_instance();
+
+    if (ctx->wl.layer_notification_all == NULL) {
+        returnValue = ILM_ERROR_INVALID_ARGUMENTS;
+    } else {
+        ivi_wm_layer_sync_all(ctx->wl.controller, 0);
+        wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue);
+
+        ctx->wl.layer_notification_all = NULL;
+        ctx->wl.layer_notification_all_mask = 0;
+        returnValue = ILM_SUCCESS;
+    }
+
+    release_instance();
+    return returnValue;
+}
+
 ILM_EXPORT ilmErrorTypes
 ilm_layerRemoveNotification(t_ilm_layer layer)
 {
@@ -2247,7 +2973,7 @@ create_surface_context(struct wayland_context *ctx, uint32_t id_surface)
 {
     struct surface_context *ctx_surf = NULL;
 
-    ctx_surf = calloc(1, sizeof *ctx_surf);
+    ctx_surf = ivi_pool_zalloc(&surface_context_pool);
     if (ctx_surf == NULL) {
         fprintf(stderr, "Failed to allocate memory for surface_context\n");
         return NULL;
@@ -2290,12 +3016,22 @@ ilm_unregisterNotification(void)
    return ilm_registerNotification(NULL, NULL);
 }
 
-ILM_EXPORT ilmErrorTypes
-ilm_surfaceAddNotification(t_ilm_surface surface,
-                             surfaceNotificationFunc callback)
+static void
+surface_sync_add(struct wayland_context *ctx, t_ilm_surface surface,
+                 t_ilm_notification_mask mask)
+{
+    if (ivi_wm_get_version(ctx->controller) >= IVI_WM_SURFACE_SYNC_MASK_SINCE_VERSION)
+        ivi_wm_surface_sync_mask(ctx->controller, surface, to_wm_property_mask(mask));
+    else
+        ivi_wm_surface_sync(ctx->controller, surface, IVI_WM_SYNC_ADD);
+}
+
+static ilmErrorTypes
+surface_add_notification(struct ilm_control_context *ctx, t_ilm_surface surface,
+                         t_ilm_notification_mask mask,
+                         surfaceNotificationFunc callback)
 {
     ilmErrorTypes returnValue = ILM_FAILED;
-    struct ilm_control_context *ctx = sync_and_acquire_instance();
     struct surface_context *ctx_surf = NULL;
 
     ctx_surf = (struct surface_context*)get_surface_context(
@@ -2310,7 +3046,8 @@ ilm_surfaceAddNotification(t_ilm_surface surface,
     else {
         if (callback != NULL) {
             ctx_surf->notification = callback;
-            ivi_wm_surface_sync(ctx->wl.controller, surface, IVI_WM_SYNC_ADD);
+            ctx_surf->notification_mask = mask;
+            surface_sync_add(&ctx->wl, surface, mask);
             if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) == -1)
                 fprintf(stderr, "wl_display_roundtrip queue failed\n");
 
@@ -2324,6 +3061,81 @@ ilm_surfaceAddNotification(t_ilm_surface surface,
     }
     else {
         ctx_surf->notification = callback;
+        ctx_surf->notification_mask = mask;
+        returnValue = ILM_SUCCESS;
+    }
+
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_surfaceAddNotification(t_ilm_surface surface,
+                             surfaceNotificationFunc callback)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = sync_and_acquire_instance();
+
+    returnValue = surface_add_notification(ctx, surface, ILM_NOTIFICATION_ALL,
+                                           callback);
+
+    release_instance();
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_surfaceAddNotificationWithMask(t_ilm_surface surface,
+                                   t_ilm_notification_mask mask,
+                                   surfaceNotificationFunc callback)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = sync_and_acquire_instance();
+
+    returnValue = surface_add_notification(ctx, surface, mask, callback);
+
+    release_instance();
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_surfaceAddNotificationAll(t_ilm_notification_mask mask,
+                              surfaceNotificationFunc callback)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = sync_and_acquire_instance();
+
+    if (callback == NULL) {
+        returnValue = ILM_ERROR_INVALID_ARGUMENTS;
+    } else if (ivi_wm_get_version(ctx->wl.controller) <
+               IVI_WM_SURFACE_SYNC_ALL_SINCE_VERSION) {
+        returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+    } else {
+        ctx->wl.surface_notification_all = callback;
+        ctx->wl.surface_notification_all_mask = mask;
+        ivi_wm_surface_sync_all(ctx->wl.controller, to_wm_property_mask(mask));
+        if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) == -1)
+            fprintf(stderr, "wl_display_roundtrip queue failed\n");
+
+        returnValue = ILM_SUCCESS;
+    }
+
+    release_instance();
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_surfaceRemoveNotificationAll(void)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = sync_and_acquire_instance();
+
+    if (ctx->wl.surface_notification_all == NULL) {
+        returnValue = ILM_ERROR_INVALID_ARGUMENTS;
+    } else {
+        ivi_wm_surface_sync_all(ctx->wl.controller, 0);
+        wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue);
+
+        ctx->wl.surface_notification_all = NULL;
+        ctx->wl.surface_notification_all_mask = 0;
         returnValue = ILM_SUCCESS;
     }
 
@@ -2474,6 +3286,24 @@ ilm_surfaceSetSourceRectangle(t_ilm_surface surfaceId,
     return returnValue;
 }
 
+static void
+trace_commit_flow(struct wayland_context *wl)
+{
+    uint64_t flow_id;
+
+    if (wl->trace == NULL)
+        return;
+
+    /* unique across the processes whose traces are merged */
+    flow_id = ((uint64_t)getpid() << 32) | ++wl->trace_flow_seq;
+    ivi_trace_event(wl->trace, IVI_TRACE_FLOW_START, "ilm_commitChanges",
+                    flow_id, NULL, 0);
+
+    if (ivi_wm_get_version(wl->controller) >= IVI_WM_TRACE_FLOW_SINCE_VERSION)
+        ivi_wm_trace_flow(wl->controller, (uint32_t)(flow_id >> 32),
+                          (uint32_t)flow_id);
+}
+
 ILM_EXPORT ilmErrorTypes
 ilm_commitChanges(void)
 {
@@ -2481,7 +3311,9 @@ ilm_commitChanges(void)
     struct ilm_control_context *const ctx = &ilm_context;
 
     lock_context(ctx);
+    IVI_TRACE_SCOPE(ctx->wl.trace, "ilm_commitChanges");
     if (ctx->wl.controller) {
+        trace_commit_flow(&ctx->wl);
         ivi_wm_commit_changes(ctx->wl.controller);
 
         if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1)
@@ -2494,6 +3326,257 @@ ilm_commitChanges(void)
     return returnValue;
 }
 
+ILM_EXPORT ilmErrorTypes
+ilm_getSceneGeneration(t_ilm_uint* pGeneration)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+
+    if (!ctx->initialized || (pGeneration == NULL))
+        return ILM_FAILED;
+
+    /* kept up to date by the control thread, no roundtrip needed */
+    lock_context(ctx);
+    if (ivi_wm_get_version(ctx->wl.controller) <
+        IVI_WM_SCENE_GENERATION_SINCE_VERSION) {
+        returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+    } else {
+        *pGeneration = ctx->wl.scene_generation;
+        returnValue = ILM_SUCCESS;
+    }
+    unlock_context(ctx);
+
+    return returnValue;
+}
+
+static void *
+copy_stats(struct wl_array *array, size_t element_size, t_ilm_uint *pCount)
+{
+    void *copy;
+
+    *pCount = array->size / element_size;
+    copy = malloc(array->size ? array->size : element_size);
+    if (copy != NULL && array->size)
+        memcpy(copy, array->data, array->size);
+
+    return copy;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getStats(t_ilm_uint* pRequestCount, struct ilmRequestStats** ppRequests,
+             t_ilm_uint* pClientCount, struct ilmClientStats** ppClients)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+
+    if (!ctx->initialized || (pRequestCount == NULL) || (ppRequests == NULL) ||
+        (pClientCount == NULL) || (ppClients == NULL))
+        return ILM_FAILED;
+
+    lock_context(ctx);
+    if (ivi_wm_get_version(ctx->wl.controller) <
+        IVI_WM_GET_STATS_SINCE_VERSION) {
+        unlock_context(ctx);
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    wl_array_init(&ctx->wl.request_stats);
+    wl_array_init(&ctx->wl.client_stats);
+
+    /* all statistics events are sent before the roundtrip completes */
+    ivi_wm_get_stats(ctx->wl.controller);
+    if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1) {
+        *ppRequests = copy_stats(&ctx->wl.request_stats,
+                                 sizeof **ppRequests, pRequestCount);
+        *ppClients = copy_stats(&ctx->wl.client_stats,
+                                sizeof **ppClients, pClientCount);
+
+        if (*ppRequests != NULL && *ppClients != NULL) {
+            returnValue = ILM_SUCCESS;
+        } else {
+            free(*ppRequests);
+            free(*ppClients);
+            *ppRequests = NULL;
+            *ppClients = NULL;
+        }
+    }
+
+    wl_array_release(&ctx->wl.request_stats);
+    wl_array_release(&ctx->wl.client_stats);
+    wl_array_init(&ctx->wl.request_stats);
+    wl_array_init(&ctx->wl.client_stats);
+    unlock_context(ctx);
+
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getScreenStats(t_ilm_display screenID, struct ilmScreenStats* pStats)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct screen_context *ctx_screen;
+
+    if (!ctx->initialized || (pStats == NULL))
+        return ILM_FAILED;
+
+    lock_context(ctx);
+    ctx_screen = get_screen_context_by_id(&ctx->wl, (uint32_t)screenID);
+    if (ctx_screen == NULL) {
+        unlock_context(ctx);
+        return ILM_FAILED;
+    }
+
+    if (ivi_wm_screen_get_version(ctx_screen->controller) <
+        IVI_WM_SCREEN_GET_STATS_SINCE_VERSION) {
+        unlock_context(ctx);
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    ivi_wm_screen_get_stats(ctx_screen->controller);
+    if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1) {
+        *pStats = ctx_screen->stats;
+        returnValue = ILM_SUCCESS;
+    }
+
+    unlock_context(ctx);
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getScreenCoverage(t_ilm_display screenID, t_ilm_uint* pCount,
+                      struct ilmSurfaceCoverage** ppCoverage)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct screen_context *ctx_screen;
+
+    if (!ctx->initialized || (pCount == NULL) || (ppCoverage == NULL))
+        return ILM_FAILED;
+
+    lock_context(ctx);
+    ctx_screen = get_screen_context_by_id(&ctx->wl, (uint32_t)screenID);
+    if (ctx_screen == NULL) {
+        unlock_context(ctx);
+        return ILM_FAILED;
+    }
+
+    if (ivi_wm_screen_get_version(ctx_screen->controller) <
+        IVI_WM_SCREEN_GET_COVERAGE_SINCE_VERSION) {
+        unlock_context(ctx);
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    wl_array_init(&ctx_screen->coverage);
+    ctx_screen->coverage_done = 0;
+
+    ivi_wm_screen_get_coverage(ctx_screen->controller);
+    if ((wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1) &&
+        ctx_screen->coverage_done) {
+        *ppCoverage = copy_stats(&ctx_screen->coverage,
+                                 sizeof **ppCoverage, pCount);
+        if (*ppCoverage != NULL)
+            returnValue = ILM_SUCCESS;
+    }
+
+    wl_array_release(&ctx_screen->coverage);
+    wl_array_init(&ctx_screen->coverage);
+    unlock_context(ctx);
+
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getSurfaceLifecycles(t_ilm_uint* pCount,
+                         struct ilmSurfaceLifecycle** ppLifecycles)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+
+    if (!ctx->initialized || (pCount == NULL) || (ppLifecycles == NULL))
+        return ILM_FAILED;
+
+    lock_context(ctx);
+    if (ivi_wm_get_version(ctx->wl.controller) <
+        IVI_WM_GET_SURFACE_LIFECYCLE_SINCE_VERSION) {
+        unlock_context(ctx);
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    wl_array_init(&ctx->wl.surface_lifecycles);
+
+    ivi_wm_get_surface_lifecycle(ctx->wl.controller);
+    if (wl_display_roundtrip_queue(ctx->wl.display, ctx->wl.queue) != -1) {
+        *ppLifecycles = copy_stats(&ctx->wl.surface_lifecycles,
+                                   sizeof **ppLifecycles, pCount);
+        if (*ppLifecycles != NULL)
+            returnValue = ILM_SUCCESS;
+    }
+
+    wl_array_release(&ctx->wl.surface_lifecycles);
+    wl_array_init(&ctx->wl.surface_lifecycles);
+    unlock_context(ctx);
+
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_dumpTrace(const char* filename)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *const ctx = &ilm_context;
+
+    if (!ctx->initialized)
+        return ILM_FAILED;
+
+    if (ctx->wl.trace == NULL)
+        return ILM_ERROR_NOT_IMPLEMENTED;
+
+    if (dump_trace(ctx, filename) == 0)
+        returnValue = ILM_SUCCESS;
+
+    return returnValue;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getPoolStats(t_ilm_uint* pCount, struct ilmPoolStats** ppStats)
+{
+    struct ilm_control_context *const ctx = &ilm_context;
+    struct ivi_pool *pools[] = {
+        &surface_context_pool,
+        &layer_context_pool,
+        &accepted_seat_pool,
+    };
+    const t_ilm_uint count = sizeof pools / sizeof pools[0];
+    struct ivi_pool_stats stats;
+    t_ilm_uint i;
+
+    if (!ctx->initialized || (pCount == NULL) || (ppStats == NULL))
+        return ILM_FAILED;
+
+    *ppStats = calloc(count, sizeof **ppStats);
+    if (*ppStats == NULL)
+        return ILM_FAILED;
+
+    lock_context(ctx);
+
+    for (i = 0; i < count; i++) {
+        ivi_pool_get_stats(pools[i], &stats);
+        strncpy((*ppStats)[i].name, pools[i]->name,
+                sizeof (*ppStats)[i].name - 1);
+        (*ppStats)[i].inUse = stats.in_use;
+        (*ppStats)[i].peak = stats.peak;
+        (*ppStats)[i].slabs = stats.slabs;
+        (*ppStats)[i].allocs = (t_ilm_uint)stats.allocs;
+        (*ppStats)[i].frees = (t_ilm_uint)stats.frees;
+    }
+
+    unlock_context(ctx);
+
+    *pCount = count;
+    return ILM_SUCCESS;
+}
+
 ILM_EXPORT ilmErrorTypes
 ilm_getError(void)
 {
@@ -358,7 +358,7 @@ TEST_F(NotificationTest, NotifyOnLayerMultipleValues1)
     ilm_commitChanges();
 
     // expect callback to have been called
-    assertCallbackcalled(2);
+    assertCallbackcalled();
 
     EXPECT_EQ(layer,callbackLayerId);
     EXPECT_EQ(33u,LayerProperties.sourceX);
@@ -382,7 +382,7 @@ TEST_F(NotificationTest, NotifyOnLayerMultipleValues2)
     ilm_commitChanges();
 
     // expect callback to have been called
-    assertCallbackcalled(3);
+    assertCallbackcalled();
 
     EXPECT_EQ(layer,callbackLayerId);
     EXPECT_TRUE(LayerProperties.visibility);
@@ -408,7 +408,7 @@ TEST_F(NotificationTest, NotifyOnLayerAllValues)
     ilm_commitChanges();
 
     // expect callback to have been called
-    assertCallbackcalled(4);
+    assertCallbackcalled();
 
     EXPECT_EQ(layer,callbackLayerId);
     EXPECT_EQ(33u,LayerProperties.sourceX);
@@ -584,7 +584,7 @@ TEST_F(NotificationTest, NotifyOnSurfaceMultipleValues1)
     ilm_commitChanges();
 
     // expect callback to have been called
-    assertCallbackcalled(3);
+    assertCallbackcalled(2);
 
     EXPECT_EQ(surface,callbackSurfaceId);
     EXPECT_EQ(33u,SurfaceProperties.sourceX);
@@ -608,7 +608,7 @@ TEST_F(NotificationTest, NotifyOnSurfaceMultipleValues2)
     ilm_commitChanges();
 
     // expect callback to have been called
-    assertCallbackcalled(4);
+    assertCallbackcalled(2);
 
     EXPECT_EQ(surface,callbackSurfaceId);
     EXPECT_TRUE(SurfaceProperties.visibility);
@@ -635,7 +635,7 @@ TEST_F(NotificationTest, NotifyOnSurfaceAllValues)
     ilm_commitChanges();
 
     // expect callback to have been called
-    assertCallbackcalled(5);
+    assertCallbackcalled(2);
 
     EXPECT_EQ(surface,callbackSurfaceId);
     EXPECT_EQ(33u,SurfaceProperties.sourceX);
@@ -726,3 +726,59 @@ TEST_F(NotificationTest, DefaultIsNotToReceiveNotificationsSurface)
     // assert that we have not been notified
     assertNoCallbackIsCalled();
 }
+
+TEST_F(NotificationTest, NotifyOnLayerWithMask)
+{
+    ASSERT_EQ(ILM_SUCCESS,ilm_layerAddNotificationWithMask(layer,
+                                                           ILM_NOTIFICATION_VISIBILITY,
+                                                           &LayerCallbackFunction));
+    // change something
+    t_ilm_float opacity = 0.789;
+    ilm_layerSetOpacity(layer,opacity);
+    ilm_layerSetVisibility(layer,true);
+    ilm_commitChanges();
+
+    // expect callback to have been called for visibility only
+    assertCallbackcalled();
+
+    EXPECT_EQ(layer,callbackLayerId);
+    EXPECT_TRUE(LayerProperties.visibility);
+    EXPECT_EQ(ILM_NOTIFICATION_VISIBILITY,mask);
+
+    // a change outside of the mask is not notified
+    ilm_layerSetOpacity(layer,0.5);
+    ilm_commitChanges();
+    assertNoCallbackIsCalled();
+
+    ASSERT_EQ(ILM_SUCCESS,ilm_layerRemoveNotification(layer));
+}
+
+TEST_F(NotificationTest, NotifyOnAllLayers)
+{
+    ASSERT_EQ(ILM_SUCCESS,ilm_layerAddNotificationAll(ILM_NOTIFICATION_DEST_RECT,
+                                                      &LayerCallbackFunction));
+
+    // a layer created after the registration is covered as well
+    t_ilm_uint newLayer = 346;
+    ASSERT_EQ(ILM_SUCCESS,ilm_layerCreateWithDimension(&newLayer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS,ilm_commitChanges());
+
+    ilm_layerSetDestinationRectangle(newLayer,33,567,55,99);
+    ilm_layerSetVisibility(newLayer,true);
+    ilm_commitChanges();
+
+    assertCallbackcalled();
+
+    EXPECT_EQ(newLayer,callbackLayerId);
+    EXPECT_EQ(33u,LayerProperties.destX);
+    EXPECT_EQ(567u,LayerProperties.destY);
+    EXPECT_EQ(55u,LayerProperties.destWidth);
+    EXPECT_EQ(99u,LayerProperties.destHeight);
+    EXPECT_EQ(ILM_NOTIFICATION_DEST_RECT,mask);
+
+    ASSERT_EQ(ILM_SUCCESS,ilm_layerRemoveNotificationAll());
+
+    ilm_layerSetDestinationRectangle(newLayer,133,1567,155,199);
+    ilm_commitChanges();
+    assertNoCallbackIsCalled();
+}
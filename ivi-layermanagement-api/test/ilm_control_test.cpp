@@ -20,9 +20,16 @@
  ****************************************************************************/
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <time.h>
 #include <sys/types.h>
 
 #include "TestBase.h"
@@ -428,6 +435,67 @@ TEST_F(IlmCommandTest, ilm_layerAddSurface_ilm_layerRemoveSurface_ilm_getSurface
     ASSERT_EQ(length, 0);
 }
 
+TEST_F(IlmCommandTest, ilm_getSurfaceIDsOnLayerBuffer) {
+    uint layer = 3246;
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    uint surface1 = iviSurfaces[0].surface_id;
+    uint surface2 = iviSurfaces[1].surface_id;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface2));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    // query the required capacity
+    t_ilm_int length = 0;
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSurfaceIDsOnLayerBuffer(layer, 0, &length, NULL));
+    ASSERT_EQ(2, length);
+
+    // too small buffer
+    t_ilm_surface IDs[2];
+    ASSERT_EQ(ILM_ERROR_INVALID_ARGUMENTS,
+              ilm_getSurfaceIDsOnLayerBuffer(layer, 1, &length, IDs));
+    ASSERT_EQ(2, length);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSurfaceIDsOnLayerBuffer(layer, 2, &length, IDs));
+    ASSERT_EQ(2, length);
+    EXPECT_EQ(surface1, IDs[0]);
+    EXPECT_EQ(surface2, IDs[1]);
+
+    // same result as the allocating variant
+    t_ilm_int allocLength;
+    t_ilm_surface* allocIDs;
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSurfaceIDs(&allocLength, &allocIDs));
+    t_ilm_surface* bufferIDs = new t_ilm_surface[allocLength];
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSurfaceIDsBuffer(allocLength, &length, bufferIDs));
+    ASSERT_EQ(allocLength, length);
+    for (t_ilm_int i = 0; i < length; i++)
+    {
+        EXPECT_EQ(allocIDs[i], bufferIDs[i]);
+    }
+    delete[] bufferIDs;
+    free(allocIDs);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerRemove(layer));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+}
+
+TEST_F(IlmCommandTest, ilm_getLayerIDsBuffer_AfterCommit) {
+    uint layer = 3247;
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    t_ilm_int length = 0;
+    t_ilm_layer IDs[64];
+    ASSERT_EQ(ILM_SUCCESS, ilm_getLayerIDsBuffer(64, &length, IDs));
+    EXPECT_NE(IDs + length, std::find(IDs, IDs + length, layer));
+
+    // the removal is seen right after the commit, not only after a dispatch
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerRemove(layer));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_getLayerIDsBuffer(64, &length, IDs));
+    EXPECT_EQ(IDs + length, std::find(IDs, IDs + length, layer));
+}
+
 TEST_F(IlmCommandTest, ilm_getSurfaceIDsOnLayer_InvalidInput) {
     uint layer = 0xdeadbeef;
 
@@ -894,3 +962,565 @@ TEST_F(IlmCommandTest, LayerSetRenderOrder_empty) {
 
     ASSERT_EQ(0, layerSurfaceCount);
 }
+
+TEST_F(IlmCommandTest, SceneGeneration) {
+    t_ilm_uint generation = 0;
+    t_ilm_uint nextGeneration = 0;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSceneGeneration(&generation));
+
+    // nothing changed, the generation stays the same
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSceneGeneration(&nextGeneration));
+    EXPECT_EQ(generation, nextGeneration);
+
+    t_ilm_layer layer = 0xFFFFFFFF;
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 300, 300));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSceneGeneration(&nextGeneration));
+    EXPECT_NE(generation, nextGeneration);
+
+    generation = nextGeneration;
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSceneGeneration(&nextGeneration));
+    EXPECT_NE(generation, nextGeneration);
+
+    ASSERT_EQ(ILM_FAILED, ilm_getSceneGeneration(NULL));
+}
+
+TEST_F(IlmCommandTest, RequestStats) {
+    t_ilm_uint requestCount = 0;
+    struct ilmRequestStats* requests = NULL;
+    t_ilm_uint clientCount = 0;
+    struct ilmClientStats* clients = NULL;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_getStats(&requestCount, &requests,
+                                        &clientCount, &clients));
+
+    bool foundCommit = false;
+    for (t_ilm_uint i = 0; i < requestCount; i++)
+    {
+        t_ilm_uint histogramCount = 0;
+        for (int b = 0; b < ILM_STATS_HISTOGRAM_BUCKETS; b++)
+            histogramCount += requests[i].histogram[b];
+
+        // every counted call is in exactly one bucket
+        EXPECT_EQ(requests[i].count, histogramCount);
+        EXPECT_LT(0u, requests[i].count);
+
+        if (std::string(requests[i].interfaceName) == "ivi_wm" &&
+            std::string(requests[i].requestName) == "commit_changes")
+        {
+            foundCommit = true;
+            EXPECT_LE(2u, requests[i].count);
+        }
+    }
+    EXPECT_TRUE(foundCommit);
+
+    bool foundSelf = false;
+    for (t_ilm_uint i = 0; i < clientCount; i++)
+    {
+        if (clients[i].pid == getpid())
+        {
+            foundSelf = true;
+            EXPECT_LE(2u, clients[i].requestCount);
+        }
+    }
+    EXPECT_TRUE(foundSelf);
+
+    free(requests);
+    free(clients);
+
+    ASSERT_EQ(ILM_FAILED, ilm_getStats(NULL, &requests, &clientCount, &clients));
+}
+
+TEST_F(IlmCommandTest, PoolStats) {
+    t_ilm_int surfaceCount = 0;
+    t_ilm_surface* surfaceIDs = NULL;
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSurfaceIDs(&surfaceCount, &surfaceIDs));
+    free(surfaceIDs);
+
+    t_ilm_uint poolCount = 0;
+    struct ilmPoolStats* pools = NULL;
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPoolStats(&poolCount, &pools));
+
+    bool foundSurfaces = false;
+    for (t_ilm_uint i = 0; i < poolCount; i++)
+    {
+        EXPECT_LE(pools[i].inUse, pools[i].peak);
+        EXPECT_EQ(pools[i].inUse, pools[i].allocs - pools[i].frees);
+
+        if (std::string(pools[i].name) == "struct surface_context")
+        {
+            foundSurfaces = true;
+            EXPECT_LE((t_ilm_uint)surfaceCount, pools[i].inUse);
+            EXPECT_LT(0u, pools[i].slabs);
+        }
+    }
+    EXPECT_TRUE(foundSurfaces);
+    free(pools);
+
+    ASSERT_EQ(ILM_FAILED, ilm_getPoolStats(NULL, &pools));
+}
+
+TEST_F(IlmCommandTest, DumpTrace) {
+    if (getenv("ILM_TRACE_FILE") == NULL)
+    {
+        ASSERT_EQ(ILM_ERROR_NOT_IMPLEMENTED, ilm_dumpTrace(NULL));
+        return;
+    }
+
+    std::string filename = std::string(getenv("ILM_TRACE_FILE")) + ".test";
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_dumpTrace(filename.c_str()));
+
+    FILE* file = fopen(filename.c_str(), "r");
+    ASSERT_TRUE(file != NULL);
+
+    std::string content;
+    char buf[4096];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof buf, file)) > 0)
+        content.append(buf, len);
+    fclose(file);
+    unlink(filename.c_str());
+
+    EXPECT_EQ(0u, content.find("{\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, content.find("\"name\":\"ilm_commitChanges\""));
+
+    // flow ids carry the process id in their upper 32 bits
+    char flow[32];
+    snprintf(flow, sizeof flow, "\"id\":\"0x%x", (unsigned)getpid());
+    EXPECT_NE(std::string::npos, content.find(flow));
+}
+
+TEST_F(IlmCommandTest, SurfaceLifecycle) {
+    t_ilm_layer layer = 0xbeef;
+    t_ilm_surface surface = iviSurfaces[0].surface_id;
+    t_ilm_uint count = 0;
+    struct ilmSurfaceLifecycle* lifecycles = NULL;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetVisibility(surface, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSurfaceLifecycles(&count, &lifecycles));
+
+    t_ilm_uint found = 0;
+    for (t_ilm_uint i = 0; i < count; i++)
+    {
+        if (lifecycles[i].pid != getpid())
+            continue;
+
+        found++;
+
+        // no buffer is ever attached to the test surfaces
+        EXPECT_EQ(ILM_LIFECYCLE_NOT_REACHED,
+                  lifecycles[i].stageTimeUs[ILM_LIFECYCLE_FIRST_COMMIT]);
+        EXPECT_EQ(ILM_LIFECYCLE_NOT_REACHED,
+                  lifecycles[i].stageTimeUs[ILM_LIFECYCLE_FIRST_FRAME]);
+
+        if (lifecycles[i].surfaceId == surface)
+        {
+            EXPECT_NE(ILM_LIFECYCLE_NOT_REACHED,
+                      lifecycles[i].stageTimeUs[ILM_LIFECYCLE_FIRST_LAYER_ADD]);
+            EXPECT_NE(ILM_LIFECYCLE_NOT_REACHED,
+                      lifecycles[i].stageTimeUs[ILM_LIFECYCLE_FIRST_VISIBLE]);
+        }
+    }
+    EXPECT_EQ(iviSurfaces.size(), found);
+
+    free(lifecycles);
+
+    ASSERT_EQ(ILM_FAILED, ilm_getSurfaceLifecycles(NULL, &lifecycles));
+}
+
+TEST_F(IlmCommandTest, ScreenStats) {
+    t_ilm_uint numberOfScreens = 0;
+    t_ilm_uint* screenIDs = NULL;
+    struct ilmScreenStats stats;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getScreenIDs(&numberOfScreens, &screenIDs));
+    ASSERT_LT(0u, numberOfScreens);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getScreenStats(screenIDs[0], &stats));
+
+    t_ilm_uint repaintCount = 0;
+    for (int b = 0; b < ILM_STATS_HISTOGRAM_BUCKETS; b++)
+        repaintCount += stats.repaintHistogram[b];
+    EXPECT_EQ(stats.frameCount, repaintCount);
+
+    // there is no interval before the first frame
+    t_ilm_uint intervalCount = 0;
+    for (int b = 0; b < ILM_SCREEN_INTERVAL_BUCKETS; b++)
+        intervalCount += stats.intervalHistogram[b];
+    EXPECT_GE(stats.frameCount, intervalCount);
+
+    EXPECT_GE((t_ilm_float)stats.maxViewCount, stats.meanViewCount);
+
+    free(screenIDs);
+
+    ASSERT_EQ(ILM_FAILED, ilm_getScreenStats(0xffffffff, &stats));
+    ASSERT_EQ(ILM_FAILED, ilm_getScreenStats(0, NULL));
+}
+
+static pthread_mutex_t notificationMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t notificationCondition = PTHREAD_COND_INITIALIZER;
+static t_ilm_uint notificationMask;
+
+static void
+surfaceNotificationCallback(t_ilm_surface, struct ilmSurfaceProperties*,
+              t_ilm_notification_mask mask)
+{
+    pthread_mutex_lock(&notificationMutex);
+    notificationMask |= mask;
+    pthread_cond_signal(&notificationCondition);
+    pthread_mutex_unlock(&notificationMutex);
+}
+
+static bool
+waitForNotificationMask(t_ilm_uint mask, int timeoutMs)
+{
+    struct timespec deadline;
+    int status = 0;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&notificationMutex);
+    while (!(notificationMask & mask) && status == 0)
+        status = pthread_cond_timedwait(&notificationCondition,
+                                        &notificationMutex, &deadline);
+    bool reached = (notificationMask & mask) != 0;
+    pthread_mutex_unlock(&notificationMutex);
+
+    return reached;
+}
+
+static FILE*
+openWestonConfig()
+{
+    // the file of the compositor under test, weston --config=<file>
+    const char* path = getenv("ILM_TEST_WESTON_CONFIG");
+    if (path != NULL)
+        return fopen(path, "r");
+
+    // otherwise the same lookup as weston: $XDG_CONFIG_HOME, $HOME/.config,
+    // $XDG_CONFIG_DIRS and the current working directory
+    std::vector<std::string> candidates;
+    const char* dir = getenv("XDG_CONFIG_HOME");
+    if (dir != NULL)
+        candidates.push_back(std::string(dir) + "/weston.ini");
+    else if ((dir = getenv("HOME")) != NULL)
+        candidates.push_back(std::string(dir) + "/.config/weston.ini");
+
+    std::string dirs = getenv("XDG_CONFIG_DIRS") ? getenv("XDG_CONFIG_DIRS")
+                                                 : "/etc/xdg";
+    size_t start = 0;
+    while (start <= dirs.size())
+    {
+        size_t end = dirs.find(':', start);
+        if (end == std::string::npos)
+            end = dirs.size();
+        if (end > start)
+            candidates.push_back(dirs.substr(start, end - start) +
+                                 "/weston/weston.ini");
+        start = end + 1;
+    }
+    candidates.push_back("weston.ini");
+
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        FILE* file = fopen(candidates[i].c_str(), "r");
+        if (file != NULL)
+            return file;
+    }
+
+    return NULL;
+}
+
+// reads an unsigned key of the [ivi-shell] section, 0 when it is not set
+static t_ilm_uint
+getIviShellConfig(const char* key)
+{
+    FILE* file = openWestonConfig();
+    if (file == NULL)
+        return 0;
+
+    char line[512];
+    bool inSection = false;
+    t_ilm_uint value = 0;
+    while (fgets(line, sizeof line, file) != NULL)
+    {
+        std::string entry(line);
+        entry.erase(0, entry.find_first_not_of(" \t"));
+        entry.erase(entry.find_last_not_of(" \t\r\n") + 1);
+
+        if (entry.empty() || entry[0] == '#')
+            continue;
+
+        if (entry[0] == '[')
+        {
+            inSection = (entry == "[ivi-shell]");
+            continue;
+        }
+
+        size_t equal = entry.find('=');
+        if (!inSection || equal == std::string::npos)
+            continue;
+
+        std::string name = entry.substr(0, equal);
+        name.erase(name.find_last_not_of(" \t") + 1);
+        if (name == key)
+            value = strtoul(entry.c_str() + equal + 1, NULL, 0);
+    }
+    fclose(file);
+
+    return value;
+}
+
+TEST_F(IlmCommandTest, SurfaceStallAndRecovery) {
+    t_ilm_uint timeoutMs = getIviShellConfig("stall-timeout-restricted");
+    if (timeoutMs == 0)
+    {
+        std::cout << "stall-timeout-restricted is not set in weston.ini, "
+                     "SurfaceStallAndRecovery skipped" << std::endl;
+        return;
+    }
+
+    t_ilm_uint numberOfScreens = 0;
+    t_ilm_uint* screenIDs = NULL;
+    t_ilm_int renderOrderLength = 0;
+    t_ilm_layer* renderOrder = NULL;
+    t_ilm_layer layer = 0xbe57;
+    t_ilm_surface surface = iviSurfaces[0].surface_id;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getScreenIDs(&numberOfScreens, &screenIDs));
+    ASSERT_LT(0u, numberOfScreens);
+    t_ilm_uint screen = screenIDs[0];
+    free(screenIDs);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getLayerIDsOnScreen(screen, &renderOrderLength,
+                                                   &renderOrder));
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetDestinationRectangle(surface, 0, 0, 1, 1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetVisibility(surface, ILM_TRUE));
+    // from here on the checks do not return, the render order is restored
+    EXPECT_EQ(ILM_SUCCESS, ilm_displaySetRenderOrder(screen, &layer, 1));
+    EXPECT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    notificationMask = 0;
+    EXPECT_EQ(ILM_SUCCESS, ilm_surfaceAddNotificationWithMask(surface,
+                  (t_ilm_notification_mask)(ILM_NOTIFICATION_STALLED |
+                                            ILM_NOTIFICATION_RECOVERED),
+                  surfaceNotificationCallback));
+
+    // ask for a frame callback and stop drawing
+    wl_callback* frame = wl_surface_frame(wlSurfaces[0]);
+    wl_surface_commit(wlSurfaces[0]);
+    wl_display_flush(wlDisplay);
+
+    EXPECT_TRUE(waitForNotificationMask(ILM_NOTIFICATION_STALLED, 2 * timeoutMs + 1000));
+    EXPECT_FALSE(notificationMask & ILM_NOTIFICATION_RECOVERED);
+
+    wl_surface_commit(wlSurfaces[0]);
+    wl_display_flush(wlDisplay);
+
+    EXPECT_TRUE(waitForNotificationMask(ILM_NOTIFICATION_RECOVERED, 1000));
+
+    wl_callback_destroy(frame);
+    EXPECT_EQ(ILM_SUCCESS, ilm_surfaceRemoveNotification(surface));
+
+    EXPECT_EQ(ILM_SUCCESS, ilm_displaySetRenderOrder(screen, renderOrder,
+                                                     renderOrderLength));
+    EXPECT_EQ(ILM_SUCCESS, ilm_layerRemove(layer));
+    EXPECT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    free(renderOrder);
+}
+
+struct FrameDone
+{
+    bool done;
+    uint32_t time;
+};
+
+static void
+frameDone(void* data, wl_callback*, uint32_t time)
+{
+    FrameDone* frame = static_cast<FrameDone*>(data);
+
+    frame->done = true;
+    frame->time = time;
+}
+
+static const struct wl_callback_listener frameListener = {
+    frameDone
+};
+
+static uint32_t
+getMonotonicMsec()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+// dispatches the default queue, ilmControl reads its own queue meanwhile
+static bool
+waitForFrameDone(wl_display* display, FrameDone* frame, int timeoutMs)
+{
+    uint32_t start = getMonotonicMsec();
+    int remaining = timeoutMs;
+
+    while (!frame->done && remaining > 0)
+    {
+        while (wl_display_prepare_read(display) != 0)
+            wl_display_dispatch_pending(display);
+        wl_display_flush(display);
+
+        struct pollfd pfd = { wl_display_get_fd(display), POLLIN, 0 };
+        if (poll(&pfd, 1, remaining) > 0)
+            wl_display_read_events(display);
+        else
+            wl_display_cancel_read(display);
+        wl_display_dispatch_pending(display);
+
+        remaining = timeoutMs - (int)(getMonotonicMsec() - start);
+    }
+
+    return frame->done;
+}
+
+TEST_F(IlmCommandTest, FrameCallbackOfOccludedSurface) {
+    t_ilm_uint intervalMs = getIviShellConfig("occluded-frame-interval");
+    if (intervalMs == 0)
+    {
+        std::cout << "occluded-frame-interval is not set in weston.ini, "
+                     "FrameCallbackOfOccludedSurface skipped" << std::endl;
+        return;
+    }
+
+    t_ilm_uint numberOfScreens = 0;
+    t_ilm_uint* screenIDs = NULL;
+    t_ilm_int renderOrderLength = 0;
+    t_ilm_layer* renderOrder = NULL;
+    t_ilm_layer layer = 0xbe58;
+    t_ilm_surface surface = iviSurfaces[1].surface_id;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getScreenIDs(&numberOfScreens, &screenIDs));
+    ASSERT_LT(0u, numberOfScreens);
+    t_ilm_uint screen = screenIDs[0];
+    free(screenIDs);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getLayerIDsOnScreen(screen, &renderOrderLength,
+                                                   &renderOrder));
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetDestinationRectangle(surface, 0, 0, 1, 1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetVisibility(surface, ILM_TRUE));
+    // from here on the checks do not return, the render order is restored
+    EXPECT_EQ(ILM_SUCCESS, ilm_displaySetRenderOrder(screen, &layer, 1));
+    EXPECT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    // a repaint which shows the surface, whatever it was before
+    FrameDone frame = { false, 0 };
+    wl_callback* callback = wl_surface_frame(wlSurfaces[1]);
+    wl_callback_add_listener(callback, &frameListener, &frame);
+    wl_surface_commit(wlSurfaces[1]);
+    EXPECT_TRUE(waitForFrameDone(wlDisplay, &frame, 1000));
+    wl_callback_destroy(callback);
+
+    notificationMask = 0;
+    EXPECT_EQ(ILM_SUCCESS, ilm_surfaceAddNotificationWithMask(surface,
+                  (t_ilm_notification_mask)(ILM_NOTIFICATION_OCCLUDED |
+                                            ILM_NOTIFICATION_REVEALED),
+                  surfaceNotificationCallback));
+
+    // composited, but not seen
+    EXPECT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface, 0.0f));
+    EXPECT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    EXPECT_TRUE(waitForNotificationMask(ILM_NOTIFICATION_OCCLUDED, 1000));
+
+    // the callbacks of the occluded surface are held from its commit until
+    // the interval expired
+    for (int i = 0; i < 2; i++)
+    {
+        frame.done = false;
+        callback = wl_surface_frame(wlSurfaces[1]);
+        wl_callback_add_listener(callback, &frameListener, &frame);
+        uint32_t committed = getMonotonicMsec();
+        wl_surface_commit(wlSurfaces[1]);
+
+        EXPECT_TRUE(waitForFrameDone(wlDisplay, &frame, 2 * intervalMs + 1000));
+        EXPECT_LE(intervalMs, getMonotonicMsec() - committed);
+        wl_callback_destroy(callback);
+    }
+
+    EXPECT_FALSE(notificationMask & ILM_NOTIFICATION_REVEALED);
+    EXPECT_EQ(ILM_SUCCESS, ilm_surfaceRemoveNotification(surface));
+
+    EXPECT_EQ(ILM_SUCCESS, ilm_displaySetRenderOrder(screen, renderOrder,
+                                                     renderOrderLength));
+    EXPECT_EQ(ILM_SUCCESS, ilm_layerRemove(layer));
+    EXPECT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    free(renderOrder);
+}
+
+TEST_F(IlmCommandTest, NoFrameCallbackWithoutView) {
+    t_ilm_uint intervalMs = getIviShellConfig("occluded-frame-interval");
+    if (intervalMs == 0)
+    {
+        std::cout << "occluded-frame-interval is not set in weston.ini, "
+                     "NoFrameCallbackWithoutView skipped" << std::endl;
+        return;
+    }
+
+    // the surface is on no layer, so weston never repaints it
+    FrameDone frame = { false, 0 };
+    wl_callback* callback = wl_surface_frame(wlSurfaces[2]);
+    wl_callback_add_listener(callback, &frameListener, &frame);
+    wl_surface_commit(wlSurfaces[2]);
+
+    EXPECT_FALSE(waitForFrameDone(wlDisplay, &frame, 2 * intervalMs + 500));
+    wl_callback_destroy(callback);
+}
+
+TEST_F(IlmCommandTest, ScreenCoverage) {
+    t_ilm_uint numberOfScreens = 0;
+    t_ilm_uint* screenIDs = NULL;
+    t_ilm_uint count = 0;
+    struct ilmSurfaceCoverage* coverage = NULL;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getScreenIDs(&numberOfScreens, &screenIDs));
+    ASSERT_LT(0u, numberOfScreens);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getScreenCoverage(screenIDs[0], &count, &coverage));
+    ASSERT_TRUE(coverage != NULL);
+
+    for (t_ilm_uint i = 0; i < count; i++)
+        EXPECT_GE(coverage[i].area, coverage[i].visibleArea);
+
+    free(coverage);
+    free(screenIDs);
+
+    ASSERT_EQ(ILM_FAILED, ilm_getScreenCoverage(0xffffffff, &count, &coverage));
+    ASSERT_EQ(ILM_FAILED, ilm_getScreenCoverage(0, NULL, &coverage));
+}
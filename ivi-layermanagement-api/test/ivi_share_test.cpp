@@ -0,0 +1,213 @@
+/***************************************************************************
+ *
+ * Copyright (C) 2026 The wayland-ivi-extension contributors
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <unistd.h>
+
+#include "TestBase.h"
+#include "ivi-share-client-protocol.h"
+
+struct ShareConsumer
+{
+    ivi_share_surface* surface;
+    uint32_t configures;
+    uint32_t frames;
+    uint32_t name;
+};
+
+static void
+share_damage(void*, ivi_share_surface*, uint32_t)
+{
+}
+
+static void
+share_configure(void* data, ivi_share_surface*, uint32_t, uint32_t,
+                uint32_t, uint32_t, uint32_t)
+{
+    static_cast<ShareConsumer*>(data)->configures++;
+}
+
+static void
+share_input_capabilities(void*, ivi_share_surface*, uint32_t)
+{
+}
+
+static void
+share_surface_state(void*, ivi_share_surface*, uint32_t)
+{
+}
+
+static void
+share_dmabuf_plane(void*, ivi_share_surface*, uint32_t, int32_t fd,
+                   uint32_t, uint32_t, uint32_t, uint32_t)
+{
+    close(fd);
+}
+
+static void
+share_dmabuf_damage(void*, ivi_share_surface*, uint32_t, uint32_t,
+                    uint32_t, uint32_t, uint32_t)
+{
+}
+
+static void
+share_frames_skipped(void*, ivi_share_surface*, uint32_t)
+{
+}
+
+static void
+share_shm_pool(void*, ivi_share_surface*, uint32_t, int32_t fd, uint32_t)
+{
+    close(fd);
+}
+
+static void
+share_shm_damage(void* data, ivi_share_surface*, uint32_t name, uint32_t,
+                 uint32_t, uint32_t, uint32_t, uint32_t)
+{
+    ShareConsumer* consumer = static_cast<ShareConsumer*>(data);
+
+    consumer->frames++;
+    consumer->name = name;
+}
+
+static void
+share_damage_region(void*, ivi_share_surface*, wl_array*)
+{
+}
+
+static const struct ivi_share_surface_listener share_surface_listener = {
+    share_damage,
+    share_configure,
+    share_input_capabilities,
+    share_surface_state,
+    share_dmabuf_plane,
+    share_dmabuf_damage,
+    share_frames_skipped,
+    share_shm_pool,
+    share_shm_damage,
+    share_damage_region
+};
+
+static void
+share_registry_global(void* data, wl_registry* registry, uint32_t id,
+                      const char* interface, uint32_t version)
+{
+    ivi_share** share = static_cast<ivi_share**>(data);
+
+    // shm share surfaces are available since version 5
+    if ((0 == strcmp(interface, "ivi_share")) && (version >= 5))
+    {
+        *share = static_cast<ivi_share*>(
+            wl_registry_bind(registry, id, &ivi_share_interface, 5));
+    }
+}
+
+static void
+share_registry_global_remove(void*, wl_registry*, uint32_t)
+{
+}
+
+class IviShareTest : public TestBase, public ::testing::Test {
+public:
+    void SetUp()
+    {
+        static const struct wl_registry_listener registry_listener = {
+            share_registry_global,
+            share_registry_global_remove
+        };
+
+        share = NULL;
+        registry = wl_display_get_registry(wlDisplay);
+        wl_registry_add_listener(registry, &registry_listener, &share);
+        ASSERT_NE(-1, wl_display_roundtrip(wlDisplay));
+
+        iviSurfaces.reserve(10);
+        struct iviSurface surf;
+        for (int i = 0; i < (int)iviSurfaces.capacity(); ++i)
+        {
+            surf.surface = ivi_application_surface_create(iviApp, i+600, wlSurfaces[i]);
+            surf.surface_id = i+600;
+            iviSurfaces.push_back(surf);
+        }
+
+        ASSERT_NE(-1, wl_display_roundtrip(wlDisplay));
+    }
+
+    void TearDown()
+    {
+        for (std::vector<iviSurface>::reverse_iterator it = iviSurfaces.rbegin();
+             it != iviSurfaces.rend();
+             ++it)
+        {
+            ivi_surface_destroy((*it).surface);
+        }
+        iviSurfaces.clear();
+
+        if (share)
+            ivi_share_destroy(share);
+        wl_registry_destroy(registry);
+        wl_display_roundtrip(wlDisplay);
+    }
+
+protected:
+    void Bind(ShareConsumer* consumer, uint32_t surface_id)
+    {
+        memset(consumer, 0, sizeof *consumer);
+        consumer->surface = ivi_share_get_ivi_share_surface_with_type(
+            share, surface_id, IVI_SHARE_SURFACE_TYPE_SHM);
+        ivi_share_surface_add_listener(consumer->surface,
+                                       &share_surface_listener, consumer);
+    }
+
+    wl_registry* registry;
+    ivi_share* share;
+};
+
+TEST_F(IviShareTest, SecondConsumerOfIdleSurface) {
+    if (share == NULL)
+    {
+        std::cout << "ivi_share with shm support is not available" << std::endl;
+        return;
+    }
+
+    uint surface = iviSurfaces[0].surface_id;
+
+    ShareConsumer first;
+    Bind(&first, surface);
+    ASSERT_NE(-1, wl_display_roundtrip(wlDisplay));
+    ASSERT_EQ(1u, first.configures);
+    ASSERT_EQ(1u, first.frames);
+
+    // the producer does not commit again, the second consumer must still
+    // get the buffer which is shared with the first one
+    ShareConsumer second;
+    Bind(&second, surface);
+    ASSERT_NE(-1, wl_display_roundtrip(wlDisplay));
+    EXPECT_EQ(1u, second.configures);
+    EXPECT_EQ(1u, second.frames);
+    EXPECT_EQ(first.name, second.name);
+
+    // and the first consumer is not sent the same buffer again
+    EXPECT_EQ(1u, first.frames);
+
+    ivi_share_surface_destroy(second.surface);
+    ivi_share_surface_destroy(first.surface);
+}
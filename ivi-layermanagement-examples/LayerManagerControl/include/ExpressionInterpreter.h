@@ -20,6 +20,7 @@
 #define __EXPRESSIONINTERPRETER_H__
 
 #include "Expression.h"
+#include <istream>
 #include <string>
 using namespace std;
 
@@ -36,6 +37,7 @@ class ExpressionInterpreter
 public:
     ExpressionInterpreter();
     CommandResult interpretCommand(string userInput);
+    CommandResult interpretScript(istream& script, bool interactive);
     string getLastError();
     static void printExpressionTree();
     static void printExpressionList();
@@ -43,6 +45,8 @@ public:
     static bool addExpression(callback funcPtr, string command);
 
 private:
+    CommandResult parseCommand(string userInput, Expression** ppExecutable);
+
     static Expression* mpRoot;
     string mErrorText;
 };
@@ -211,14 +211,58 @@ void printSurfaceProperties(unsigned int surfaceid, const char* prefix = "");
  */
 void printScene();
 
+/*
+ * Prints the request statistics of the compositor
+ */
+void printStats();
+
+/*
+ * Prints the repaint statistics of a screen
+ */
+void printScreenStats(unsigned int screenid);
+
+/*
+ * Prints the visible area of the surfaces composited on a screen
+ */
+void printScreenCoverage(unsigned int screenid);
+
+/*
+ * Prints the startup stages of all surfaces
+ */
+void printStartupReport();
+
 
 //=============================================================================
 //control.cpp
 //=============================================================================
 void testNotificationLayer(t_ilm_layer layerid);
+
+/*
+ * Commits the changes of a command, or only records them while commits are deferred
+ */
+void commitChanges();
+
+/*
+ * Defers the commits of all following commands, used when running a script
+ */
+void deferCommits(bool defer);
+
+/*
+ * Commits the changes recorded since the last commit, if there are any
+ */
+void commitPendingChanges();
+
 void watchLayer(unsigned int* layerids, unsigned int layeridCount);
 void watchSurface(unsigned int* surfaceids, unsigned int surfaceidCount);
 
+/*
+ * Records the notifications of the given layers or surfaces, or of all of
+ * them if ids is NULL, to a csv or binary file for durationSec seconds, or
+ * if it is 0 until a number is entered, or in a script until SIGINT or SIGTERM
+ */
+void watchToFile(bool layers, bool surfaces, unsigned int* ids, unsigned int idCount,
+                 string format, string filename, unsigned int durationSec);
+
 
 //=============================================================================
 //analyze.cpp
@@ -244,6 +288,12 @@ t_scene_data getScatteredScene(t_scene_data* pInitialScene);
  */
 void exportSceneToFile(string filename);
 
+/*
+ * Applies a scene saved to a .ilmscene file, calling only the setters of
+ * the properties which differ from the current scene
+ */
+void applySceneFromFile(string filename);
+
 /*
  * Saves an xtext representation of the grammar of the scene
  */
@@ -19,6 +19,7 @@
 #include "ExpressionInterpreter.h"
 #include "Expression.h"
 #include "ilm_control.h"
+#include "LMControl.h"
 #include <string>
 #include <sstream>
 #include <algorithm> // transform
@@ -69,7 +70,7 @@ bool ExpressionInterpreter::addExpression(callback funcPtr, string command)
     return result;
 }
 
-CommandResult ExpressionInterpreter::interpretCommand(string userInput)
+CommandResult ExpressionInterpreter::parseCommand(string userInput, Expression** ppExecutable)
 {
     CommandResult result = CommandSuccess;
     string text;
@@ -148,7 +149,7 @@ CommandResult ExpressionInterpreter::interpretCommand(string userInput)
         result = CommandInvalid;
     }
 
-    //run command if executable and non-ambiguous
+    //find the command if executable and non-ambiguous
     if (result == CommandSuccess)
     {
         Expression* expr = *(currentState.begin());
@@ -156,19 +157,7 @@ CommandResult ExpressionInterpreter::interpretCommand(string userInput)
         ExpressionList executables = expr->getClosureExecutables(false);
         if (executables.size() == 1)
         {
-            ilmErrorTypes initResult = ilm_init();
-            if (ILM_SUCCESS != initResult)
-            {
-                mErrorText = ILM_ERROR_STRING(initResult);
-                result = CommandExecutionFailed;
-            }
-            else
-            {
-                Expression* exec = executables.front();
-                exec->execute();
-                ilm_commitChanges();
-                ilm_destroy();
-            }
+            *ppExecutable = executables.front();
         }
         else if (executables.size() == 0)
         {
@@ -185,6 +174,96 @@ CommandResult ExpressionInterpreter::interpretCommand(string userInput)
     return result;
 }
 
+CommandResult ExpressionInterpreter::interpretCommand(string userInput)
+{
+    Expression* exec = NULL;
+    CommandResult result = parseCommand(userInput, &exec);
+
+    //run command if executable and non-ambiguous
+    if (result == CommandSuccess)
+    {
+        ilmErrorTypes initResult = ilm_init();
+        if (ILM_SUCCESS != initResult)
+        {
+            mErrorText = ILM_ERROR_STRING(initResult);
+            result = CommandExecutionFailed;
+        }
+        else
+        {
+            exec->execute();
+            ilm_commitChanges();
+            ilm_destroy();
+        }
+    }
+
+    return result;
+}
+
+CommandResult ExpressionInterpreter::interpretScript(istream& script, bool interactive)
+{
+    CommandResult result = CommandSuccess;
+    unsigned int lineNumber = 0;
+    string line;
+
+    ilmErrorTypes initResult = ilm_init();
+    if (ILM_SUCCESS != initResult)
+    {
+        mErrorText = ILM_ERROR_STRING(initResult);
+        return CommandExecutionFailed;
+    }
+
+    //all commands share the connection, changes wait for "commit" or the end
+    deferCommits(true);
+
+    while (true)
+    {
+        if (interactive)
+        {
+            cout << "LayerManagerControl> " << flush;
+        }
+
+        if (!getline(script, line))
+        {
+            break;
+        }
+
+        ++lineNumber;
+
+        //skip empty lines and comments
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#')
+        {
+            continue;
+        }
+
+        size_t last = line.find_last_not_of(" \t\r");
+        line = line.substr(first, last - first + 1);
+
+        if (line == "quit" || line == "exit")
+        {
+            break;
+        }
+
+        Expression* exec = NULL;
+        CommandResult lineResult = parseCommand(line, &exec);
+        if (lineResult == CommandSuccess)
+        {
+            exec->execute();
+        }
+        else
+        {
+            cerr << "line " << lineNumber << ": " << getLastError() << endl;
+            result = lineResult;
+        }
+    }
+
+    commitPendingChanges();
+    deferCommits(false);
+    ilm_destroy();
+
+    return result;
+}
+
 void ExpressionInterpreter::printExpressionTree()
 {
     mpRoot->printTree();
@@ -17,12 +17,14 @@
  *
  ****************************************************************************/
 
+#include "ilm_control.h"
 #include "LMControl.h"
 
 #include <algorithm>
 using std::find;
 
 #include <cstdio>
+#include <cstdlib>
 
 #include <iterator>
 using std::iterator;
@@ -542,6 +544,52 @@ t_ilm_bool analyzeCheckRendered(t_ilm_surface targetSurfaceId, t_scene_data& sce
     return onLayer && layerOnScreen;
 }
 
+void analyzeCoverage(t_ilm_surface targetSurfaceId, t_scene_data& scene)
+{
+    t_ilm_display screenId = scene.layerScreen[scene.surfaceLayer[targetSurfaceId]];
+    t_ilm_uint count = 0;
+    struct ilmSurfaceCoverage* coverage = NULL;
+    string tag;
+    string flag;
+    char description[300] = "";
+
+    //older compositors do not compute the visible area
+    if (ilm_getScreenCoverage(screenId, &count, &coverage) != ILM_SUCCESS)
+        return;
+
+    tag = "Visible Area";
+    flag = "PROBLEM";
+    sprintf(description, "Surface %i is not composited on screen %i", targetSurfaceId, screenId);
+
+    for (t_ilm_uint i = 0; i < count; ++i)
+    {
+        if (coverage[i].surfaceId != targetSurfaceId)
+            continue;
+
+        if (coverage[i].visibleArea == 0)
+        {
+            flag = "PROBLEM";
+            sprintf(description, "Surface %i is not seen on screen %i", targetSurfaceId, screenId);
+        }
+        else if (coverage[i].visibleArea < coverage[i].area)
+        {
+            flag = "WARNING";
+            sprintf(description, "Surface %i is seen in %u of %u pixels (%.1f%%)", targetSurfaceId,
+                    coverage[i].visibleArea, coverage[i].area,
+                    100.0 * coverage[i].visibleArea / coverage[i].area);
+        }
+        else
+        {
+            flag = "OK";
+            sprintf(description, "%s", "");
+        }
+        break;
+    }
+
+    free(coverage);
+    analyzePrintHelper(tag, flag, description);
+}
+
 t_ilm_bool analyzeFrameCounter(t_ilm_surface targetSurfaceId, t_scene_data& scene)
 {
     ilmSurfaceProperties& targetSurfaceProperties = scene.surfaceProperties[targetSurfaceId];
@@ -595,6 +643,9 @@ t_ilm_bool analyzeSurface(t_ilm_surface targetSurfaceId)
     //get occluding visible surfaces
     analyzeOcclusion(targetSurfaceId, scene);
 
+    //check the area in which the compositor shows the surface
+    analyzeCoverage(targetSurfaceId, scene);
+
     //check if the surface has been updated (if it has any content)
     analyzeFrameCounter(targetSurfaceId, scene);
 
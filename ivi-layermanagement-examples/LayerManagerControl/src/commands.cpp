@@ -54,6 +54,16 @@ COMMAND("help")
     cout << "help: supported commands:\n\n";
     ExpressionInterpreter::printExpressionList();
     cout << "\n";
+    cout << "LayerManagerControl -f <file> runs one command per line, '-' reads them from stdin.\n"
+         << "All commands share one connection, changes are committed by 'commit' and at the end.\n\n";
+}
+
+//=============================================================================
+COMMAND("commit")
+//=============================================================================
+{
+    (void)input;
+    commitPendingChanges();
 }
 
 //=============================================================================
@@ -127,6 +137,36 @@ COMMAND("get scene|screens|layers|surfaces")
     }
 }
 
+//=============================================================================
+COMMAND("get stats")
+//=============================================================================
+{
+    (void)input;
+    printStats();
+}
+
+//=============================================================================
+COMMAND("get screen <screenid> stats")
+//=============================================================================
+{
+    printScreenStats(input->getUint("screenid"));
+}
+
+//=============================================================================
+COMMAND("get screen <screenid> coverage")
+//=============================================================================
+{
+    printScreenCoverage(input->getUint("screenid"));
+}
+
+//=============================================================================
+COMMAND("get startup report")
+//=============================================================================
+{
+    (void)input;
+    printStartupReport();
+}
+
 //=============================================================================
 COMMAND("get screen|layer|surface <id>")
 //=============================================================================
@@ -193,7 +233,7 @@ COMMAND("set layer|surface <id> source region <x> <y> <w> <h>")
             return;
         }
 
-        ilm_commitChanges();
+        commitChanges();
     }
     else if (input->contains("surface"))
     {
@@ -205,7 +245,7 @@ COMMAND("set layer|surface <id> source region <x> <y> <w> <h>")
             return;
         }
 
-        ilm_commitChanges();
+        commitChanges();
     }
 }
 
@@ -229,7 +269,7 @@ COMMAND("set layer|surface <id> destination region <x> <y> <w> <h>")
             return;
         }
 
-        ilm_commitChanges();
+        commitChanges();
     }
     else if (input->contains("surface"))
     {
@@ -241,7 +281,7 @@ COMMAND("set layer|surface <id> destination region <x> <y> <w> <h>")
             return;
         }
 
-        ilm_commitChanges();
+        commitChanges();
     }
 }
 
@@ -262,7 +302,7 @@ COMMAND("set layer|surface <id> opacity <opacity>")
             return;
         }
 
-        ilm_commitChanges();
+        commitChanges();
     }
     else if (input->contains("surface"))
     {
@@ -274,7 +314,7 @@ COMMAND("set layer|surface <id> opacity <opacity>")
             return;
         }
 
-        ilm_commitChanges();
+        commitChanges();
     }
 }
 
@@ -295,7 +335,7 @@ COMMAND("set layer|surface <id> visibility <visibility>")
             return;
         }
 
-        ilm_commitChanges();
+        commitChanges();
     }
     else if (input->contains("surface"))
     {
@@ -307,7 +347,7 @@ COMMAND("set layer|surface <id> visibility <visibility>")
             return;
         }
 
-        ilm_commitChanges();
+        commitChanges();
     }
 }
 
@@ -327,7 +367,7 @@ COMMAND("set surface <surfaceid> type <type>")
         return;
     }
 
-    ilm_commitChanges();
+    commitChanges();
 }
 
 //=============================================================================
@@ -351,7 +391,7 @@ COMMAND("set screen|layer <id> render order [<idarray>]")
                 return;
             }
 
-            ilm_commitChanges();
+            commitChanges();
             delete[] array;
         }
         else
@@ -366,7 +406,7 @@ COMMAND("set screen|layer <id> render order [<idarray>]")
                 return;
             }
 
-            ilm_commitChanges();
+            commitChanges();
         }
     }
     else if (input->contains("layer"))
@@ -386,7 +426,7 @@ COMMAND("set screen|layer <id> render order [<idarray>]")
                 return;
             }
 
-            ilm_commitChanges();
+            commitChanges();
             delete[] array;
         }
         else
@@ -401,7 +441,7 @@ COMMAND("set screen|layer <id> render order [<idarray>]")
                 return;
             }
 
-            ilm_commitChanges();
+            commitChanges();
         }
     }
 }
@@ -437,7 +477,7 @@ COMMAND("destroy layer <id>")
         return;
     }
 
-    ilm_commitChanges();
+    commitChanges();
 }
 
 //=============================================================================
@@ -455,7 +495,7 @@ COMMAND("add surface <sid> to layer <lid>")
         return;
     }
 
-    ilm_commitChanges();
+    commitChanges();
 }
 
 //=============================================================================
@@ -473,7 +513,7 @@ COMMAND("remove surface <sid> from layer <lid>")
         return;
     }
 
-    ilm_commitChanges();
+    commitChanges();
 }
 
 //=============================================================================
@@ -509,6 +549,48 @@ COMMAND("watch layer|surface <idarray>")
     }
 }
 
+//=============================================================================
+COMMAND("watch layer|surface <idarray> --format <format> --output <filename>")
+//=============================================================================
+{
+    unsigned int* ids = NULL;
+    unsigned int idCount = 0;
+    input->getUintArray("idarray", &ids, &idCount);
+
+    watchToFile(input->contains("layer"), input->contains("surface"), ids, idCount,
+                input->getString("format"), input->getString("filename"), 0);
+    delete[] ids;
+}
+
+//=============================================================================
+COMMAND("watch layer|surface <idarray> --format <format> --output <filename> --duration <seconds>")
+//=============================================================================
+{
+    unsigned int* ids = NULL;
+    unsigned int idCount = 0;
+    input->getUintArray("idarray", &ids, &idCount);
+
+    watchToFile(input->contains("layer"), input->contains("surface"), ids, idCount,
+                input->getString("format"), input->getString("filename"),
+                input->getUint("seconds"));
+    delete[] ids;
+}
+
+//=============================================================================
+COMMAND("watch --all --format <format> --output <filename>")
+//=============================================================================
+{
+    watchToFile(true, true, NULL, 0, input->getString("format"), input->getString("filename"), 0);
+}
+
+//=============================================================================
+COMMAND("watch --all --format <format> --output <filename> --duration <seconds>")
+//=============================================================================
+{
+    watchToFile(true, true, NULL, 0, input->getString("format"), input->getString("filename"),
+                input->getUint("seconds"));
+}
+
 //=============================================================================
 COMMAND("analyze surface <surfaceid>")
 //=============================================================================
@@ -525,6 +607,14 @@ COMMAND("export scene to <filename>")
     exportSceneToFile(filename);
 }
 
+//=============================================================================
+COMMAND("apply scene from <filename>")
+//=============================================================================
+{
+    string filename = (string) input->getString("filename");
+    applySceneFromFile(filename);
+}
+
 //=============================================================================
 COMMAND("export xtext to <filename> <grammar> <url>")
 //=============================================================================
@@ -20,7 +20,9 @@
 #include "ilm_control.h"
 #include "LMControl.h"
 
+#include <cstdio>
 #include <cstring>
+#include <ctime>
 
 #include <iostream>
 using std::cout;
@@ -36,9 +38,81 @@ using std::hex;
 
 #include <pthread.h>
 #include <signal.h>
+#include <stdint.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+namespace
+{
+bool gCommitsDeferred = false;
+bool gChangesPending = false;
+volatile sig_atomic_t gWatchInterrupted = 0;
+
+void interruptWatch(int)
+{
+    gWatchInterrupted = 1;
+}
+
+/*
+ * Blocks until a number is entered, or in a script, whose lines must not be
+ * consumed, until SIGINT or SIGTERM. A duration in seconds ends the wait
+ * earlier in both cases.
+ */
+void waitForWatchEnd(unsigned int durationSec)
+{
+    if (!gCommitsDeferred && durationSec == 0)
+    {
+        int block;
+        cin >> block;
+        return;
+    }
+
+    struct sigaction action;
+    struct sigaction oldInt;
+    struct sigaction oldTerm;
+    memset(&action, 0, sizeof action);
+    action.sa_handler = interruptWatch;
+    sigemptyset(&action.sa_mask);
+    gWatchInterrupted = 0;
+    sigaction(SIGINT, &action, &oldInt);
+    sigaction(SIGTERM, &action, &oldTerm);
+
+    time_t end = time(NULL) + durationSec;
+    while (!gWatchInterrupted && (durationSec == 0 || time(NULL) < end))
+    {
+        usleep(100 * 1000);
+    }
+
+    sigaction(SIGINT, &oldInt, NULL);
+    sigaction(SIGTERM, &oldTerm, NULL);
+}
+}
+
+void commitChanges()
+{
+    if (gCommitsDeferred)
+    {
+        gChangesPending = true;
+        return;
+    }
+
+    ilm_commitChanges();
+}
+
+void deferCommits(bool defer)
+{
+    gCommitsDeferred = defer;
+}
+
+void commitPendingChanges()
+{
+    if (!gChangesPending)
+        return;
+
+    gChangesPending = false;
+    ilm_commitChanges();
+}
+
 void layerNotificationCallback(t_ilm_layer layer, struct ilmLayerProperties* properties, t_ilm_notification_mask mask)
 {
     cout << "\nNotification: layer " << layer << " updated properties:\n";
@@ -125,8 +199,7 @@ void watchLayer(unsigned int* layerids, unsigned int layeridCount)
     }
 
     cout << "Waiting for notifications...\n";
-    int block;
-    cin >> block;
+    waitForWatchEnd(0);
 
     for (unsigned int i = 0; i < layeridCount; ++i)
     {
@@ -179,6 +252,26 @@ void surfaceNotificationCallback(t_ilm_layer surface, struct ilmSurfacePropertie
                 << ", height:" << properties->destHeight
                 << "\n";
     }
+
+    if (ILM_NOTIFICATION_STALLED & mask)
+    {
+        cout << "\tstalled: no commit after the last frame callback\n";
+    }
+
+    if (ILM_NOTIFICATION_RECOVERED & mask)
+    {
+        cout << "\trecovered: committed again after a stall\n";
+    }
+
+    if (ILM_NOTIFICATION_OCCLUDED & mask)
+    {
+        cout << "\toccluded: not seen on any screen\n";
+    }
+
+    if (ILM_NOTIFICATION_REVEALED & mask)
+    {
+        cout << "\trevealed: seen on a screen again\n";
+    }
 }
 
 void watchSurface(unsigned int* surfaceids, unsigned int surfaceidCount)
@@ -198,8 +291,7 @@ void watchSurface(unsigned int* surfaceids, unsigned int surfaceidCount)
     }
 
     cout << "Waiting for notifications...\n";
-    int block;
-    cin >> block;
+    waitForWatchEnd(0);
 
     for (unsigned int i = 0; i < surfaceidCount; ++i)
     {
@@ -220,3 +312,303 @@ void watchSurface(unsigned int* surfaceids, unsigned int surfaceidCount)
         delete[] surfaceids;
     }
 }
+
+namespace
+{
+/*
+ * One property change, written as is by the binary format. The records are
+ * produced by the notification callbacks on the ilmControl thread and
+ * consumed by the writer thread through a single producer, single consumer
+ * ring, so the callbacks never block on the file.
+ */
+struct WatchRecord
+{
+    uint64_t timestampUs;       // CLOCK_MONOTONIC
+    uint32_t objectType;        // ilmObjectType
+    uint32_t id;
+    uint32_t mask;              // t_ilm_notification_mask
+    float opacity;
+    uint32_t sourceX;
+    uint32_t sourceY;
+    uint32_t sourceWidth;
+    uint32_t sourceHeight;
+    uint32_t destX;
+    uint32_t destY;
+    uint32_t destWidth;
+    uint32_t destHeight;
+    uint32_t visibility;
+    uint32_t reserved;          // always 0, no padding reaches the file
+};
+
+const char watchMagic[8] = { 'I', 'L', 'M', 'W', 'A', 'T', 'C', 'H' };
+const uint32_t watchVersion = 1;
+
+// power of two, about 4MB of records
+const uint32_t WATCH_QUEUE_SIZE = 65536;
+
+struct WatchQueue
+{
+    WatchRecord records[WATCH_QUEUE_SIZE];
+    uint32_t head;              // written by the producer only
+    uint32_t tail;              // written by the consumer only
+    uint32_t dropped;           // records lost because the queue was full
+    int stop;
+};
+
+WatchQueue* gWatchQueue = NULL;
+
+uint64_t getMonotonicUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void pushWatchRecord(const WatchRecord& record)
+{
+    WatchQueue* queue = gWatchQueue;
+    uint32_t head = queue->head;
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail == WATCH_QUEUE_SIZE)
+    {
+        queue->dropped++;
+        return;
+    }
+
+    queue->records[head & (WATCH_QUEUE_SIZE - 1)] = record;
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void recordLayerNotification(t_ilm_layer layer, struct ilmLayerProperties* properties, t_ilm_notification_mask mask)
+{
+    WatchRecord record;
+
+    memset(&record, 0, sizeof record);
+    record.timestampUs = getMonotonicUs();
+    record.objectType = ILM_LAYER;
+    record.id = layer;
+    record.mask = mask;
+    record.opacity = (float) properties->opacity;
+    record.sourceX = properties->sourceX;
+    record.sourceY = properties->sourceY;
+    record.sourceWidth = properties->sourceWidth;
+    record.sourceHeight = properties->sourceHeight;
+    record.destX = properties->destX;
+    record.destY = properties->destY;
+    record.destWidth = properties->destWidth;
+    record.destHeight = properties->destHeight;
+    record.visibility = properties->visibility;
+
+    pushWatchRecord(record);
+}
+
+void recordSurfaceNotification(t_ilm_surface surface, struct ilmSurfaceProperties* properties, t_ilm_notification_mask mask)
+{
+    WatchRecord record;
+
+    memset(&record, 0, sizeof record);
+    record.timestampUs = getMonotonicUs();
+    record.objectType = ILM_SURFACE;
+    record.id = surface;
+    record.mask = mask;
+    record.opacity = (float) properties->opacity;
+    record.sourceX = properties->sourceX;
+    record.sourceY = properties->sourceY;
+    record.sourceWidth = properties->sourceWidth;
+    record.sourceHeight = properties->sourceHeight;
+    record.destX = properties->destX;
+    record.destY = properties->destY;
+    record.destWidth = properties->destWidth;
+    record.destHeight = properties->destHeight;
+    record.visibility = properties->visibility;
+
+    pushWatchRecord(record);
+}
+
+struct WatchWriter
+{
+    FILE* file;
+    bool csv;
+    uint64_t written;
+};
+
+void writeWatchRecord(WatchWriter* writer, const WatchRecord& record)
+{
+    if (!writer->csv)
+    {
+        fwrite(&record, sizeof record, 1, writer->file);
+        return;
+    }
+
+    fprintf(writer->file, "%llu,%s,%u,0x%x,%g,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+            (unsigned long long) record.timestampUs,
+            record.objectType == ILM_LAYER ? "layer" : "surface",
+            record.id, record.mask, record.opacity,
+            record.sourceX, record.sourceY, record.sourceWidth, record.sourceHeight,
+            record.destX, record.destY, record.destWidth, record.destHeight,
+            record.visibility);
+}
+
+void* watchWriterThread(void* data)
+{
+    WatchWriter* writer = (WatchWriter*) data;
+    WatchQueue* queue = gWatchQueue;
+
+    while (true)
+    {
+        //read stop before head, so the records pushed before stopping are drained
+        int stop = __atomic_load_n(&queue->stop, __ATOMIC_ACQUIRE);
+        uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+        uint32_t tail = queue->tail;
+
+        if (tail == head)
+        {
+            if (stop)
+                break;
+
+            //polling keeps the producer free of any wakeup
+            usleep(10 * 1000);
+            continue;
+        }
+
+        for (; tail != head; ++tail)
+        {
+            writeWatchRecord(writer, queue->records[tail & (WATCH_QUEUE_SIZE - 1)]);
+            writer->written++;
+        }
+
+        __atomic_store_n(&queue->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+ilmErrorTypes addWatchNotifications(bool layers, bool surfaces, unsigned int* ids, unsigned int idCount)
+{
+    ilmErrorTypes callResult = ILM_SUCCESS;
+
+    if (ids == NULL)
+    {
+        callResult = ilm_layerAddNotificationAll(ILM_NOTIFICATION_ALL, recordLayerNotification);
+        if (ILM_SUCCESS == callResult)
+            callResult = ilm_surfaceAddNotificationAll(ILM_NOTIFICATION_ALL, recordSurfaceNotification);
+        return callResult;
+    }
+
+    for (unsigned int i = 0; i < idCount && ILM_SUCCESS == callResult; ++i)
+    {
+        if (layers)
+            callResult = ilm_layerAddNotification(ids[i], recordLayerNotification);
+        else if (surfaces)
+            callResult = ilm_surfaceAddNotification(ids[i], recordSurfaceNotification);
+    }
+
+    return callResult;
+}
+
+void removeWatchNotifications(bool layers, bool surfaces, unsigned int* ids, unsigned int idCount)
+{
+    if (ids == NULL)
+    {
+        ilm_layerRemoveNotificationAll();
+        ilm_surfaceRemoveNotificationAll();
+        return;
+    }
+
+    for (unsigned int i = 0; i < idCount; ++i)
+    {
+        if (layers)
+            ilm_layerRemoveNotification(ids[i]);
+        else if (surfaces)
+            ilm_surfaceRemoveNotification(ids[i]);
+    }
+}
+} //end of anonymous namespace
+
+void watchToFile(bool layers, bool surfaces, unsigned int* ids, unsigned int idCount,
+                 string format, string filename, unsigned int durationSec)
+{
+    WatchWriter writer;
+
+    if (format != "csv" && format != "binary")
+    {
+        cout << "Unknown format " << format << ", use csv or binary\n";
+        return;
+    }
+
+    writer.csv = format == "csv";
+    writer.written = 0;
+    writer.file = fopen(filename.c_str(), writer.csv ? "w" : "wb");
+    if (writer.file == NULL)
+    {
+        cout << "Failed to open " << filename << "\n";
+        return;
+    }
+
+    //large buffer, the writer thread only touches the disk every few hundred KB
+    setvbuf(writer.file, NULL, _IOFBF, 1024 * 1024);
+
+    if (writer.csv)
+    {
+        fprintf(writer.file, "timestamp_us,object,id,mask,opacity,"
+                "source_x,source_y,source_width,source_height,"
+                "dest_x,dest_y,dest_width,dest_height,visibility\n");
+    }
+    else
+    {
+        uint32_t header[2] = { watchVersion, (uint32_t) sizeof(WatchRecord) };
+        fwrite(watchMagic, sizeof watchMagic, 1, writer.file);
+        fwrite(header, sizeof header, 1, writer.file);
+    }
+
+    gWatchQueue = new WatchQueue;
+    gWatchQueue->head = 0;
+    gWatchQueue->tail = 0;
+    gWatchQueue->dropped = 0;
+    gWatchQueue->stop = 0;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, watchWriterThread, &writer) != 0)
+    {
+        cout << "Failed to start the writer thread\n";
+        fclose(writer.file);
+        delete gWatchQueue;
+        gWatchQueue = NULL;
+        return;
+    }
+
+    ilmErrorTypes callResult = addWatchNotifications(layers, surfaces, ids, idCount);
+    if (ILM_SUCCESS != callResult)
+    {
+        cout << "LayerManagerService returned: " << ILM_ERROR_STRING(callResult) << "\n";
+        cout << "Failed to add notification callbacks\n";
+    }
+    else
+    {
+        cout << "Recording notifications to " << filename;
+        if (durationSec)
+            cout << " for " << durationSec << " seconds...\n";
+        else if (gCommitsDeferred)
+            cout << " until SIGINT or SIGTERM...\n";
+        else
+            cout << ", enter a number to stop...\n";
+        waitForWatchEnd(durationSec);
+    }
+
+    removeWatchNotifications(layers, surfaces, ids, idCount);
+
+    __atomic_store_n(&gWatchQueue->stop, 1, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+    fclose(writer.file);
+
+    cout << "Recorded " << writer.written << " notifications";
+    if (gWatchQueue->dropped)
+    {
+        cout << ", dropped " << gWatchQueue->dropped << " because the writer fell behind";
+    }
+    cout << "\n";
+
+    delete gWatchQueue;
+    gWatchQueue = NULL;
+}
@@ -18,12 +18,49 @@
  ****************************************************************************/
 #include "ExpressionInterpreter.h"
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <unistd.h> // isatty
 using namespace std;
 
+static int runScript(ExpressionInterpreter& interpreter, const char* filename)
+{
+    CommandResult result;
+
+    // "-" reads the commands from stdin, prompting when it is a terminal
+    if (strcmp(filename, "-") == 0)
+    {
+        result = interpreter.interpretScript(cin, isatty(STDIN_FILENO));
+    }
+    else
+    {
+        ifstream script(filename);
+        if (!script)
+        {
+            cerr << "Failed to open script " << filename << endl;
+            return 1;
+        }
+
+        result = interpreter.interpretScript(script, false);
+    }
+
+    if (CommandExecutionFailed == result)
+    {
+        cerr << "Interpreter error: " << interpreter.getLastError() << endl;
+    }
+
+    return CommandSuccess == result ? 0 : 1;
+}
+
 int main(int argc, char* argv[])
 {
     ExpressionInterpreter interpreter;
 
+    if (argc == 3 && strcmp(argv[1], "-f") == 0)
+    {
+        return runScript(interpreter, argv[2]);
+    }
+
     // create full string of arguments
     string userCommand;
 
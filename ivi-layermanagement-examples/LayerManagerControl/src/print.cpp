@@ -36,6 +36,9 @@ using std::map;
 #include <vector>
 using std::vector;
 
+#include <algorithm>
+using std::sort;
+
 
 void printArray(const char* text, unsigned int* array, int count)
 {
@@ -338,3 +341,220 @@ void printScene()
 
     free(screenArray);
 }
+
+void printStats()
+{
+    t_ilm_uint requestCount = 0;
+    struct ilmRequestStats* requests = NULL;
+    t_ilm_uint clientCount = 0;
+    struct ilmClientStats* clients = NULL;
+
+    ilmErrorTypes callResult = ilm_getStats(&requestCount, &requests,
+                                            &clientCount, &clients);
+    if (ILM_SUCCESS != callResult)
+    {
+        cout << "LayerManagerService returned: " << ILM_ERROR_STRING(callResult) << "\n";
+        cout << "Failed to get request statistics\n";
+        return;
+    }
+
+    cout << "requests\n";
+    cout << "---------------------------------------\n";
+
+    for (t_ilm_uint i = 0; i < requestCount; ++i)
+    {
+        const ilmRequestStats& r = requests[i];
+        t_ilm_uint meanUs = r.count ? (t_ilm_uint)(r.totalTimeUs / r.count) : 0;
+
+        cout << "- " << r.interfaceName << "." << r.requestName << ":\n";
+        cout << "    count: " << r.count << ", mean: " << meanUs
+                << "us, max: " << r.maxTimeUs << "us\n";
+
+        // bucket b holds calls below 2^b microseconds
+        cout << "    histogram:";
+        for (int b = 0; b < ILM_STATS_HISTOGRAM_BUCKETS; ++b)
+        {
+            if (r.histogram[b] == 0)
+                continue;
+
+            if (b == ILM_STATS_HISTOGRAM_BUCKETS - 1)
+                cout << " >=" << (1u << (b - 1)) << "us:" << r.histogram[b];
+            else
+                cout << " <" << (1u << b) << "us:" << r.histogram[b];
+        }
+        cout << "\n";
+    }
+
+    cout << "\nclients\n";
+    cout << "---------------------------------------\n";
+
+    for (t_ilm_uint i = 0; i < clientCount; ++i)
+    {
+        cout << "- pid " << clients[i].pid << ": "
+                << clients[i].requestCount << " requests\n";
+    }
+
+    free(requests);
+    free(clients);
+}
+
+void printScreenStats(unsigned int screenid)
+{
+    ilmScreenStats stats;
+
+    ilmErrorTypes callResult = ilm_getScreenStats(screenid, &stats);
+    if (ILM_SUCCESS != callResult)
+    {
+        cout << "LayerManagerService returned: " << ILM_ERROR_STRING(callResult) << "\n";
+        cout << "Failed to get statistics of screen with ID " << screenid << "\n";
+        return;
+    }
+
+    t_ilm_uint meanUs = stats.frameCount ?
+            (t_ilm_uint)(stats.totalRepaintTimeUs / stats.frameCount) : 0;
+
+    cout << "screen " << screenid << " (0x" << hex << screenid << dec << ")\n";
+    cout << "---------------------------------------\n";
+    cout << "- refresh rate: " << stats.refreshRate / 1000.0 << "Hz\n";
+    cout << "- frames: " << stats.frameCount << "\n";
+    cout << "- repaint: mean " << meanUs << "us, max "
+            << stats.maxRepaintTimeUs << "us\n";
+
+    cout << "- repaint histogram:";
+    for (int b = 0; b < ILM_STATS_HISTOGRAM_BUCKETS; ++b)
+    {
+        if (stats.repaintHistogram[b] == 0)
+            continue;
+
+        if (b == ILM_STATS_HISTOGRAM_BUCKETS - 1)
+            cout << " >=" << (1u << (b - 1)) << "us:" << stats.repaintHistogram[b];
+        else
+            cout << " <" << (1u << b) << "us:" << stats.repaintHistogram[b];
+    }
+    cout << "\n";
+
+    cout << "- frame intervals in refresh periods:";
+    for (int b = 0; b < ILM_SCREEN_INTERVAL_BUCKETS; ++b)
+    {
+        if (stats.intervalHistogram[b] == 0)
+            continue;
+
+        cout << " " << (b + 1)
+                << (b == ILM_SCREEN_INTERVAL_BUCKETS - 1 ? "+:" : ":")
+                << stats.intervalHistogram[b];
+    }
+    cout << "\n";
+
+    cout << "- missed vblanks: " << stats.missedVblanks << "\n";
+    cout << "- repaints over budget: " << stats.overBudgetFrames << "\n";
+    cout << "- views per frame: mean " << stats.meanViewCount
+            << ", max " << stats.maxViewCount << "\n";
+}
+
+void printScreenCoverage(unsigned int screenid)
+{
+    t_ilm_uint count = 0;
+    struct ilmSurfaceCoverage* coverage = NULL;
+
+    ilmErrorTypes callResult = ilm_getScreenCoverage(screenid, &count, &coverage);
+    if (ILM_SUCCESS != callResult)
+    {
+        cout << "LayerManagerService returned: " << ILM_ERROR_STRING(callResult) << "\n";
+        cout << "Failed to get coverage of screen with ID " << screenid << "\n";
+        return;
+    }
+
+    cout << "screen " << screenid << " (0x" << hex << screenid << dec << ")\n";
+    cout << "---------------------------------------\n";
+    for (t_ilm_uint i = 0; i < count; ++i)
+    {
+        cout << "- surface " << coverage[i].surfaceId << ": visible "
+                << coverage[i].visibleArea << " of " << coverage[i].area
+                << " pixels";
+        if (coverage[i].area)
+            cout << " (" << 100.0 * coverage[i].visibleArea / coverage[i].area << "%)";
+        cout << "\n";
+    }
+
+    free(coverage);
+}
+
+namespace
+{
+const char* const lifecycleStageNames[ILM_LIFECYCLE_STAGES] = {
+    "commit", "configure", "layer", "visible", "frame"
+};
+
+bool createdEarlier(const ilmSurfaceLifecycle& a, const ilmSurfaceLifecycle& b)
+{
+    return a.createdTimeMs < b.createdTimeMs;
+}
+}
+
+void printStartupReport()
+{
+    t_ilm_uint count = 0;
+    struct ilmSurfaceLifecycle* lifecycles = NULL;
+
+    ilmErrorTypes callResult = ilm_getSurfaceLifecycles(&count, &lifecycles);
+    if (ILM_SUCCESS != callResult)
+    {
+        cout << "LayerManagerService returned: " << ILM_ERROR_STRING(callResult) << "\n";
+        cout << "Failed to get surface lifecycles\n";
+        return;
+    }
+
+    sort(lifecycles, lifecycles + count, createdEarlier);
+
+    cout << "startup stages in ms after the creation of the surface\n";
+    cout << std::setw(10) << "surface" << std::setw(8) << "pid"
+            << std::setw(12) << "created";
+    for (int s = 0; s < ILM_LIFECYCLE_STAGES; ++s)
+        cout << std::setw(11) << lifecycleStageNames[s];
+    cout << "  slowest\n";
+
+    for (t_ilm_uint i = 0; i < count; ++i)
+    {
+        const ilmSurfaceLifecycle& l = lifecycles[i];
+
+        cout << std::setw(10) << l.surfaceId << std::setw(8) << l.pid
+                << std::setw(12) << l.createdTimeMs;
+
+        // the stage which took longest after the one reached before it
+        t_ilm_uint sorted[ILM_LIFECYCLE_STAGES];
+        int reached = 0;
+        for (int s = 0; s < ILM_LIFECYCLE_STAGES; ++s)
+        {
+            if (l.stageTimeUs[s] == ILM_LIFECYCLE_NOT_REACHED)
+            {
+                cout << std::setw(11) << "-";
+                continue;
+            }
+
+            cout << std::setw(11) << std::fixed << std::setprecision(1)
+                    << l.stageTimeUs[s] / 1000.0;
+            sorted[reached++] = l.stageTimeUs[s];
+        }
+        sort(sorted, sorted + reached);
+
+        int slowest = -1;
+        t_ilm_uint slowestUs = 0;
+        for (int r = 0; r < reached; ++r)
+        {
+            t_ilm_uint gap = sorted[r] - (r ? sorted[r - 1] : 0);
+            if (slowest < 0 || gap > slowestUs)
+            {
+                slowestUs = gap;
+                for (slowest = 0; l.stageTimeUs[slowest] != sorted[r]; ++slowest)
+                    ;
+            }
+        }
+
+        if (slowest >= 0)
+            cout << "  " << lifecycleStageNames[slowest] << " (+"
+                    << slowestUs / 1000.0 << "ms)";
+        cout << "\n";
+    }
+
+    free(lifecycles);
+}
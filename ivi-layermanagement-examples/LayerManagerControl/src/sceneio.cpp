@@ -16,6 +16,7 @@
  * limitations under the License.
  *
  ****************************************************************************/
+#include "ilm_control.h"
 #include "LMControl.h"
 #include "Expression.h"
 #include "ExpressionInterpreter.h"
@@ -34,6 +35,11 @@
 #include <cstring>
 #include <pthread.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -306,10 +312,415 @@ ilmLayerProperties getLayerProperties(IlmLayer* pIlmlayer)
 
     return props;
 }
+
+/*
+ * .ilmscene files hold a header followed by the screen, layer and surface
+ * records and the render order ids they refer to. All fields are 32 bit in
+ * host byte order and the records have a fixed size, so a mapped file is
+ * used without parsing. Readers reject other versions.
+ */
+const char ilmsceneMagic[8] = { 'I', 'L', 'M', 'S', 'C', 'E', 'N', 'E' };
+const uint32_t ilmsceneVersion = 1;
+
+struct IlmsceneHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t screenCount;
+    uint32_t layerCount;
+    uint32_t surfaceCount;
+    uint32_t idCount;
+};
+
+struct IlmsceneRectangle
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct IlmsceneScreen
+{
+    uint32_t id;
+    uint32_t firstLayer;    // index into the ids of the render order
+    uint32_t layerCount;
+};
+
+struct IlmsceneLayer
+{
+    uint32_t id;
+    uint32_t firstSurface;  // index into the ids of the render order
+    uint32_t surfaceCount;
+    float opacity;
+    IlmsceneRectangle source;
+    IlmsceneRectangle destination;
+    uint32_t visibility;
+};
+
+struct IlmsceneSurface
+{
+    uint32_t id;
+    float opacity;
+    IlmsceneRectangle source;
+    IlmsceneRectangle destination;
+    uint32_t visibility;
+};
+
+IlmsceneRectangle makeRectangle(t_ilm_uint x, t_ilm_uint y, t_ilm_uint width, t_ilm_uint height)
+{
+    IlmsceneRectangle rectangle = { x, y, width, height };
+    return rectangle;
+}
+
+bool operator!=(const IlmsceneRectangle& a, const IlmsceneRectangle& b)
+{
+    return a.x != b.x || a.y != b.y || a.width != b.width || a.height != b.height;
+}
+
+void exportSceneToBinary(string filename)
+{
+    t_scene_data scene;
+    captureSceneData(&scene);
+
+    vector<IlmsceneScreen> screens;
+    vector<IlmsceneLayer> layers;
+    vector<IlmsceneSurface> surfaces;
+    vector<uint32_t> ids;
+
+    for (vector<t_ilm_display>::iterator it = scene.screens.begin(); it != scene.screens.end(); ++it)
+    {
+        vector<t_ilm_layer>& order = scene.screenLayers[*it];
+        IlmsceneScreen screen = { *it, (uint32_t) ids.size(), (uint32_t) order.size() };
+        screens.push_back(screen);
+        ids.insert(ids.end(), order.begin(), order.end());
+    }
+
+    for (vector<t_ilm_layer>::iterator it = scene.layers.begin(); it != scene.layers.end(); ++it)
+    {
+        ilmLayerProperties& props = scene.layerProperties[*it];
+        vector<t_ilm_surface>& order = scene.layerSurfaces[*it];
+        IlmsceneLayer layer;
+
+        layer.id = *it;
+        layer.firstSurface = ids.size();
+        layer.surfaceCount = order.size();
+        layer.opacity = (float) props.opacity;
+        layer.source = makeRectangle(props.sourceX, props.sourceY, props.sourceWidth, props.sourceHeight);
+        layer.destination = makeRectangle(props.destX, props.destY, props.destWidth, props.destHeight);
+        layer.visibility = props.visibility;
+        layers.push_back(layer);
+        ids.insert(ids.end(), order.begin(), order.end());
+    }
+
+    for (vector<t_ilm_surface>::iterator it = scene.surfaces.begin(); it != scene.surfaces.end(); ++it)
+    {
+        ilmSurfaceProperties& props = scene.surfaceProperties[*it];
+        IlmsceneSurface surface;
+
+        surface.id = *it;
+        surface.opacity = (float) props.opacity;
+        surface.source = makeRectangle(props.sourceX, props.sourceY, props.sourceWidth, props.sourceHeight);
+        surface.destination = makeRectangle(props.destX, props.destY, props.destWidth, props.destHeight);
+        surface.visibility = props.visibility;
+        surfaces.push_back(surface);
+    }
+
+    IlmsceneHeader header;
+    memcpy(header.magic, ilmsceneMagic, sizeof header.magic);
+    header.version = ilmsceneVersion;
+    header.screenCount = screens.size();
+    header.layerCount = layers.size();
+    header.surfaceCount = surfaces.size();
+    header.idCount = ids.size();
+
+    ofstream stream(filename.c_str(), ios::out | ios::binary);
+    stream.write((const char*) &header, sizeof header);
+    if (!screens.empty())
+        stream.write((const char*) &screens[0], screens.size() * sizeof screens[0]);
+    if (!layers.empty())
+        stream.write((const char*) &layers[0], layers.size() * sizeof layers[0]);
+    if (!surfaces.empty())
+        stream.write((const char*) &surfaces[0], surfaces.size() * sizeof surfaces[0]);
+    if (!ids.empty())
+        stream.write((const char*) &ids[0], ids.size() * sizeof ids[0]);
+    stream.close();
+
+    if (!stream)
+    {
+        cout << "Failed to write scene to " << filename << "\n";
+        return;
+    }
+
+    cout << "DONE WRITING ILMSCENE: " << screens.size() << " screens, " << layers.size()
+            << " layers, " << surfaces.size() << " surfaces" << endl;
+}
+
+/*
+ * Points into a mapped .ilmscene file after its size and the ranges of
+ * its render orders have been checked
+ */
+struct IlmsceneView
+{
+    const IlmsceneHeader* header;
+    const IlmsceneScreen* screens;
+    const IlmsceneLayer* layers;
+    const IlmsceneSurface* surfaces;
+    const uint32_t* ids;
+};
+
+bool checkRange(uint32_t first, uint32_t count, uint32_t idCount)
+{
+    return first <= idCount && count <= idCount - first;
+}
+
+bool mapScene(const void* data, size_t size, IlmsceneView* pView)
+{
+    const IlmsceneHeader* header = (const IlmsceneHeader*) data;
+
+    if (size < sizeof *header || memcmp(header->magic, ilmsceneMagic, sizeof header->magic) != 0)
+    {
+        cout << "Not an ilmscene file\n";
+        return false;
+    }
+
+    if (header->version != ilmsceneVersion)
+    {
+        cout << "Unsupported ilmscene version " << header->version << "\n";
+        return false;
+    }
+
+    uint64_t expected = sizeof *header
+            + (uint64_t) header->screenCount * sizeof(IlmsceneScreen)
+            + (uint64_t) header->layerCount * sizeof(IlmsceneLayer)
+            + (uint64_t) header->surfaceCount * sizeof(IlmsceneSurface)
+            + (uint64_t) header->idCount * sizeof(uint32_t);
+    if (size != expected)
+    {
+        cout << "Truncated ilmscene file\n";
+        return false;
+    }
+
+    pView->header = header;
+    pView->screens = (const IlmsceneScreen*) (header + 1);
+    pView->layers = (const IlmsceneLayer*) (pView->screens + header->screenCount);
+    pView->surfaces = (const IlmsceneSurface*) (pView->layers + header->layerCount);
+    pView->ids = (const uint32_t*) (pView->surfaces + header->surfaceCount);
+
+    for (uint32_t i = 0; i < header->screenCount; ++i)
+    {
+        if (!checkRange(pView->screens[i].firstLayer, pView->screens[i].layerCount, header->idCount))
+        {
+            cout << "Invalid render order of screen " << pView->screens[i].id << "\n";
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header->layerCount; ++i)
+    {
+        if (!checkRange(pView->layers[i].firstSurface, pView->layers[i].surfaceCount, header->idCount))
+        {
+            cout << "Invalid render order of layer " << pView->layers[i].id << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Calls only the setters of properties which differ from the live scene.
+ * Layers are created when missing, surfaces belong to applications and
+ * are left out of the render orders when they do not exist.
+ */
+unsigned int applyScene(const IlmsceneView& view, t_scene_data& live)
+{
+    const IlmsceneHeader* header = view.header;
+    set<t_ilm_surface> missingSurfaces;
+    unsigned int changes = 0;
+
+    for (uint32_t i = 0; i < header->surfaceCount; ++i)
+    {
+        const IlmsceneSurface& surface = view.surfaces[i];
+
+        if (live.surfaceProperties.find(surface.id) == live.surfaceProperties.end())
+        {
+            cout << "Surface " << surface.id << " does not exist, skipped\n";
+            missingSurfaces.insert(surface.id);
+            continue;
+        }
+
+        ilmSurfaceProperties& props = live.surfaceProperties[surface.id];
+
+        if ((float) props.opacity != surface.opacity)
+        {
+            ilm_surfaceSetOpacity(surface.id, surface.opacity);
+            ++changes;
+        }
+
+        if (makeRectangle(props.sourceX, props.sourceY, props.sourceWidth, props.sourceHeight) != surface.source)
+        {
+            ilm_surfaceSetSourceRectangle(surface.id, surface.source.x, surface.source.y,
+                    surface.source.width, surface.source.height);
+            ++changes;
+        }
+
+        if (makeRectangle(props.destX, props.destY, props.destWidth, props.destHeight) != surface.destination)
+        {
+            ilm_surfaceSetDestinationRectangle(surface.id, surface.destination.x, surface.destination.y,
+                    surface.destination.width, surface.destination.height);
+            ++changes;
+        }
+
+        if (props.visibility != surface.visibility)
+        {
+            ilm_surfaceSetVisibility(surface.id, surface.visibility);
+            ++changes;
+        }
+    }
+
+    for (uint32_t i = 0; i < header->layerCount; ++i)
+    {
+        const IlmsceneLayer& layer = view.layers[i];
+        ilmLayerProperties props;
+
+        if (live.layerProperties.find(layer.id) == live.layerProperties.end())
+        {
+            t_ilm_layer layerId = layer.id;
+            ilmErrorTypes callResult = ilm_layerCreateWithDimension(&layerId,
+                    layer.source.width, layer.source.height);
+            if (ILM_SUCCESS != callResult)
+            {
+                cout << "LayerManagerService returned: " << ILM_ERROR_STRING(callResult) << "\n";
+                cout << "Failed to create layer with ID " << layer.id << "\n";
+                continue;
+            }
+
+            //properties of the new layer are unknown, set all of them
+            memset(&props, 0xff, sizeof props);
+            props.opacity = -1.0;
+            ++changes;
+        }
+        else
+        {
+            props = live.layerProperties[layer.id];
+        }
+
+        if ((float) props.opacity != layer.opacity)
+        {
+            ilm_layerSetOpacity(layer.id, layer.opacity);
+            ++changes;
+        }
+
+        if (makeRectangle(props.sourceX, props.sourceY, props.sourceWidth, props.sourceHeight) != layer.source)
+        {
+            ilm_layerSetSourceRectangle(layer.id, layer.source.x, layer.source.y,
+                    layer.source.width, layer.source.height);
+            ++changes;
+        }
+
+        if (makeRectangle(props.destX, props.destY, props.destWidth, props.destHeight) != layer.destination)
+        {
+            ilm_layerSetDestinationRectangle(layer.id, layer.destination.x, layer.destination.y,
+                    layer.destination.width, layer.destination.height);
+            ++changes;
+        }
+
+        if (props.visibility != layer.visibility)
+        {
+            ilm_layerSetVisibility(layer.id, layer.visibility);
+            ++changes;
+        }
+
+        vector<t_ilm_surface> order;
+        for (uint32_t j = 0; j < layer.surfaceCount; ++j)
+        {
+            t_ilm_surface surfaceId = view.ids[layer.firstSurface + j];
+            if (missingSurfaces.find(surfaceId) == missingSurfaces.end())
+                order.push_back(surfaceId);
+        }
+
+        if (order != live.layerSurfaces[layer.id])
+        {
+            ilm_layerSetRenderOrder(layer.id, order.empty() ? NULL : &order[0], order.size());
+            ++changes;
+        }
+    }
+
+    for (uint32_t i = 0; i < header->screenCount; ++i)
+    {
+        const IlmsceneScreen& screen = view.screens[i];
+
+        if (find(live.screens.begin(), live.screens.end(), screen.id) == live.screens.end())
+        {
+            cout << "Screen " << screen.id << " does not exist, skipped\n";
+            continue;
+        }
+
+        vector<t_ilm_layer> order(view.ids + screen.firstLayer,
+                view.ids + screen.firstLayer + screen.layerCount);
+
+        if (order != live.screenLayers[screen.id])
+        {
+            ilm_displaySetRenderOrder(screen.id, order.empty() ? NULL : &order[0], order.size());
+            ++changes;
+        }
+    }
+
+    return changes;
+}
 } //end of anonymous namespace
 
+void applySceneFromFile(string filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        cout << "Failed to open scene file " << filename << "\n";
+        return;
+    }
+
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        cout << "Failed to read scene file " << filename << "\n";
+        return;
+    }
+
+    IlmsceneView view;
+    if (mapScene(data, st.st_size, &view))
+    {
+        t_scene_data live;
+        captureSceneData(&live);
+
+        unsigned int changes = applyScene(view, live);
+        if (changes > 0)
+        {
+            commitChanges();
+        }
+
+        cout << "Applied " << changes << " changes from " << filename << endl;
+    }
+
+    munmap(data, st.st_size);
+}
+
 void exportSceneToFile(string filename)
 {
+    //the binary format does not go through the string tree
+    if (filename.size() > 9 && filename.compare(filename.size() - 9, 9, ".ilmscene") == 0)
+    {
+        exportSceneToBinary(filename);
+        return;
+    }
+
     IlmScene ilmscene;
     IlmScene* pScene = &ilmscene;
     captureSceneData(&ilmscene);
@@ -0,0 +1,745 @@
+/*
+ * Copyright (C) 2026 The wayland-ivi-extension contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * ivi-shm-load: synthetic load generator for the ivi compositor.
+ *
+ * Creates many ivi_surfaces through ivi_application, each double buffered
+ * with wl_shm, and commits them at a given rate with a given damage
+ * pattern. Surfaces can be destroyed and recreated after a lifetime to
+ * generate churn. Needs neither EGL nor a GPU, so it runs on headless CI
+ * machines. The latency of every commit, measured up to the compositor's
+ * reply to a wl_display.sync sent right after it, is logged as a histogram.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+
+#include <wayland-client.h>
+#include <ivi-application-client-protocol.h>
+
+#define LATENCY_BUCKETS 24          /* log2 buckets of microseconds */
+#define BOX_SIZE        32
+
+enum damage_pattern {
+    DAMAGE_FULL,
+    DAMAGE_BOX,
+    DAMAGE_NONE
+};
+
+struct load_options {
+    int surfaces;
+    int processes;
+    int width;
+    int height;
+    int fps;
+    enum damage_pattern damage;
+    int lifetime_ms;
+    int duration_s;
+    int report_s;
+    uint32_t id_base;
+    int verbose;
+};
+
+struct load_stats {
+    uint64_t commits;
+    uint64_t stalls;            /* frames skipped, both buffers busy */
+    uint64_t created;
+    uint64_t destroyed;
+    uint64_t latency_sum_us;
+    uint64_t latency_max_us;
+    uint64_t latency_hist[LATENCY_BUCKETS];
+};
+
+struct load_buffer {
+    struct wl_buffer *buffer;
+    void *data;
+    int busy;
+};
+
+struct load_surface {
+    struct load_context *ctx;
+    uint32_t ivi_id;
+    struct wl_surface *surface;
+    struct ivi_surface *ivi_surface;
+    struct load_buffer buffers[2];
+    void *shm_data;
+    size_t shm_size;
+    uint32_t frame;
+    uint64_t expires_us;        /* 0 if the surface lives forever */
+};
+
+struct pending_commit {
+    struct load_context *ctx;
+    struct wl_callback *callback;
+    uint64_t commit_us;
+};
+
+struct load_context {
+    struct load_options opts;
+    struct wl_display *display;
+    struct wl_compositor *compositor;
+    struct wl_shm *shm;
+    struct ivi_application *ivi_application;
+    struct load_surface *surfaces;
+    int n_surfaces;
+    struct load_stats stats;
+    uint32_t rng;
+};
+
+static volatile sig_atomic_t running = 1;
+
+static uint64_t
+now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t
+next_random(struct load_context *ctx)
+{
+    ctx->rng ^= ctx->rng << 13;
+    ctx->rng ^= ctx->rng >> 17;
+    ctx->rng ^= ctx->rng << 5;
+
+    return ctx->rng;
+}
+
+static void
+signal_int(int signum)
+{
+    running = 0;
+}
+
+static void
+record_latency(struct load_stats *stats, uint64_t latency_us)
+{
+    int bucket = 0;
+
+    while ((bucket < LATENCY_BUCKETS - 1) && ((uint64_t)1 << (bucket + 1)) <= latency_us)
+        bucket++;
+
+    stats->latency_hist[bucket]++;
+    stats->latency_sum_us += latency_us;
+    if (latency_us > stats->latency_max_us)
+        stats->latency_max_us = latency_us;
+}
+
+/* upper bound of the bucket which contains the given percentile */
+static uint64_t
+latency_percentile(const struct load_stats *stats, int pct)
+{
+    uint64_t total = 0, seen = 0;
+    int i;
+
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+        total += stats->latency_hist[i];
+
+    if (total == 0)
+        return 0;
+
+    for (i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += stats->latency_hist[i];
+        if (seen * 100 >= total * pct)
+            return (uint64_t)1 << (i + 1);
+    }
+
+    return stats->latency_max_us;
+}
+
+static void
+print_stats(struct load_context *ctx, double seconds)
+{
+    struct load_stats *stats = &ctx->stats;
+    uint64_t completed = 0;
+    int i;
+
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+        completed += stats->latency_hist[i];
+
+    printf("ivi-shm-load[%d]: %.1fs surfaces=%d commits=%llu (%.1f/s) stalls=%llu "
+           "created=%llu destroyed=%llu latency avg=%lluus p50<%lluus p99<%lluus max=%lluus\n",
+           (int)getpid(), seconds, ctx->n_surfaces,
+           (unsigned long long)stats->commits,
+           seconds > 0 ? stats->commits / seconds : 0.0,
+           (unsigned long long)stats->stalls,
+           (unsigned long long)stats->created,
+           (unsigned long long)stats->destroyed,
+           (unsigned long long)(completed ? stats->latency_sum_us / completed : 0),
+           (unsigned long long)latency_percentile(stats, 50),
+           (unsigned long long)latency_percentile(stats, 99),
+           (unsigned long long)stats->latency_max_us);
+
+    if (ctx->opts.verbose) {
+        for (i = 0; i < LATENCY_BUCKETS; i++) {
+            if (stats->latency_hist[i] == 0)
+                continue;
+            printf("    < %8lluus: %llu\n",
+                   (unsigned long long)1 << (i + 1),
+                   (unsigned long long)stats->latency_hist[i]);
+        }
+    }
+    fflush(stdout);
+}
+
+static int
+create_shm_file(off_t size)
+{
+    const char template[] = "/ivi-shm-load-XXXXXX";
+    const char *runtimedir = getenv("XDG_RUNTIME_DIR");
+    char *name;
+    int fd;
+
+    if (runtimedir == NULL) {
+        fprintf(stderr, "XDG_RUNTIME_DIR is not set\n");
+        return -1;
+    }
+
+    name = malloc(strlen(runtimedir) + sizeof(template));
+    if (name == NULL)
+        return -1;
+
+    fd = mkostemp(strcat(strcpy(name, runtimedir), template), O_CLOEXEC);
+    if (fd >= 0) {
+        unlink(name);
+        if (ftruncate(fd, size) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    free(name);
+
+    return fd;
+}
+
+static void
+buffer_release(void *data, struct wl_buffer *buffer)
+{
+    struct load_buffer *load_buffer = data;
+
+    load_buffer->busy = 0;
+}
+
+static const struct wl_buffer_listener buffer_listener = {
+    buffer_release
+};
+
+static void
+sync_done(void *data, struct wl_callback *callback, uint32_t serial)
+{
+    struct pending_commit *pending = data;
+
+    record_latency(&pending->ctx->stats, now_us() - pending->commit_us);
+    wl_callback_destroy(callback);
+    free(pending);
+}
+
+static const struct wl_callback_listener sync_listener = {
+    sync_done
+};
+
+static void
+destroy_load_surface(struct load_surface *s)
+{
+    int i;
+
+    if (s->surface == NULL)
+        return;
+
+    ivi_surface_destroy(s->ivi_surface);
+    wl_surface_destroy(s->surface);
+    for (i = 0; i < 2; i++)
+        wl_buffer_destroy(s->buffers[i].buffer);
+    munmap(s->shm_data, s->shm_size);
+
+    s->surface = NULL;
+    s->ivi_surface = NULL;
+    s->ctx->stats.destroyed++;
+}
+
+static int
+create_load_surface(struct load_surface *s)
+{
+    struct load_context *ctx = s->ctx;
+    int stride = ctx->opts.width * 4;
+    int buffer_size = stride * ctx->opts.height;
+    struct wl_shm_pool *pool;
+    int fd, i;
+
+    s->shm_size = buffer_size * 2;
+    fd = create_shm_file(s->shm_size);
+    if (fd < 0)
+        return -1;
+
+    s->shm_data = mmap(NULL, s->shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (s->shm_data == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    pool = wl_shm_create_pool(ctx->shm, fd, s->shm_size);
+    for (i = 0; i < 2; i++) {
+        s->buffers[i].data = (char *)s->shm_data + i * buffer_size;
+        s->buffers[i].busy = 0;
+        s->buffers[i].buffer =
+            wl_shm_pool_create_buffer(pool, i * buffer_size,
+                                      ctx->opts.width, ctx->opts.height,
+                                      stride, WL_SHM_FORMAT_XRGB8888);
+        wl_buffer_add_listener(s->buffers[i].buffer, &buffer_listener,
+                               &s->buffers[i]);
+        memset(s->buffers[i].data, 0x40, buffer_size);
+    }
+    wl_shm_pool_destroy(pool);
+    close(fd);
+
+    s->surface = wl_compositor_create_surface(ctx->compositor);
+    s->ivi_surface = ivi_application_surface_create(ctx->ivi_application,
+                                                    s->ivi_id, s->surface);
+    s->frame = 0;
+
+    if (ctx->opts.lifetime_ms > 0) {
+        /* spread the lifetimes so the churn does not come in waves */
+        uint64_t lifetime_us = (uint64_t)ctx->opts.lifetime_ms * 1000;
+        s->expires_us = now_us() + lifetime_us / 2 + next_random(ctx) % lifetime_us;
+    } else {
+        s->expires_us = 0;
+    }
+
+    ctx->stats.created++;
+
+    return 0;
+}
+
+static void
+fill_rect(void *data, int stride, int x, int y, int width, int height,
+          uint32_t color)
+{
+    int row, col;
+
+    for (row = y; row < y + height; row++) {
+        uint32_t *p = (uint32_t *)((char *)data + row * stride) + x;
+        for (col = 0; col < width; col++)
+            p[col] = color;
+    }
+}
+
+static void
+draw_and_commit(struct load_surface *s)
+{
+    struct load_context *ctx = s->ctx;
+    int width = ctx->opts.width;
+    int height = ctx->opts.height;
+    int stride = width * 4;
+    struct load_buffer *buffer = NULL;
+    struct pending_commit *pending;
+    uint32_t color = 0xff000000 | (s->frame * 0x00010203);
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        if (!s->buffers[i].busy) {
+            buffer = &s->buffers[i];
+            break;
+        }
+    }
+
+    if (buffer == NULL) {
+        ctx->stats.stalls++;
+        return;
+    }
+
+    wl_surface_attach(s->surface, buffer->buffer, 0, 0);
+
+    switch (ctx->opts.damage) {
+    case DAMAGE_FULL:
+        fill_rect(buffer->data, stride, 0, 0, width, height, color);
+        wl_surface_damage(s->surface, 0, 0, width, height);
+        break;
+    case DAMAGE_BOX: {
+        int box_w = width < BOX_SIZE ? width : BOX_SIZE;
+        int box_h = height < BOX_SIZE ? height : BOX_SIZE;
+        int x = (s->frame * 4) % (width - box_w + 1);
+        int y = (s->frame * 2) % (height - box_h + 1);
+
+        fill_rect(buffer->data, stride, x, y, box_w, box_h, color);
+        wl_surface_damage(s->surface, x, y, box_w, box_h);
+        break;
+    }
+    case DAMAGE_NONE:
+        break;
+    }
+
+    wl_surface_commit(s->surface);
+    buffer->busy = 1;
+    s->frame++;
+    ctx->stats.commits++;
+
+    pending = malloc(sizeof(*pending));
+    if (pending == NULL)
+        return;
+
+    pending->ctx = ctx;
+    pending->commit_us = now_us();
+    pending->callback = wl_display_sync(ctx->display);
+    wl_callback_add_listener(pending->callback, &sync_listener, pending);
+}
+
+static void
+registry_handle_global(void *data, struct wl_registry *registry,
+                       uint32_t name, const char *interface, uint32_t version)
+{
+    struct load_context *ctx = data;
+
+    if (strcmp(interface, "wl_compositor") == 0) {
+        ctx->compositor =
+            wl_registry_bind(registry, name, &wl_compositor_interface, 1);
+    } else if (strcmp(interface, "wl_shm") == 0) {
+        ctx->shm = wl_registry_bind(registry, name, &wl_shm_interface, 1);
+    } else if (strcmp(interface, "ivi_application") == 0) {
+        ctx->ivi_application =
+            wl_registry_bind(registry, name, &ivi_application_interface, 1);
+    }
+}
+
+static void
+registry_handle_global_remove(void *data, struct wl_registry *registry,
+                              uint32_t name)
+{
+}
+
+static const struct wl_registry_listener registry_listener = {
+    registry_handle_global,
+    registry_handle_global_remove
+};
+
+static int
+run_load(struct load_options *opts, uint32_t id_base, int n_surfaces)
+{
+    struct load_context ctx;
+    struct wl_registry *registry;
+    struct itimerspec its;
+    struct pollfd fds[2];
+    uint64_t start, last_report;
+    int timer_fd;
+    int ret = EXIT_FAILURE;
+    int i;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.opts = *opts;
+    ctx.n_surfaces = n_surfaces;
+    ctx.rng = 0x9e3779b9 ^ id_base;
+
+    ctx.display = wl_display_connect(NULL);
+    if (ctx.display == NULL) {
+        fprintf(stderr, "failed to connect to display\n");
+        return EXIT_FAILURE;
+    }
+
+    registry = wl_display_get_registry(ctx.display);
+    wl_registry_add_listener(registry, &registry_listener, &ctx);
+    wl_display_roundtrip(ctx.display);
+
+    if (!ctx.compositor || !ctx.shm || !ctx.ivi_application) {
+        fprintf(stderr, "wl_compositor, wl_shm or ivi_application missing\n");
+        goto out_display;
+    }
+
+    ctx.surfaces = calloc(n_surfaces, sizeof(*ctx.surfaces));
+    if (ctx.surfaces == NULL)
+        goto out_display;
+
+    for (i = 0; i < n_surfaces; i++) {
+        ctx.surfaces[i].ctx = &ctx;
+        ctx.surfaces[i].ivi_id = id_base + i;
+        if (create_load_surface(&ctx.surfaces[i]) < 0) {
+            fprintf(stderr, "failed to create surface %u\n", id_base + i);
+            goto out_surfaces;
+        }
+        draw_and_commit(&ctx.surfaces[i]);
+    }
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timer_fd < 0)
+        goto out_surfaces;
+
+    its.it_interval.tv_sec = 0;
+    its.it_interval.tv_nsec = 1000000000L / opts->fps;
+    if (opts->fps == 1) {
+        its.it_interval.tv_sec = 1;
+        its.it_interval.tv_nsec = 0;
+    }
+    its.it_value = its.it_interval;
+    timerfd_settime(timer_fd, 0, &its, NULL);
+
+    fds[0].fd = wl_display_get_fd(ctx.display);
+    fds[0].events = POLLIN;
+    fds[1].fd = timer_fd;
+    fds[1].events = POLLIN;
+
+    start = last_report = now_us();
+
+    while (running) {
+        uint64_t now;
+
+        while (wl_display_prepare_read(ctx.display) != 0)
+            wl_display_dispatch_pending(ctx.display);
+
+        if (wl_display_flush(ctx.display) < 0 && errno != EAGAIN) {
+            wl_display_cancel_read(ctx.display);
+            break;
+        }
+
+        if (poll(fds, 2, -1) < 0) {
+            wl_display_cancel_read(ctx.display);
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            if (wl_display_read_events(ctx.display) < 0)
+                break;
+        } else {
+            wl_display_cancel_read(ctx.display);
+        }
+        if (wl_display_dispatch_pending(ctx.display) < 0)
+            break;
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t expirations;
+
+            if (read(timer_fd, &expirations, sizeof(expirations)) < 0)
+                continue;
+
+            now = now_us();
+            for (i = 0; i < n_surfaces; i++) {
+                struct load_surface *s = &ctx.surfaces[i];
+
+                if (s->expires_us != 0 && now >= s->expires_us) {
+                    destroy_load_surface(s);
+                    if (create_load_surface(s) < 0)
+                        continue;
+                }
+                draw_and_commit(s);
+            }
+        }
+
+        now = now_us();
+        if (opts->report_s > 0 &&
+            now - last_report >= (uint64_t)opts->report_s * 1000000) {
+            print_stats(&ctx, (now - start) / 1e6);
+            last_report = now;
+        }
+        if (opts->duration_s > 0 &&
+            now - start >= (uint64_t)opts->duration_s * 1000000)
+            break;
+    }
+
+    wl_display_roundtrip(ctx.display);
+    print_stats(&ctx, (now_us() - start) / 1e6);
+    ret = EXIT_SUCCESS;
+
+    close(timer_fd);
+out_surfaces:
+    for (i = 0; i < n_surfaces; i++)
+        destroy_load_surface(&ctx.surfaces[i]);
+    free(ctx.surfaces);
+out_display:
+    wl_display_flush(ctx.display);
+    wl_display_disconnect(ctx.display);
+    return ret;
+}
+
+static void
+usage(int status)
+{
+    printf("usage: ivi-shm-load [OPTION]\n"
+           "    -h,  --help                display this help and exit.\n"
+           "    -n,  --surfaces <n>        number of ivi surfaces (default 10)\n"
+           "    -p,  --processes <n>       spread the surfaces over n client processes (default 1)\n"
+           "    -s,  --size <w>x<h>        surface size (default 256x256)\n"
+           "    -r,  --rate <fps>          commits per second and surface (default 30)\n"
+           "    -d,  --damage <pattern>    full, box or none (default full)\n"
+           "    -l,  --lifetime <ms>       destroy and recreate surfaces after about\n"
+           "                               this time, 0 keeps them (default 0)\n"
+           "    -t,  --duration <s>        stop after s seconds, 0 runs until SIGINT (default 0)\n"
+           "    -R,  --report <s>          print statistics every s seconds (default 5)\n"
+           "    -i,  --id-base <id>        ivi id of the first surface (default 0x20000)\n"
+           "    -v,  --verbose             also print the commit latency histogram\n");
+    exit(status);
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const struct option options[] = {
+        { "help",      no_argument,       NULL, 'h' },
+        { "surfaces",  required_argument, NULL, 'n' },
+        { "processes", required_argument, NULL, 'p' },
+        { "size",      required_argument, NULL, 's' },
+        { "rate",      required_argument, NULL, 'r' },
+        { "damage",    required_argument, NULL, 'd' },
+        { "lifetime",  required_argument, NULL, 'l' },
+        { "duration",  required_argument, NULL, 't' },
+        { "report",    required_argument, NULL, 'R' },
+        { "id-base",   required_argument, NULL, 'i' },
+        { "verbose",   no_argument,       NULL, 'v' },
+        { 0,           0,                 NULL, 0 }
+    };
+    struct load_options opts = {
+        .surfaces = 10,
+        .processes = 1,
+        .width = 256,
+        .height = 256,
+        .fps = 30,
+        .damage = DAMAGE_FULL,
+        .lifetime_ms = 0,
+        .duration_s = 0,
+        .report_s = 5,
+        .id_base = 0x20000,
+        .verbose = 0,
+    };
+    struct sigaction sigint;
+    pid_t *children;
+    int ret = EXIT_SUCCESS;
+    int opt, p, first;
+
+    while ((opt = getopt_long(argc, argv, "hn:p:s:r:d:l:t:R:i:v", options, NULL)) != -1) {
+        switch (opt) {
+        case 'h':
+            usage(EXIT_SUCCESS);
+            break;
+        case 'n':
+            opts.surfaces = atoi(optarg);
+            break;
+        case 'p':
+            opts.processes = atoi(optarg);
+            break;
+        case 's':
+            if (sscanf(optarg, "%dx%d", &opts.width, &opts.height) != 2)
+                usage(EXIT_FAILURE);
+            break;
+        case 'r':
+            opts.fps = atoi(optarg);
+            break;
+        case 'd':
+            if (strcmp(optarg, "full") == 0)
+                opts.damage = DAMAGE_FULL;
+            else if (strcmp(optarg, "box") == 0)
+                opts.damage = DAMAGE_BOX;
+            else if (strcmp(optarg, "none") == 0)
+                opts.damage = DAMAGE_NONE;
+            else
+                usage(EXIT_FAILURE);
+            break;
+        case 'l':
+            opts.lifetime_ms = atoi(optarg);
+            break;
+        case 't':
+            opts.duration_s = atoi(optarg);
+            break;
+        case 'R':
+            opts.report_s = atoi(optarg);
+            break;
+        case 'i':
+            opts.id_base = strtoul(optarg, NULL, 0);
+            break;
+        case 'v':
+            opts.verbose = 1;
+            break;
+        default:
+            usage(EXIT_FAILURE);
+            break;
+        }
+    }
+
+    if (opts.surfaces <= 0 || opts.processes <= 0 || opts.fps <= 0 ||
+        opts.fps > 1000 || opts.width <= 0 || opts.height <= 0 ||
+        opts.lifetime_ms < 0)
+        usage(EXIT_FAILURE);
+
+    if (opts.processes > opts.surfaces)
+        opts.processes = opts.surfaces;
+
+    sigint.sa_handler = signal_int;
+    sigemptyset(&sigint.sa_mask);
+    sigint.sa_flags = SA_RESETHAND;
+    sigaction(SIGINT, &sigint, NULL);
+    sigaction(SIGTERM, &sigint, NULL);
+
+    if (opts.processes == 1)
+        return run_load(&opts, opts.id_base, opts.surfaces);
+
+    children = calloc(opts.processes, sizeof(pid_t));
+    if (children == NULL)
+        return EXIT_FAILURE;
+
+    /* like separate applications, every process has its own connection */
+    first = 0;
+    for (p = 0; p < opts.processes; p++) {
+        int count = opts.surfaces / opts.processes +
+                    (p < opts.surfaces % opts.processes ? 1 : 0);
+
+        children[p] = fork();
+        if (children[p] == 0)
+            _exit(run_load(&opts, opts.id_base + first, count));
+        if (children[p] < 0) {
+            fprintf(stderr, "fork failed: %s\n", strerror(errno));
+            ret = EXIT_FAILURE;
+            break;
+        }
+        first += count;
+    }
+
+    for (p = 0; p < opts.processes; p++) {
+        int status;
+
+        if (children[p] <= 0)
+            continue;
+
+        while (waitpid(children[p], &status, 0) < 0 && errno == EINTR)
+            kill(children[p], SIGTERM);
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+            ret = EXIT_FAILURE;
+    }
+
+    free(children);
+    return ret;
+}
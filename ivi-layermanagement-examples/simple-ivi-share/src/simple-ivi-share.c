@@ -24,6 +24,7 @@
 #include <string.h>
 #include <assert.h>
 #include <signal.h>
+#include <unistd.h>
 
 #include <wayland-client.h>
 #include <wayland-egl.h>
@@ -46,6 +47,7 @@ struct display {
     struct wl_touch        *touch;
     struct ivi_application *ivi_application;
     struct ivi_share       *ivi_share;
+    uint32_t                ivi_share_version;
 
     struct {
         EGLDisplay egldisplay;
@@ -84,7 +86,14 @@ struct window {
         uint32_t    stride;
         uint32_t    name;
         uint32_t    input_caps;
+        uint32_t    type;
         EGLImageKHR eglimage;
+        struct {
+            int32_t  fd[3];
+            uint32_t offset[3];
+            uint32_t stride[3];
+            uint64_t modifier;
+        } planes;
     } share_buffer;
 
     struct display *display;
@@ -259,6 +268,120 @@ handle_share_surface_state(void *data, struct ivi_share_surface *share_surface,
         ivi_share_surface_destroy(window->share_surface);
         window->share_surface = NULL;
         break;
+    case IVI_SHARE_SURFACE_SHARE_SURFACE_STATE_UNSUPPORTED_TYPE:
+        fprintf(stderr, "Share type %u is not supported by the compositor\n",
+                window->share_buffer.type);
+        ivi_share_surface_destroy(window->share_surface);
+        window->share_surface = NULL;
+        running = 0;
+        break;
+    }
+}
+
+static void
+handle_share_surface_dmabuf_plane(void *data, struct ivi_share_surface *share_surface,
+                                  uint32_t plane_idx, int32_t fd, uint32_t offset,
+                                  uint32_t stride, uint32_t modifier_hi,
+                                  uint32_t modifier_lo)
+{
+    struct window *window = data;
+
+    if (plane_idx >= 3) {
+        fprintf(stderr, "dmabuf plane %u is not supported\n", plane_idx);
+        close(fd);
+        return;
+    }
+
+    if (window->share_buffer.planes.fd[plane_idx] >= 0)
+        close(window->share_buffer.planes.fd[plane_idx]);
+
+    window->share_buffer.planes.fd[plane_idx] = fd;
+    window->share_buffer.planes.offset[plane_idx] = offset;
+    window->share_buffer.planes.stride[plane_idx] = stride;
+    window->share_buffer.planes.modifier =
+        ((uint64_t)modifier_hi << 32) | modifier_lo;
+}
+
+static void
+handle_share_surface_dmabuf_damage(void *data, struct ivi_share_surface *share_surface,
+                                   uint32_t name, uint32_t width, uint32_t height,
+                                   uint32_t format, uint32_t num_planes)
+{
+    static const EGLint plane_attribs[3][3] = {
+        { EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+          EGL_DMA_BUF_PLANE0_PITCH_EXT },
+        { EGL_DMA_BUF_PLANE1_FD_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+          EGL_DMA_BUF_PLANE1_PITCH_EXT },
+        { EGL_DMA_BUF_PLANE2_FD_EXT, EGL_DMA_BUF_PLANE2_OFFSET_EXT,
+          EGL_DMA_BUF_PLANE2_PITCH_EXT },
+    };
+    struct window *window = data;
+    struct display *display = window->display;
+#ifdef EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT
+    static const EGLint modifier_attribs[3][2] = {
+        { EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT },
+        { EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT },
+        { EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT },
+    };
+    uint64_t modifier = window->share_buffer.planes.modifier;
+#endif
+    EGLint img_attribs[6 + 3 * 10 + 1];
+    uint32_t i;
+    int n = 0;
+
+    if (num_planes == 0 || num_planes > 3)
+        return;
+
+    if (window->share_buffer.name != name) {
+        if (window->share_buffer.eglimage != NULL) {
+            pfEglDestroyImageKHR(display->egl.egldisplay,
+                                 window->share_buffer.eglimage);
+            ivi_share_surface_release_shared_name(window->share_surface,
+                                                  window->share_buffer.name);
+        }
+
+        img_attribs[n++] = EGL_WIDTH;
+        img_attribs[n++] = width;
+        img_attribs[n++] = EGL_HEIGHT;
+        img_attribs[n++] = height;
+        img_attribs[n++] = EGL_LINUX_DRM_FOURCC_EXT;
+        img_attribs[n++] = format;
+        for (i = 0; i < num_planes; i++) {
+            img_attribs[n++] = plane_attribs[i][0];
+            img_attribs[n++] = window->share_buffer.planes.fd[i];
+            img_attribs[n++] = plane_attribs[i][1];
+            img_attribs[n++] = window->share_buffer.planes.offset[i];
+            img_attribs[n++] = plane_attribs[i][2];
+            img_attribs[n++] = window->share_buffer.planes.stride[i];
+#ifdef EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT
+            /* DRM_FORMAT_MOD_INVALID: implicit modifier */
+            if (modifier != 0x00ffffffffffffffULL) {
+                img_attribs[n++] = modifier_attribs[i][0];
+                img_attribs[n++] = (EGLint)(modifier & 0xffffffff);
+                img_attribs[n++] = modifier_attribs[i][1];
+                img_attribs[n++] = (EGLint)(modifier >> 32);
+            }
+#endif
+        }
+        img_attribs[n++] = EGL_NONE;
+
+        window->share_buffer.eglimage =
+            pfEglCreateImageKHR(display->egl.egldisplay, EGL_NO_CONTEXT,
+                                EGL_LINUX_DMA_BUF_EXT, NULL, img_attribs);
+        if (window->share_buffer.eglimage == NULL) {
+            fprintf(stderr, "failed to create EGLImageKHR from dmabuf: 0x%04x\n",
+                eglGetError());
+        }
+
+        window->share_buffer.name = name;
+    }
+
+    /* the EGLImage keeps its own reference to the buffer */
+    for (i = 0; i < 3; i++) {
+        if (window->share_buffer.planes.fd[i] >= 0) {
+            close(window->share_buffer.planes.fd[i]);
+            window->share_buffer.planes.fd[i] = -1;
+        }
     }
 }
 
@@ -266,7 +389,9 @@ static const struct ivi_share_surface_listener share_surface_listener = {
     handle_share_surface_damage,
     handle_share_surface_configure,
     handle_share_surface_input_caps,
-    handle_share_surface_state
+    handle_share_surface_state,
+    handle_share_surface_dmabuf_plane,
+    handle_share_surface_dmabuf_damage
 };
 
 static int
@@ -274,9 +399,15 @@ get_share_surface(struct window *window, struct display *display)
 {
     static struct ivi_share_surface *share_surface_latest = NULL;
     if (!window->share_surface) {
-        window->share_surface =
-            ivi_share_get_ivi_share_surface(display->ivi_share,
-                                            window->share_buffer.share_surface_id);
+        if (window->share_buffer.type == IVI_SHARE_SURFACE_TYPE_GBM)
+            window->share_surface =
+                ivi_share_get_ivi_share_surface(display->ivi_share,
+                                                window->share_buffer.share_surface_id);
+        else
+            window->share_surface =
+                ivi_share_get_ivi_share_surface_with_type(display->ivi_share,
+                                                          window->share_buffer.share_surface_id,
+                                                          window->share_buffer.type);
         if (share_surface_latest != window->share_surface) {
             share_surface_latest = window->share_surface;
             return ivi_share_surface_add_listener(window->share_surface,
@@ -580,8 +711,10 @@ registry_handle_global(void *data, struct wl_registry *registry,
         display->ivi_application =
             wl_registry_bind(registry, name, &ivi_application_interface, 1);
     } else if (strcmp(interface, "ivi_share") == 0) {
+        display->ivi_share_version = version < 3 ? version : 3;
         display->ivi_share =
-            wl_registry_bind(registry, name, &ivi_share_interface, 2);
+            wl_registry_bind(registry, name, &ivi_share_interface,
+                             display->ivi_share_version);
     } else if (strcmp(interface, "wl_seat") == 0) {
         display->seat =
             wl_registry_bind(registry, name, &wl_seat_interface, 1);
@@ -680,8 +813,9 @@ main(int argc, char **argv)
     int ret = 0;
     struct sigaction sigact;
 
-    if (argc != 2) {
-        fprintf(stderr, "usage: simple-ivi-share <surface ID to share buffer>\n");
+    if ((argc != 2) &&
+        !((argc == 3) && (strcmp(argv[2], "dmabuf") == 0))) {
+        fprintf(stderr, "usage: simple-ivi-share <surface ID to share buffer> [dmabuf]\n");
         return 1;
     }
 
@@ -693,6 +827,11 @@ main(int argc, char **argv)
     window.display = &display;
     window.surface_id = 1000;
     window.share_buffer.share_surface_id = atoi(argv[1]);
+    window.share_buffer.type = (argc == 3) ? IVI_SHARE_SURFACE_TYPE_DMABUF
+                                           : IVI_SHARE_SURFACE_TYPE_GBM;
+    window.share_buffer.planes.fd[0] = -1;
+    window.share_buffer.planes.fd[1] = -1;
+    window.share_buffer.planes.fd[2] = -1;
     window.geometry.width = 250;
     window.geometry.height = 250;
 
@@ -700,6 +839,13 @@ main(int argc, char **argv)
         return 1;
     }
 
+    if ((window.share_buffer.type == IVI_SHARE_SURFACE_TYPE_DMABUF) &&
+        (display.ivi_share_version < IVI_SHARE_GET_IVI_SHARE_SURFACE_WITH_TYPE_SINCE_VERSION)) {
+        fprintf(stderr, "compositor does not support dmabuf sharing\n");
+        destroy_display(&display);
+        return 1;
+    }
+
     if (create_window(&window) < 0) {
         destroy_display(&display);
         return 1;
@@ -1 +1,4 @@
 #cmakedefine HAVE_POSIX_FALLOCATE 1
+#cmakedefine HAVE_MEMFD_CREATE 1
+#cmakedefine HAVE_WESTON_FRAME_CALLBACK 1
+#cmakedefine HAVE_GBM_BO_GET_FD_FOR_PLANE 1
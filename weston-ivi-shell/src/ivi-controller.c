@@ -32,12 +32,15 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <sys/mman.h>
+#include <linux/input.h>
 
 #include <weston.h>
 #include "ivi-wm-server-protocol.h"
 #include "ivi-controller.h"
+#include "ivi-pool.h"
 
 #include "wayland-util.h"
 #ifdef IVI_SHARE_ENABLE
@@ -46,6 +49,14 @@
 
 #define IVI_CLIENT_SURFACE_ID_ENV_NAME "IVI_CLIENT_SURFACE_ID"
 
+#define IVI_WM_PROPERTY_ALL (IVI_WM_PROPERTY_OPACITY |               \
+                             IVI_WM_PROPERTY_SOURCE_RECTANGLE |      \
+                             IVI_WM_PROPERTY_DESTINATION_RECTANGLE | \
+                             IVI_WM_PROPERTY_VISIBILITY |            \
+                             IVI_WM_PROPERTY_SIZE |                  \
+                             IVI_WM_PROPERTY_STALL |                 \
+                             IVI_WM_PROPERTY_OCCLUSION)
+
 struct ivilayer;
 struct iviscreen;
 
@@ -53,6 +64,8 @@ struct notification {
     struct wl_list link;
     struct wl_resource *resource;
     struct wl_list layout_link;
+    /* IVI_WM_PROPERTY_* requested for this object */
+    uint32_t mask;
 };
 
 struct ivilayer {
@@ -62,14 +75,45 @@ struct ivilayer {
     const struct ivi_layout_layer_properties *prop;
     struct wl_listener property_changed;
     struct wl_list notification_list;
+
+    /* property changes not yet sent to version 2 controllers */
+    uint32_t pending_mask;
+    struct wl_list pending_link;
 };
 
+/* intervals of 1 to 7 refresh periods, the last bucket holds longer ones */
+#define SCREEN_INTERVAL_BUCKETS 8
+
 struct iviscreen {
     struct wl_list link;
     struct ivishell *shell;
     uint32_t id_screen;
     struct weston_output *output;
     struct wl_list resource_list;
+    struct wl_listener frame_listener;
+
+    /* taken at the frame_signal, i.e. when the frame is composited, and
+     * from the presentation timestamp and counter of the output */
+    struct ivi_stats_request repaint_stats;
+    uint32_t interval_histogram[SCREEN_INTERVAL_BUCKETS];
+    uint32_t missed_vblanks;
+    uint32_t over_budget;
+    uint64_t views_total;
+    uint32_t views_max;
+    uint32_t last_frame_time;
+    uint64_t last_msc;
+    /* the last frame was composited after the vblank it was started for */
+    int late_frame;
+
+    /* struct surface_coverage of the last repaint, from top to bottom */
+    struct wl_array coverage;
+};
+
+/* arguments of an ivi_wm_screen.coverage event */
+struct surface_coverage {
+    uint32_t surface_id;
+    uint32_t area;
+    uint32_t visible_area;
 };
 
 struct ivicontroller {
@@ -81,6 +125,13 @@ struct ivicontroller {
 
     struct wl_list layer_notifications;
     struct wl_list surface_notifications;
+
+    /* IVI_WM_PROPERTY_* requested for all surfaces/layers */
+    uint32_t surface_sync_all_mask;
+    uint32_t layer_sync_all_mask;
+
+    /* flow id for the next commit_changes, 0 if none */
+    uint64_t trace_flow;
 };
 
 struct screenshot_frame_listener {
@@ -94,6 +145,94 @@ struct screen_id_info {
     uint32_t screen_id;
 };
 
+/* bookkeeping objects are created and destroyed at a high rate when
+ * clients churn short-lived surfaces, so they come from slab pools */
+static struct ivi_pool notification_pool =
+    IVI_POOL_INITIALIZER(struct notification, 64);
+static struct ivi_pool surface_pool =
+    IVI_POOL_INITIALIZER(struct ivisurface, 32);
+static struct ivi_pool layer_pool =
+    IVI_POOL_INITIALIZER(struct ivilayer, 16);
+static struct ivi_pool screenshot_pool =
+    IVI_POOL_INITIALIZER(struct screenshot_frame_listener, 4);
+
+/* opcodes of ivi_wm and ivi_wm_screen, in protocol order */
+enum wm_request {
+    WM_REQUEST_COMMIT_CHANGES,
+    WM_REQUEST_CREATE_SCREEN,
+    WM_REQUEST_SET_SURFACE_VISIBILITY,
+    WM_REQUEST_SET_LAYER_VISIBILITY,
+    WM_REQUEST_SET_SURFACE_OPACITY,
+    WM_REQUEST_SET_LAYER_OPACITY,
+    WM_REQUEST_SET_SURFACE_SOURCE_RECTANGLE,
+    WM_REQUEST_SET_LAYER_SOURCE_RECTANGLE,
+    WM_REQUEST_SET_SURFACE_DESTINATION_RECTANGLE,
+    WM_REQUEST_SET_LAYER_DESTINATION_RECTANGLE,
+    WM_REQUEST_SURFACE_SYNC,
+    WM_REQUEST_LAYER_SYNC,
+    WM_REQUEST_SURFACE_GET,
+    WM_REQUEST_LAYER_GET,
+    WM_REQUEST_SURFACE_SCREENSHOT,
+    WM_REQUEST_SET_SURFACE_TYPE,
+    WM_REQUEST_LAYER_CLEAR,
+    WM_REQUEST_LAYER_ADD_SURFACE,
+    WM_REQUEST_LAYER_REMOVE_SURFACE,
+    WM_REQUEST_CREATE_LAYOUT_LAYER,
+    WM_REQUEST_DESTROY_LAYOUT_LAYER,
+    WM_REQUEST_SURFACE_SYNC_MASK,
+    WM_REQUEST_LAYER_SYNC_MASK,
+    WM_REQUEST_SURFACE_SYNC_ALL,
+    WM_REQUEST_LAYER_SYNC_ALL,
+    WM_REQUEST_GET_STATS,
+    WM_REQUEST_TRACE_FLOW,
+    WM_REQUEST_GET_SURFACE_LIFECYCLE,
+};
+
+enum screen_request {
+    SCREEN_REQUEST_DESTROY,
+    SCREEN_REQUEST_CLEAR,
+    SCREEN_REQUEST_ADD_LAYER,
+    SCREEN_REQUEST_REMOVE_LAYER,
+    SCREEN_REQUEST_SCREENSHOT,
+    SCREEN_REQUEST_GET,
+    SCREEN_REQUEST_GET_STATS,
+    SCREEN_REQUEST_GET_COVERAGE,
+};
+
+static struct ivi_stats_table wm_stats;
+static struct ivi_stats_table screen_stats;
+
+/* accounts the handler in the request statistics and in the trace */
+#define WM_STATS_SCOPE(shell, request, client) \
+    IVI_TRACE_SCOPE((shell)->trace, \
+                    ivi_wm_interface.methods[WM_REQUEST_ ## request].name); \
+    IVI_STATS_SCOPE(&(shell)->stats, &wm_stats, \
+                    WM_REQUEST_ ## request, (client))
+
+/* the screen is NULL once its output is gone */
+#define SCREEN_STATS_SCOPE(iviscrn, request, client) \
+    IVI_TRACE_SCOPE((iviscrn) ? (iviscrn)->shell->trace : NULL, \
+                    ivi_wm_screen_interface. \
+                        methods[SCREEN_REQUEST_ ## request].name); \
+    IVI_STATS_SCOPE((iviscrn) ? &(iviscrn)->shell->stats : NULL, \
+                    &screen_stats, SCREEN_REQUEST_ ## request, (client))
+
+/* name shared by all events of a commit flow, see ivi_wm.trace_flow */
+#define TRACE_COMMIT_FLOW "ilm_commitChanges"
+
+static void
+log_pool_stats(struct ivi_pool *pool)
+{
+    struct ivi_pool_stats stats;
+
+    ivi_pool_get_stats(pool, &stats);
+    weston_log("ivi-controller: pool %s: in use %u, peak %u, slabs %u, "
+               "allocs %llu, frees %llu\n", pool->name,
+               stats.in_use, stats.peak, stats.slabs,
+               (unsigned long long)stats.allocs,
+               (unsigned long long)stats.frees);
+}
+
 static void
 clear_notification_list(struct wl_list* notification_list)
 {
@@ -102,8 +241,47 @@ clear_notification_list(struct wl_list* notification_list)
     wl_list_for_each_safe(not, next, notification_list, link) {
          wl_list_remove(&not->layout_link);
          wl_list_remove(&not->link);
-         free(not);
+         ivi_pool_free(&notification_pool, not);
+    }
+}
+
+static struct notification *
+add_notification(struct wl_list *controller_list, struct wl_list *layout_list,
+                 struct wl_resource *resource, uint32_t mask)
+{
+    struct notification *not;
+
+    not = ivi_pool_zalloc(&notification_pool);
+    if (not == NULL)
+        return NULL;
+
+    wl_list_insert(controller_list, &not->link);
+    wl_list_insert(layout_list, &not->layout_link);
+    not->resource = resource;
+    not->mask = mask;
+
+    return not;
+}
+
+static struct notification *
+find_notification(struct wl_list *layout_list, struct wl_resource *resource)
+{
+    struct notification *not;
+
+    wl_list_for_each(not, layout_list, layout_link) {
+        if (not->resource == resource)
+            return not;
     }
+
+    return NULL;
+}
+
+static void
+remove_notification(struct notification *not)
+{
+    wl_list_remove(&not->link);
+    wl_list_remove(&not->layout_link);
+    ivi_pool_free(&notification_pool, not);
 }
 
 static void
@@ -203,6 +381,375 @@ send_surface_event(struct ivicontroller * ctrl,
     }
 }
 
+static uint32_t
+to_wm_property_mask(uint32_t mask)
+{
+    uint32_t wm_mask = 0;
+
+    if (mask & IVI_NOTIFICATION_OPACITY)
+        wm_mask |= IVI_WM_PROPERTY_OPACITY;
+
+    if (mask & IVI_NOTIFICATION_SOURCE_RECT)
+        wm_mask |= IVI_WM_PROPERTY_SOURCE_RECTANGLE;
+
+    if (mask & IVI_NOTIFICATION_DEST_RECT)
+        wm_mask |= IVI_WM_PROPERTY_DESTINATION_RECTANGLE;
+
+    if (mask & IVI_NOTIFICATION_VISIBILITY)
+        wm_mask |= IVI_WM_PROPERTY_VISIBILITY;
+
+    if (mask & IVI_NOTIFICATION_CONFIGURE)
+        wm_mask |= IVI_WM_PROPERTY_SIZE;
+
+    return wm_mask;
+}
+
+static int
+is_coalescing_controller(struct wl_resource *resource)
+{
+    return wl_resource_get_version(resource) >=
+           IVI_WM_SURFACE_PROPERTIES_SINCE_VERSION;
+}
+
+static void
+send_surface_properties(struct ivisurface *ivisurf)
+{
+    const struct ivi_layout_interface *lyt = ivisurf->shell->interface;
+    const struct ivi_layout_surface_properties *prop = ivisurf->prop;
+    struct weston_surface *surface;
+    struct ivicontroller *ctrl;
+    struct notification *not;
+    uint32_t surface_id;
+    uint32_t mask, not_mask;
+    int32_t width = 0;
+    int32_t height = 0;
+
+    mask = ivisurf->pending_mask;
+    ivisurf->pending_mask = 0;
+    wl_list_remove(&ivisurf->pending_link);
+    wl_list_init(&ivisurf->pending_link);
+
+    surface = lyt->surface_get_weston_surface(ivisurf->layout_surface);
+    if (surface) {
+        width = surface->width;
+        height = surface->height;
+    }
+
+    /* same rule as send_surface_configure_event */
+    if ((width == 0) || (height == 0))
+        mask &= ~IVI_WM_PROPERTY_SIZE;
+
+    if (mask == 0)
+        return;
+
+    surface_id = lyt->get_id_of_surface(ivisurf->layout_surface);
+
+    wl_list_for_each(not, &ivisurf->notification_list, layout_link) {
+        if (!is_coalescing_controller(not->resource))
+            continue;
+
+        ctrl = wl_resource_get_user_data(not->resource);
+        not_mask = mask & (not->mask | ctrl->surface_sync_all_mask);
+        if (not_mask == 0)
+            continue;
+
+        ivi_wm_send_surface_properties(not->resource, surface_id, not_mask,
+                                       prop->visibility, prop->opacity,
+                                       prop->source_x, prop->source_y,
+                                       prop->source_width, prop->source_height,
+                                       prop->dest_x, prop->dest_y,
+                                       prop->dest_width, prop->dest_height,
+                                       width, height);
+    }
+}
+
+static void
+send_layer_properties(struct ivilayer *ivilayer)
+{
+    const struct ivi_layout_interface *lyt = ivilayer->shell->interface;
+    const struct ivi_layout_layer_properties *prop = ivilayer->prop;
+    struct ivicontroller *ctrl;
+    struct notification *not;
+    uint32_t layer_id;
+    uint32_t mask, not_mask;
+
+    mask = ivilayer->pending_mask;
+    ivilayer->pending_mask = 0;
+    wl_list_remove(&ivilayer->pending_link);
+    wl_list_init(&ivilayer->pending_link);
+
+    layer_id = lyt->get_id_of_layer(ivilayer->layout_layer);
+
+    wl_list_for_each(not, &ivilayer->notification_list, layout_link) {
+        if (!is_coalescing_controller(not->resource))
+            continue;
+
+        ctrl = wl_resource_get_user_data(not->resource);
+        not_mask = mask & (not->mask | ctrl->layer_sync_all_mask);
+        if (not_mask == 0)
+            continue;
+
+        ivi_wm_send_layer_properties(not->resource, layer_id, not_mask,
+                                     prop->visibility, prop->opacity,
+                                     prop->source_x, prop->source_y,
+                                     prop->source_width, prop->source_height,
+                                     prop->dest_x, prop->dest_y,
+                                     prop->dest_width, prop->dest_height);
+    }
+}
+
+static void
+send_scene_generation(struct ivishell *shell)
+{
+    struct ivicontroller *controller;
+
+    if (shell->scene_generation == shell->scene_generation_sent)
+        return;
+
+    shell->scene_generation_sent = shell->scene_generation;
+
+    wl_list_for_each(controller, &shell->list_controller, link) {
+        if (wl_resource_get_version(controller->resource) >=
+            IVI_WM_SCENE_GENERATION_SINCE_VERSION)
+            ivi_wm_send_scene_generation(controller->resource,
+                                         shell->scene_generation);
+    }
+}
+
+static void
+flush_pending_properties(struct ivishell *shell)
+{
+    struct ivilayer *ivilayer, *ivilayer_next;
+    struct ivisurface *ivisurf, *ivisurf_next;
+    IVI_TRACE_SCOPE(shell->trace, "send_properties");
+
+    shell->flush_on_frame = 0;
+
+    wl_list_for_each_safe(ivilayer, ivilayer_next,
+                          &shell->list_pending_layer, pending_link)
+        send_layer_properties(ivilayer);
+
+    wl_list_for_each_safe(ivisurf, ivisurf_next,
+                          &shell->list_pending_surface, pending_link)
+        send_surface_properties(ivisurf);
+
+    send_scene_generation(shell);
+}
+
+static void
+flush_pending_idle(void *data)
+{
+    struct ivishell *shell = data;
+
+    shell->flush_idle = NULL;
+
+    /* a visible change queued after the idle source waits for the frame */
+    if (!shell->flush_on_frame)
+        flush_pending_properties(shell);
+}
+
+/*
+ * Pending properties are flushed from the frame_signal of the outputs
+ * given in output_mask, which are the outputs showing the changed object.
+ * Changes which are not visible on any output do not cause a repaint, they
+ * are flushed once the current requests are dispatched.
+ */
+static void
+schedule_pending_properties(struct ivishell *shell, uint32_t output_mask)
+{
+    struct wl_event_loop *loop;
+    struct iviscreen *iviscrn;
+    int scheduled = 0;
+
+    wl_list_for_each(iviscrn, &shell->list_screen, link) {
+        if (!(output_mask & (1u << iviscrn->output->id)))
+            continue;
+
+        weston_output_schedule_repaint(iviscrn->output);
+        scheduled = 1;
+    }
+
+    if (scheduled) {
+        shell->flush_on_frame = 1;
+        return;
+    }
+
+    if (shell->flush_on_frame || shell->flush_idle)
+        return;
+
+    loop = wl_display_get_event_loop(shell->compositor->wl_display);
+    shell->flush_idle = wl_event_loop_add_idle(loop, flush_pending_idle, shell);
+    if (!shell->flush_idle)
+        flush_pending_properties(shell);
+}
+
+static void
+bump_scene_generation(struct ivishell *shell)
+{
+    shell->scene_generation++;
+
+    /* the generation alone does not change any output */
+    schedule_pending_properties(shell, 0);
+}
+
+static uint32_t
+get_surface_output_mask(struct ivisurface *ivisurf)
+{
+    const struct ivi_layout_interface *lyt = ivisurf->shell->interface;
+    struct weston_surface *surface;
+
+    surface = lyt->surface_get_weston_surface(ivisurf->layout_surface);
+    if (!surface)
+        return 0;
+
+    return surface->output_mask;
+}
+
+/* the outputs showing any surface of the layer */
+static uint32_t
+get_layer_output_mask(struct ivilayer *ivilayer)
+{
+    const struct ivi_layout_interface *lyt = ivilayer->shell->interface;
+    struct ivi_layout_surface **surfaces = NULL;
+    struct weston_surface *surface;
+    uint32_t output_mask = 0;
+    int32_t length = 0;
+    int32_t i;
+
+    if (lyt->get_surfaces_on_layer(ivilayer->layout_layer, &length,
+                                   &surfaces) != IVI_SUCCEEDED)
+        return 0;
+
+    for (i = 0; i < length; i++) {
+        surface = lyt->surface_get_weston_surface(surfaces[i]);
+        if (surface)
+            output_mask |= surface->output_mask;
+    }
+
+    free(surfaces);
+    return output_mask;
+}
+
+static void
+queue_surface_properties(struct ivisurface *ivisurf, uint32_t mask,
+                         uint32_t wanted)
+{
+    struct ivishell *shell = ivisurf->shell;
+    uint32_t wm_mask = to_wm_property_mask(mask) & wanted;
+
+    if (wm_mask == 0)
+        return;
+
+    if (ivisurf->pending_mask == 0)
+        wl_list_insert(shell->list_pending_surface.prev,
+                       &ivisurf->pending_link);
+
+    ivisurf->pending_mask |= wm_mask;
+    schedule_pending_properties(shell, get_surface_output_mask(ivisurf));
+}
+
+static void
+queue_layer_properties(struct ivilayer *ivilayer, uint32_t mask,
+                       uint32_t wanted)
+{
+    struct ivishell *shell = ivilayer->shell;
+    uint32_t wm_mask = to_wm_property_mask(mask) & wanted;
+
+    if (wm_mask == 0)
+        return;
+
+    if (ivilayer->pending_mask == 0)
+        wl_list_insert(shell->list_pending_layer.prev,
+                       &ivilayer->pending_link);
+
+    ivilayer->pending_mask |= wm_mask;
+    schedule_pending_properties(shell, get_layer_output_mask(ivilayer));
+}
+
+static const char * const lifecycle_stage_names[IVI_LIFECYCLE_STAGES] = {
+    [IVI_WM_LIFECYCLE_STAGE_FIRST_COMMIT] = "first_commit",
+    [IVI_WM_LIFECYCLE_STAGE_FIRST_CONFIGURE] = "first_configure",
+    [IVI_WM_LIFECYCLE_STAGE_FIRST_LAYER_ADD] = "first_layer_add",
+    [IVI_WM_LIFECYCLE_STAGE_FIRST_VISIBLE] = "first_visible",
+    [IVI_WM_LIFECYCLE_STAGE_FIRST_FRAME] = "first_frame",
+};
+
+static uint64_t
+get_monotonic_usec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+static void
+mark_lifecycle_stage(struct ivisurface *ivisurf,
+                     enum ivi_wm_lifecycle_stage stage)
+{
+    const struct ivi_layout_interface *lyt = ivisurf->shell->interface;
+
+    if (ivisurf->lifecycle_us[stage] != 0)
+        return;
+
+    ivisurf->lifecycle_us[stage] = get_monotonic_usec();
+    ivi_trace_event(ivisurf->shell->trace, IVI_TRACE_INSTANT,
+                    lifecycle_stage_names[stage], 0, "surface_id",
+                    lyt->get_id_of_surface(ivisurf->layout_surface));
+}
+
+static pid_t
+get_surface_pid(struct ivisurface *ivisurf)
+{
+    const struct ivi_layout_interface *lyt = ivisurf->shell->interface;
+    struct weston_surface *surface;
+    pid_t pid = 0;
+    uid_t uid;
+    gid_t gid;
+
+    surface = lyt->surface_get_weston_surface(ivisurf->layout_surface);
+    if (surface && surface->resource)
+        wl_client_get_credentials(wl_resource_get_client(surface->resource),
+                                  &pid, &uid, &gid);
+
+    return pid;
+}
+
+/* only surfaces which did not reach their first frame are checked */
+static void
+check_starting_surfaces(struct ivishell *shell, struct weston_output *output)
+{
+    const struct ivi_layout_interface *lyt = shell->interface;
+    struct ivisurface *ivisurf, *next;
+    struct weston_surface *surface;
+    int stage;
+
+    wl_list_for_each_safe(ivisurf, next, &shell->list_starting_surface,
+                          starting_link) {
+        for (stage = 0; stage < IVI_WM_LIFECYCLE_STAGE_FIRST_FRAME; stage++) {
+            if (ivisurf->lifecycle_us[stage] == 0)
+                break;
+        }
+        if (stage != IVI_WM_LIFECYCLE_STAGE_FIRST_FRAME)
+            continue;
+
+        surface = lyt->surface_get_weston_surface(ivisurf->layout_surface);
+        if (!(surface->output_mask & (1u << output->id)))
+            continue;
+
+        mark_lifecycle_stage(ivisurf, IVI_WM_LIFECYCLE_STAGE_FIRST_FRAME);
+        wl_list_remove(&ivisurf->starting_link);
+        wl_list_init(&ivisurf->starting_link);
+
+        weston_log("ivi-controller: surface %u of pid %d: first frame after "
+                   "%llu ms\n", lyt->get_id_of_surface(ivisurf->layout_surface),
+                   (int)get_surface_pid(ivisurf),
+                   (unsigned long long)
+                   ((ivisurf->lifecycle_us[IVI_WM_LIFECYCLE_STAGE_FIRST_FRAME] -
+                     ivisurf->created_us) / 1000));
+    }
+}
+
 static void
 send_surface_prop(struct wl_listener *listener, void *data)
 {
@@ -215,15 +762,33 @@ send_surface_prop(struct wl_listener *listener, void *data)
     const struct ivi_layout_interface *lyt = ivisurf->shell->interface;
     struct notification *not;
     uint32_t surface_id;
+    uint32_t wanted = 0;
 
     mask = ivisurf->prop->event_mask;
 
     surface_id = lyt->get_id_of_surface(ivisurf->layout_surface);
+    ivi_trace_event(ivisurf->shell->trace, IVI_TRACE_INSTANT,
+                    "surface_property_changed", 0, "surface_id", surface_id);
+    bump_scene_generation(ivisurf->shell);
+
+    if (mask & IVI_NOTIFICATION_ADD)
+        mark_lifecycle_stage(ivisurf, IVI_WM_LIFECYCLE_STAGE_FIRST_LAYER_ADD);
+
+    if (ivisurf->prop->visibility)
+        mark_lifecycle_stage(ivisurf, IVI_WM_LIFECYCLE_STAGE_FIRST_VISIBLE);
 
     wl_list_for_each(not, &ivisurf->notification_list, layout_link) {
         ctrl = wl_resource_get_user_data(not->resource);
+        if (is_coalescing_controller(not->resource)) {
+            wanted |= not->mask | ctrl->surface_sync_all_mask;
+            continue;
+        }
+
         send_surface_event(ctrl, ivisurf->layout_surface, surface_id, ivisurf->prop, mask);
     }
+
+    if (wanted)
+        queue_surface_properties(ivisurf, mask, wanted);
 }
 
 static void
@@ -262,15 +827,27 @@ send_layer_prop(struct wl_listener *listener, void *data)
     const struct ivi_layout_interface *lyt = ivilayer->shell->interface;
     struct notification *not;
     uint32_t layer_id;
+    uint32_t wanted = 0;
 
     mask = ivilayer->prop->event_mask;
 
     layer_id = lyt->get_id_of_layer(ivilayer->layout_layer);
+    ivi_trace_event(ivilayer->shell->trace, IVI_TRACE_INSTANT,
+                    "layer_property_changed", 0, "layer_id", layer_id);
+    bump_scene_generation(ivilayer->shell);
 
     wl_list_for_each(not, &ivilayer->notification_list, layout_link) {
         ctrl = wl_resource_get_user_data(not->resource);
+        if (is_coalescing_controller(not->resource)) {
+            wanted |= not->mask | ctrl->layer_sync_all_mask;
+            continue;
+        }
+
         send_layer_event(ctrl, ivilayer->layout_layer, layer_id, ivilayer->prop, mask);
     }
+
+    if (wanted)
+        queue_layer_properties(ivilayer, mask, wanted);
 }
 
 static void
@@ -283,6 +860,7 @@ controller_set_surface_opacity(struct wl_client *client,
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_surface *layout_surface;
+    WM_STATS_SCOPE(ctrl->shell, SET_SURFACE_OPACITY, client);
 
     layout_surface = lyt->get_surface_from_id(surface_id);
     if (!layout_surface) {
@@ -309,6 +887,7 @@ controller_set_surface_source_rectangle(struct wl_client *client,
     (void)client;
     struct ivi_layout_surface *layout_surface;
     const struct ivi_layout_surface_properties *prop;
+    WM_STATS_SCOPE(ctrl->shell, SET_SURFACE_SOURCE_RECTANGLE, client);
 
     layout_surface = lyt->get_surface_from_id(surface_id);
     if (!layout_surface) {
@@ -347,6 +926,7 @@ controller_set_surface_destination_rectangle(struct wl_client *client,
     (void)client;
     struct ivi_layout_surface *layout_surface;
     const struct ivi_layout_surface_properties *prop;
+    WM_STATS_SCOPE(ctrl->shell, SET_SURFACE_DESTINATION_RECTANGLE, client);
 
     layout_surface = lyt->get_surface_from_id(surface_id);
     if (!layout_surface) {
@@ -387,6 +967,7 @@ controller_set_surface_visibility(struct wl_client *client,
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_surface *layout_surface;
+    WM_STATS_SCOPE(ctrl->shell, SET_SURFACE_VISIBILITY, client);
 
     layout_surface = lyt->get_surface_from_id(surface_id);
     if (!layout_surface) {
@@ -460,9 +1041,11 @@ controller_surface_screenshot(struct wl_client *client,
     struct timespec stamp;
     uint32_t stamp_ms;
     int fd;
+    WM_STATS_SCOPE(ctrl->shell, SURFACE_SCREENSHOT, client);
 
     screenshot =
-        wl_resource_create(client, &ivi_screenshot_interface, 1, screenshot_id);
+        wl_resource_create(client, &ivi_screenshot_interface,
+                           wl_resource_get_version(resource), screenshot_id);
 
     if (screenshot == NULL) {
         wl_client_post_no_memory(client);
@@ -573,6 +1156,7 @@ controller_surface_sync(struct wl_client *client,
     const struct ivi_layout_surface_properties *prop;
     (void)client;
     struct notification *not;
+    WM_STATS_SCOPE(ctrl->shell, SURFACE_SYNC, client);
 
     layout_surface = lyt->get_surface_from_id(surface_id);
     if (!layout_surface) {
@@ -587,26 +1171,30 @@ controller_surface_sync(struct wl_client *client,
     switch (sync_state) {
     case IVI_WM_SYNC_ADD:
         /*Check if a notification for the surface is already initialized*/
-        not= calloc(1, sizeof *not);
+        not = find_notification(&ivisurf->notification_list, resource);
+        if (not) {
+            not->mask = IVI_WM_PROPERTY_ALL;
+            break;
+        }
+
+        not = add_notification(&ctrl->surface_notifications,
+                               &ivisurf->notification_list,
+                               resource, IVI_WM_PROPERTY_ALL);
         if (not == NULL) {
             wl_resource_post_no_memory(resource);
             return;
         }
-
-        wl_list_insert(&ctrl->surface_notifications, &not->link);
-        wl_list_insert(&ivisurf->notification_list, &not->layout_link);
-        not->resource = resource;
         break;
     case IVI_WM_SYNC_REMOVE:
-        wl_list_for_each(not, &ivisurf->notification_list, layout_link)
-        {
-            if (not->resource == resource) {
-                wl_list_remove(&not->link);
-                wl_list_remove(&not->layout_link);
-                free(not);
-                break;
-            }
-        }
+        not = find_notification(&ivisurf->notification_list, resource);
+        if (not == NULL)
+            break;
+
+        /* keep the entry while surface_sync_all covers the surface */
+        if (ctrl->surface_sync_all_mask)
+            not->mask = 0;
+        else
+            remove_notification(not);
         break;
     default:
         ivi_wm_send_surface_error(resource, surface_id,
@@ -624,6 +1212,7 @@ controller_set_surface_type(struct wl_client *client, struct wl_resource *resour
     (void)client;
     struct ivi_layout_surface *layout_surface;
     struct ivisurface *ivisurf;
+    WM_STATS_SCOPE(ctrl->shell, SET_SURFACE_TYPE, client);
 
     layout_surface = lyt->get_surface_from_id(surface_id);
     if (!layout_surface) {
@@ -668,6 +1257,7 @@ controller_surface_get(struct wl_client *client, struct wl_resource *resource,
     struct ivisurface *ivisurf;
     enum ivi_layout_notification_mask mask;
     const struct ivi_layout_surface_properties *prop;
+    WM_STATS_SCOPE(ctrl->shell, SURFACE_GET, client);
 
     mask = convert_protocol_enum(param);
 
@@ -699,6 +1289,7 @@ controller_set_layer_source_rectangle(struct wl_client *client,
     (void)client;
     struct ivi_layout_layer *layout_layer;
     const struct ivi_layout_layer_properties *prop;
+    WM_STATS_SCOPE(ctrl->shell, SET_LAYER_SOURCE_RECTANGLE, client);
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -737,6 +1328,7 @@ controller_set_layer_destination_rectangle(struct wl_client *client,
     (void)client;
     struct ivi_layout_layer *layout_layer;
     const struct ivi_layout_layer_properties *prop;
+    WM_STATS_SCOPE(ctrl->shell, SET_LAYER_DESTINATION_RECTANGLE, client);
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -771,6 +1363,7 @@ controller_set_layer_visibility(struct wl_client *client,
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_layer *layout_layer;
+    WM_STATS_SCOPE(ctrl->shell, SET_LAYER_VISIBILITY, client);
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -793,6 +1386,7 @@ controller_set_layer_opacity(struct wl_client *client,
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_layer *layout_layer;
+    WM_STATS_SCOPE(ctrl->shell, SET_LAYER_OPACITY, client);
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -814,6 +1408,7 @@ controller_layer_clear(struct wl_client *client,
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_layer *layout_layer;
+    WM_STATS_SCOPE(ctrl->shell, LAYER_CLEAR, client);
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -926,6 +1521,7 @@ controller_layer_add_surface(struct wl_client *client,
     (void)client;
     struct ivi_layout_layer *layout_layer;
     struct ivi_layout_surface *layout_surface;
+    WM_STATS_SCOPE(ctrl->shell, LAYER_ADD_SURFACE, client);
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -957,6 +1553,7 @@ controller_layer_remove_surface(struct wl_client *client,
     (void)client;
     struct ivi_layout_layer *layout_layer;
     struct ivi_layout_surface *layout_surface;
+    WM_STATS_SCOPE(ctrl->shell, LAYER_REMOVE_SURFACE, client);
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -990,6 +1587,7 @@ controller_layer_sync(struct wl_client *client,
     const struct ivi_layout_layer_properties *prop;
     (void)client;
     struct notification *not;
+    WM_STATS_SCOPE(ctrl->shell, LAYER_SYNC, client);
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -1003,29 +1601,31 @@ controller_layer_sync(struct wl_client *client,
 
     switch (sync_state) {
     case IVI_WM_SYNC_ADD:
-        /*Check if a notification for the surface is already initialized*/
-        not= calloc(1, sizeof *not);
+        /*Check if a notification for the layer is already initialized*/
+        not = find_notification(&ivilayer->notification_list, resource);
+        if (not) {
+            not->mask = IVI_WM_PROPERTY_ALL;
+            break;
+        }
+
+        not = add_notification(&ctrl->layer_notifications,
+                               &ivilayer->notification_list,
+                               resource, IVI_WM_PROPERTY_ALL);
         if (not == NULL) {
             wl_resource_post_no_memory(resource);
             return;
         }
-
-        wl_list_insert(&ctrl->layer_notifications, &not->link);
-        wl_list_insert(&ivilayer->notification_list, &not->layout_link);
-        not->resource = resource;
         break;
     case IVI_WM_SYNC_REMOVE:
-        ivilayer = get_layer(&ctrl->shell->list_layer, layout_layer);
+        not = find_notification(&ivilayer->notification_list, resource);
+        if (not == NULL)
+            break;
 
-        wl_list_for_each(not, &ivilayer->notification_list, layout_link)
-        {
-            if (not->resource == resource) {
-                wl_list_remove(&not->link);
-                wl_list_remove(&not->layout_link);
-                free(not);
-                break;
-            }
-        }
+        /* keep the entry while layer_sync_all covers the layer */
+        if (ctrl->layer_sync_all_mask)
+            not->mask = 0;
+        else
+            remove_notification(not);
         break;
     default:
         ivi_wm_send_layer_error(resource, layer_id,
@@ -1036,13 +1636,188 @@ controller_layer_sync(struct wl_client *client,
 }
 
 static void
-controller_create_layout_layer(struct wl_client *client,
+controller_surface_sync_mask(struct wl_client *client,
+                             struct wl_resource *resource,
+                             uint32_t surface_id,
+                             uint32_t mask)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    const struct ivi_layout_interface *lyt = ctrl->shell->interface;
+    struct ivi_layout_surface *layout_surface;
+    struct ivisurface *ivisurf;
+    struct notification *not;
+    (void)client;
+    WM_STATS_SCOPE(ctrl->shell, SURFACE_SYNC_MASK, client);
+
+    layout_surface = lyt->get_surface_from_id(surface_id);
+    if (!layout_surface) {
+        ivi_wm_send_surface_error(resource, surface_id,
+                                  IVI_WM_SURFACE_ERROR_NO_SURFACE,
+                                  "surface_sync_mask: the surface with given id does not exist");
+        return;
+    }
+
+    ivisurf = get_surface(&ctrl->shell->list_surface, layout_surface);
+    if (!ivisurf) {
+        ivi_wm_send_surface_error(resource, surface_id,
+                                  IVI_WM_SURFACE_ERROR_NOT_SUPPORTED,
+                                  "surface_sync_mask: the surface can not be synchronized");
+        return;
+    }
+
+    mask &= IVI_WM_PROPERTY_ALL;
+    not = find_notification(&ivisurf->notification_list, resource);
+
+    if (mask == 0) {
+        if (not && !ctrl->surface_sync_all_mask)
+            remove_notification(not);
+        else if (not)
+            not->mask = 0;
+        return;
+    }
+
+    if (not) {
+        not->mask = mask;
+        return;
+    }
+
+    if (!add_notification(&ctrl->surface_notifications,
+                          &ivisurf->notification_list, resource, mask))
+        wl_resource_post_no_memory(resource);
+}
+
+static void
+controller_layer_sync_mask(struct wl_client *client,
+                           struct wl_resource *resource,
+                           uint32_t layer_id,
+                           uint32_t mask)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    const struct ivi_layout_interface *lyt = ctrl->shell->interface;
+    struct ivi_layout_layer *layout_layer;
+    struct ivilayer *ivilayer;
+    struct notification *not;
+    (void)client;
+    WM_STATS_SCOPE(ctrl->shell, LAYER_SYNC_MASK, client);
+
+    layout_layer = lyt->get_layer_from_id(layer_id);
+    if (!layout_layer) {
+        ivi_wm_send_layer_error(resource, layer_id,
+                                IVI_WM_LAYER_ERROR_NO_LAYER,
+                                "layer_sync_mask: the layer with given id does not exist");
+        return;
+    }
+
+    ivilayer = get_layer(&ctrl->shell->list_layer, layout_layer);
+    if (!ivilayer) {
+        ivi_wm_send_layer_error(resource, layer_id,
+                                IVI_WM_LAYER_ERROR_NO_LAYER,
+                                "layer_sync_mask: the layer is being removed");
+        return;
+    }
+
+    mask &= IVI_WM_PROPERTY_ALL;
+    not = find_notification(&ivilayer->notification_list, resource);
+
+    if (mask == 0) {
+        if (not && !ctrl->layer_sync_all_mask)
+            remove_notification(not);
+        else if (not)
+            not->mask = 0;
+        return;
+    }
+
+    if (not) {
+        not->mask = mask;
+        return;
+    }
+
+    if (!add_notification(&ctrl->layer_notifications,
+                          &ivilayer->notification_list, resource, mask))
+        wl_resource_post_no_memory(resource);
+}
+
+static void
+controller_surface_sync_all(struct wl_client *client,
+                            struct wl_resource *resource,
+                            uint32_t mask)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivisurface *ivisurf;
+    struct notification *not;
+    (void)client;
+    WM_STATS_SCOPE(ctrl->shell, SURFACE_SYNC_ALL, client);
+
+    ctrl->surface_sync_all_mask = mask & IVI_WM_PROPERTY_ALL;
+
+    /*
+     * Every surface gets a notification entry, so the property listeners
+     * need no special handling for wildcard subscriptions. Entries with
+     * a mask of 0 only exist on behalf of surface_sync_all.
+     */
+    wl_list_for_each(ivisurf, &ctrl->shell->list_surface, link) {
+        not = find_notification(&ivisurf->notification_list, resource);
+
+        if (ctrl->surface_sync_all_mask == 0) {
+            if (not && not->mask == 0)
+                remove_notification(not);
+            continue;
+        }
+
+        if (not)
+            continue;
+
+        if (!add_notification(&ctrl->surface_notifications,
+                              &ivisurf->notification_list, resource, 0)) {
+            wl_resource_post_no_memory(resource);
+            return;
+        }
+    }
+}
+
+static void
+controller_layer_sync_all(struct wl_client *client,
+                          struct wl_resource *resource,
+                          uint32_t mask)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivilayer *ivilayer;
+    struct notification *not;
+    (void)client;
+    WM_STATS_SCOPE(ctrl->shell, LAYER_SYNC_ALL, client);
+
+    ctrl->layer_sync_all_mask = mask & IVI_WM_PROPERTY_ALL;
+
+    /* see controller_surface_sync_all */
+    wl_list_for_each(ivilayer, &ctrl->shell->list_layer, link) {
+        not = find_notification(&ivilayer->notification_list, resource);
+
+        if (ctrl->layer_sync_all_mask == 0) {
+            if (not && not->mask == 0)
+                remove_notification(not);
+            continue;
+        }
+
+        if (not)
+            continue;
+
+        if (!add_notification(&ctrl->layer_notifications,
+                              &ivilayer->notification_list, resource, 0)) {
+            wl_resource_post_no_memory(resource);
+            return;
+        }
+    }
+}
+
+static void
+controller_create_layout_layer(struct wl_client *client,
                     struct wl_resource *resource, uint32_t layer_id,
                     int width, int height)
 {
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
+    WM_STATS_SCOPE(ctrl->shell, CREATE_LAYOUT_LAYER, client);
 
      if(lyt->layer_create_with_dimension(layer_id, width, height) == NULL) {
          wl_resource_post_no_memory(resource);
@@ -1057,6 +1832,7 @@ controller_destroy_layout_layer(struct wl_client *client,
     const struct ivi_layout_interface *lyt = ctrl->shell->interface;
     (void)client;
     struct ivi_layout_layer *layout_layer;
+    WM_STATS_SCOPE(ctrl->shell, DESTROY_LAYOUT_LAYER, client);
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -1082,6 +1858,7 @@ controller_layer_get(struct wl_client *client, struct wl_resource *resource,
     struct ivi_layout_surface **surf_list = NULL;
     int32_t surface_count, i;
     uint32_t id;
+    WM_STATS_SCOPE(ctrl->shell, LAYER_GET, client);
 
     layout_layer = lyt->get_layer_from_id(layer_id);
     if (!layout_layer) {
@@ -1110,7 +1887,9 @@ static void
 controller_screen_destroy(struct wl_client *client,
                           struct wl_resource *resource)
 {
-    (void)client;
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    SCREEN_STATS_SCOPE(iviscrn, DESTROY, client);
+
     wl_resource_destroy(resource);
 }
 
@@ -1121,6 +1900,7 @@ controller_screen_clear(struct wl_client *client,
     struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
     const struct ivi_layout_interface *lyt;
     (void)client;
+    SCREEN_STATS_SCOPE(iviscrn, CLEAR, client);
 
     if (!iviscrn) {
         ivi_wm_screen_send_error(resource, IVI_WM_SCREEN_ERROR_NO_SCREEN,
@@ -1130,6 +1910,7 @@ controller_screen_clear(struct wl_client *client,
 
     lyt = iviscrn->shell->interface;
     lyt->screen_set_render_order(iviscrn->output, NULL, 0);
+    iviscrn->shell->render_order_pending = 1;
 }
 
 static void
@@ -1141,6 +1922,7 @@ controller_screen_add_layer(struct wl_client *client,
     const struct ivi_layout_interface *lyt;
     (void)client;
     struct ivi_layout_layer *layout_layer;
+    SCREEN_STATS_SCOPE(iviscrn, ADD_LAYER, client);
 
     if (!iviscrn) {
         ivi_wm_screen_send_error(resource, IVI_WM_SCREEN_ERROR_NO_SCREEN,
@@ -1158,6 +1940,7 @@ controller_screen_add_layer(struct wl_client *client,
     }
 
     lyt->screen_add_layer(iviscrn->output, layout_layer);
+    iviscrn->shell->render_order_pending = 1;
 }
 
 static void
@@ -1169,6 +1952,7 @@ controller_screen_remove_layer(struct wl_client *client,
     const struct ivi_layout_interface *lyt;
     (void)client;
     struct ivi_layout_layer *layout_layer;
+    SCREEN_STATS_SCOPE(iviscrn, REMOVE_LAYER, client);
 
     if (!iviscrn) {
         ivi_wm_screen_send_error(resource, IVI_WM_SCREEN_ERROR_NO_SCREEN,
@@ -1186,6 +1970,7 @@ controller_screen_remove_layer(struct wl_client *client,
     }
 
     lyt->screen_remove_layer(iviscrn->output, layout_layer);
+    iviscrn->shell->render_order_pending = 1;
 }
 
 static void
@@ -1305,7 +2090,7 @@ screenshot_frame_listener_destroy(struct wl_resource *resource)
 
     wl_list_remove(&l->frame_listener.link);
     wl_list_remove(&l->output_destroyed.link);
-    free(l);
+    ivi_pool_free(&screenshot_pool, l);
 }
 
 static void
@@ -1316,19 +2101,21 @@ controller_screen_screenshot(struct wl_client *client,
     struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
     struct screenshot_frame_listener *l;
     (void)client;
+    SCREEN_STATS_SCOPE(iviscrn, SCREENSHOT, client);
 
-    l = malloc(sizeof *l);
+    l = ivi_pool_zalloc(&screenshot_pool);
     if(l == NULL) {
         wl_resource_post_no_memory(resource);
         return;
     }
 
     l->screenshot =
-        wl_resource_create(client, &ivi_screenshot_interface, 1, id);
+        wl_resource_create(client, &ivi_screenshot_interface,
+                           wl_resource_get_version(resource), id);
 
     if (l->screenshot == NULL) {
         wl_resource_post_no_memory(resource);
-        free(l);
+        ivi_pool_free(&screenshot_pool, l);
         return;
     }
 
@@ -1336,7 +2123,7 @@ controller_screen_screenshot(struct wl_client *client,
         ivi_screenshot_send_error(l->screenshot, IVI_SCREENSHOT_ERROR_NO_OUTPUT,
                                   "the output is already destroyed");
         wl_resource_destroy(l->screenshot);
-        free(l);
+        ivi_pool_free(&screenshot_pool, l);
         return;
     }
 
@@ -1362,6 +2149,7 @@ controller_screen_get(struct wl_client *client,
     struct ivi_layout_layer **layer_list = NULL;
     int32_t layer_count, i;
     uint32_t id;
+    SCREEN_STATS_SCOPE(iviscrn, GET, client);
 
     lyt = iviscrn->shell->interface;
 
@@ -1383,6 +2171,71 @@ controller_screen_get(struct wl_client *client,
     }
 }
 
+static void
+controller_screen_get_stats(struct wl_client *client,
+                            struct wl_resource *resource)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct ivi_stats_request *repaint;
+    struct wl_array repaint_histogram;
+    struct wl_array interval_histogram;
+    int32_t refresh = 0;
+    uint64_t total_us;
+    double views_mean = 0.0;
+    SCREEN_STATS_SCOPE(iviscrn, GET_STATS, client);
+
+    if (!iviscrn) {
+        ivi_wm_screen_send_error(resource, IVI_WM_SCREEN_ERROR_NO_SCREEN,
+                                 "the output is already destroyed");
+        return;
+    }
+
+    repaint = &iviscrn->repaint_stats;
+    if (iviscrn->output->current_mode)
+        refresh = iviscrn->output->current_mode->refresh;
+    if (repaint->count)
+        views_mean = (double)iviscrn->views_total / repaint->count;
+
+    /* borrow the counters, they are copied by the marshaller */
+    repaint_histogram.size = sizeof repaint->histogram;
+    repaint_histogram.alloc = 0;
+    repaint_histogram.data = repaint->histogram;
+    interval_histogram.size = sizeof iviscrn->interval_histogram;
+    interval_histogram.alloc = 0;
+    interval_histogram.data = iviscrn->interval_histogram;
+
+    total_us = repaint->total_ns / 1000;
+    ivi_wm_screen_send_stats(resource, (uint32_t)repaint->count, refresh,
+                             (uint32_t)(total_us >> 32), (uint32_t)total_us,
+                             (uint32_t)(repaint->max_ns / 1000),
+                             &repaint_histogram, &interval_histogram,
+                             iviscrn->missed_vblanks, iviscrn->over_budget,
+                             wl_fixed_from_double(views_mean),
+                             iviscrn->views_max);
+}
+
+static void
+controller_screen_get_coverage(struct wl_client *client,
+                               struct wl_resource *resource)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct surface_coverage *coverage;
+    SCREEN_STATS_SCOPE(iviscrn, GET_COVERAGE, client);
+
+    if (!iviscrn) {
+        ivi_wm_screen_send_error(resource, IVI_WM_SCREEN_ERROR_NO_SCREEN,
+                                 "the output is already destroyed");
+        return;
+    }
+
+    /* one event per surface, an array could exceed the message size */
+    wl_array_for_each(coverage, &iviscrn->coverage) {
+        ivi_wm_screen_send_coverage(resource, coverage->surface_id,
+                                    coverage->area, coverage->visible_area);
+    }
+    ivi_wm_screen_send_coverage_done(resource);
+}
+
 static const
 struct ivi_wm_screen_interface controller_screen_implementation = {
     controller_screen_destroy,
@@ -1390,9 +2243,27 @@ struct ivi_wm_screen_interface controller_screen_implementation = {
     controller_screen_add_layer,
     controller_screen_remove_layer,
     controller_screen_screenshot,
-    controller_screen_get
+    controller_screen_get,
+    controller_screen_get_stats,
+    controller_screen_get_coverage
 };
 
+static void
+trace_commit_flow(struct ivishell *shell, uint64_t flow_id)
+{
+    uint64_t *pending;
+
+    ivi_trace_event(shell->trace, IVI_TRACE_FLOW_STEP, TRACE_COMMIT_FLOW,
+                    flow_id, NULL, 0);
+    ivi_trace_event(shell->trace, IVI_TRACE_INSTANT, "scene_generation", 0,
+                    "generation", shell->scene_generation);
+
+    /* ended by the next frame, see screen_frame_notify */
+    pending = wl_array_add(&shell->trace_flows, sizeof *pending);
+    if (pending)
+        *pending = flow_id;
+}
+
 static void
 controller_commit_changes(struct wl_client *client,
                           struct wl_resource *resource)
@@ -1400,11 +2271,28 @@ controller_commit_changes(struct wl_client *client,
     int32_t ans = 0;
     (void)client;
     struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    struct ivishell *shell = controller->shell;
+    WM_STATS_SCOPE(controller->shell, COMMIT_CHANGES, client);
 
-    ans = controller->shell->interface->commit_changes();
+    ans = shell->interface->commit_changes();
     if (ans < 0) {
         weston_log("Failed to commit changes at controller_commit_changes\n");
     }
+
+    /* screen render orders have no property listener in ivi-layout */
+    if (shell->render_order_pending) {
+        shell->render_order_pending = 0;
+        bump_scene_generation(shell);
+    }
+
+    if (controller->trace_flow != 0) {
+        trace_commit_flow(shell, controller->trace_flow);
+        controller->trace_flow = 0;
+    }
+
+    /* acknowledge the commit with the resulting generation */
+    if (wl_resource_get_version(resource) >= IVI_WM_SCENE_GENERATION_SINCE_VERSION)
+        ivi_wm_send_scene_generation(resource, shell->scene_generation);
 }
 
 static void
@@ -1418,6 +2306,7 @@ controller_create_screen(struct wl_client *client,
     struct wl_resource *screen_resource;
     struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
     struct iviscreen* iviscrn = NULL;
+    WM_STATS_SCOPE(ctrl->shell, CREATE_SCREEN, client);
 
 
     wl_list_for_each(iviscrn, &ctrl->shell->list_screen, link) {
@@ -1425,7 +2314,8 @@ controller_create_screen(struct wl_client *client,
             continue;
         }
 
-        screen_resource = wl_resource_create(client, &ivi_wm_screen_interface, 1, id);
+        screen_resource = wl_resource_create(client, &ivi_wm_screen_interface,
+                                             wl_resource_get_version(resource), id);
         if (screen_resource == NULL) {
             wl_resource_post_no_memory(resource);
             return;
@@ -1442,6 +2332,105 @@ controller_create_screen(struct wl_client *client,
     }
 }
 
+static void
+send_request_stats(struct wl_resource *resource,
+                   struct ivi_stats_table *table)
+{
+    struct ivi_stats_request *request;
+    struct wl_array histogram;
+    uint64_t total_us;
+    uint32_t i;
+
+    for (i = 0; i < table->request_count; i++) {
+        request = &table->requests[i];
+        if (request->count == 0)
+            continue;
+
+        /* borrow the counters, they are copied by the marshaller */
+        histogram.size = sizeof request->histogram;
+        histogram.alloc = 0;
+        histogram.data = request->histogram;
+
+        total_us = request->total_ns / 1000;
+        ivi_wm_send_request_stats(resource, table->interface, request->name,
+                                  (uint32_t)request->count,
+                                  (uint32_t)(total_us >> 32),
+                                  (uint32_t)total_us,
+                                  (uint32_t)(request->max_ns / 1000),
+                                  &histogram);
+    }
+}
+
+static void
+controller_get_stats(struct wl_client *client,
+                     struct wl_resource *resource)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivi_stats *stats = &ctrl->shell->stats;
+    struct ivi_stats_table *table;
+    struct ivi_stats_client *stats_client;
+    WM_STATS_SCOPE(ctrl->shell, GET_STATS, client);
+
+    wl_list_for_each(table, &stats->tables, link)
+        send_request_stats(resource, table);
+
+    wl_list_for_each(stats_client, &stats->clients, link) {
+        ivi_wm_send_client_stats(resource, stats_client->pid,
+                                 (uint32_t)stats_client->requests);
+    }
+}
+
+static void
+controller_trace_flow(struct wl_client *client,
+                      struct wl_resource *resource,
+                      uint32_t flow_id_hi,
+                      uint32_t flow_id_lo)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    WM_STATS_SCOPE(ctrl->shell, TRACE_FLOW, client);
+
+    if (ctrl->shell->trace)
+        ctrl->trace_flow = ((uint64_t)flow_id_hi << 32) | flow_id_lo;
+}
+
+static void
+controller_get_surface_lifecycle(struct wl_client *client,
+                                 struct wl_resource *resource)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivishell *shell = ctrl->shell;
+    const struct ivi_layout_interface *lyt = shell->interface;
+    struct ivisurface *ivisurf;
+    uint32_t stages[IVI_LIFECYCLE_STAGES];
+    struct wl_array array;
+    uint64_t us;
+    int i;
+    WM_STATS_SCOPE(shell, GET_SURFACE_LIFECYCLE, client);
+
+    array.size = sizeof stages;
+    array.alloc = 0;
+    array.data = stages;
+
+    wl_list_for_each(ivisurf, &shell->list_surface, link) {
+        for (i = 0; i < IVI_LIFECYCLE_STAGES; i++) {
+            us = ivisurf->lifecycle_us[i];
+            if (us == 0)
+                stages[i] = UINT32_MAX;
+            else if (us - ivisurf->created_us >= UINT32_MAX)
+                stages[i] = UINT32_MAX - 1;
+            else
+                stages[i] = (uint32_t)(us - ivisurf->created_us);
+        }
+
+        ivi_wm_send_surface_lifecycle(resource,
+                lyt->get_id_of_surface(ivisurf->layout_surface),
+                get_surface_pid(ivisurf),
+                (uint32_t)(ivisurf->created_us >> 32),
+                (uint32_t)ivisurf->created_us,
+                &array);
+    }
+}
+
 static const struct ivi_wm_interface controller_implementation = {
     controller_commit_changes,
     controller_create_screen,
@@ -1463,7 +2452,14 @@ static const struct ivi_wm_interface controller_implementation = {
     controller_layer_add_surface,
     controller_layer_remove_surface,
     controller_create_layout_layer,
-    controller_destroy_layout_layer
+    controller_destroy_layout_layer,
+    controller_surface_sync_mask,
+    controller_layer_sync_mask,
+    controller_surface_sync_all,
+    controller_layer_sync_all,
+    controller_get_stats,
+    controller_trace_flow,
+    controller_get_surface_lifecycle
 };
 
 static void
@@ -1472,7 +2468,6 @@ bind_ivi_controller(struct wl_client *client, void *data,
 {
     struct ivishell *shell = data;
     struct ivicontroller *controller;
-    (void)version;
     uint32_t surface_id, layer_id;
     struct ivisurface *ivisurf;
     struct ivilayer *ivilayer;
@@ -1484,7 +2479,7 @@ bind_ivi_controller(struct wl_client *client, void *data,
     }
 
     controller->resource =
-        wl_resource_create(client, &ivi_wm_interface, 1, id);
+        wl_resource_create(client, &ivi_wm_interface, version, id);
     if (controller->resource == NULL) {
         wl_client_post_no_memory(client);
         free(controller);
@@ -1512,6 +2507,589 @@ bind_ivi_controller(struct wl_client *client, void *data,
         layer_id = shell->interface->get_id_of_layer(ivilayer->layout_layer);
         ivi_wm_send_layer_created(controller->resource, layer_id);
     }
+
+    if (version >= IVI_WM_SCENE_GENERATION_SINCE_VERSION)
+        ivi_wm_send_scene_generation(controller->resource,
+                                     shell->scene_generation);
+}
+
+static void
+surface_committed(struct wl_listener *listener, void *data);
+
+static uint32_t
+get_stall_timeout(struct ivisurface *ivisurf)
+{
+    struct ivishell *shell = ivisurf->shell;
+
+    if (ivisurf->type == IVI_WM_SURFACE_TYPE_DESKTOP)
+        return shell->stall_timeout_desktop;
+
+    return shell->stall_timeout_restricted;
+}
+
+static void
+send_surface_stall(struct ivisurface *ivisurf, int stalled, uint32_t ms)
+{
+    const struct ivi_layout_interface *lyt = ivisurf->shell->interface;
+    struct ivicontroller *ctrl;
+    struct notification *not;
+    uint32_t surface_id;
+
+    surface_id = lyt->get_id_of_surface(ivisurf->layout_surface);
+    weston_log("ivi-controller: surface %u of pid %d %s after %u ms\n",
+               surface_id, (int)get_surface_pid(ivisurf),
+               stalled ? "stalled" : "recovered", ms);
+    ivi_trace_event(ivisurf->shell->trace, IVI_TRACE_INSTANT,
+                    stalled ? "surface_stalled" : "surface_recovered", 0,
+                    "surface_id", surface_id);
+
+    wl_list_for_each(not, &ivisurf->notification_list, layout_link) {
+        if (wl_resource_get_version(not->resource) <
+            IVI_WM_SURFACE_STALLED_SINCE_VERSION)
+            continue;
+
+        ctrl = wl_resource_get_user_data(not->resource);
+        if (!((not->mask | ctrl->surface_sync_all_mask) &
+              IVI_WM_PROPERTY_STALL))
+            continue;
+
+        if (stalled)
+            ivi_wm_send_surface_stalled(not->resource, surface_id, ms);
+        else
+            ivi_wm_send_surface_recovered(not->resource, surface_id, ms);
+    }
+}
+
+static void
+schedule_stall_check(struct ivishell *shell, uint64_t check_us,
+                     uint64_t now_us)
+{
+    if (shell->stall_check_us != 0 && shell->stall_check_us <= check_us)
+        return;
+
+    /* rounded up, the timer must not expire before the deadline */
+    shell->stall_check_us = check_us;
+    wl_event_source_timer_update(shell->stall_timer,
+                                 (int)((check_us - now_us + 999) / 1000));
+}
+
+static void
+check_stalled_surface(struct ivisurface *ivisurf, uint64_t now_us,
+                      int repainted)
+{
+    uint64_t timeout_us = (uint64_t)get_stall_timeout(ivisurf) * 1000;
+
+    /* the type of the surface may have changed since its commit */
+    if (timeout_us == 0) {
+        wl_list_remove(&ivisurf->stall_link);
+        wl_list_init(&ivisurf->stall_link);
+        return;
+    }
+
+    /* the frame callbacks of occluded surfaces may be held back */
+    if (ivisurf->occluded) {
+        ivisurf->frame_sent_us = 0;
+        return;
+    }
+
+    /* the frame callback is sent by the first repaint after the commit */
+    if (ivisurf->frame_sent_us == 0) {
+        if (!repainted)
+            return;
+        ivisurf->frame_sent_us = now_us;
+    }
+
+    if (now_us - ivisurf->frame_sent_us < timeout_us) {
+        schedule_stall_check(ivisurf->shell,
+                             ivisurf->frame_sent_us + timeout_us, now_us);
+        return;
+    }
+
+    ivisurf->stalled = 1;
+    wl_list_remove(&ivisurf->stall_link);
+    wl_list_init(&ivisurf->stall_link);
+    send_surface_stall(ivisurf, 1,
+                       (uint32_t)((now_us - ivisurf->last_commit_us) / 1000));
+}
+
+/* only the candidates which are shown on the output are checked, so the
+ * check costs nothing while the clients keep up */
+static void
+check_stalled_surfaces(struct ivishell *shell, struct weston_output *output,
+                       int repainted)
+{
+    const struct ivi_layout_interface *lyt = shell->interface;
+    struct ivisurface *ivisurf, *next;
+    struct weston_surface *surface;
+    uint64_t now_us = get_monotonic_usec();
+
+    wl_list_for_each_safe(ivisurf, next, &shell->list_stall_candidate,
+                          stall_link) {
+        surface = lyt->surface_get_weston_surface(ivisurf->layout_surface);
+        if (!(surface->output_mask & (1u << output->id)))
+            continue;
+
+        check_stalled_surface(ivisurf, now_us, repainted);
+    }
+}
+
+/* nothing is repainted while the only animated surface is stalled */
+static int
+stall_timer_expired(void *data)
+{
+    struct ivishell *shell = data;
+    struct iviscreen *iviscrn;
+
+    shell->stall_check_us = 0;
+    wl_list_for_each(iviscrn, &shell->list_screen, link)
+        check_stalled_surfaces(shell, iviscrn->output, 0);
+
+    return 0;
+}
+
+static void
+surface_commit_watchdog(struct ivisurface *ivisurf,
+                        struct weston_surface *surface)
+{
+    uint64_t now_us = get_monotonic_usec();
+
+    if (ivisurf->stalled) {
+        ivisurf->stalled = 0;
+        send_surface_stall(ivisurf, 0,
+                (uint32_t)((now_us - ivisurf->last_commit_us) / 1000));
+    }
+
+    ivisurf->last_commit_us = now_us;
+    ivisurf->frame_sent_us = 0;
+
+    /* clients which did not ask for a frame are not expected to draw */
+    wl_list_remove(&ivisurf->stall_link);
+    wl_list_init(&ivisurf->stall_link);
+    if (!wl_list_empty(&surface->frame_callback_list))
+        wl_list_insert(&ivisurf->shell->list_stall_candidate,
+                       &ivisurf->stall_link);
+}
+
+static void
+send_surface_occlusion(struct ivisurface *ivisurf)
+{
+    const struct ivi_layout_interface *lyt = ivisurf->shell->interface;
+    struct ivicontroller *ctrl;
+    struct notification *not;
+    uint32_t surface_id;
+
+    surface_id = lyt->get_id_of_surface(ivisurf->layout_surface);
+    ivi_trace_event(ivisurf->shell->trace, IVI_TRACE_INSTANT,
+                    ivisurf->occluded ? "surface_occluded" : "surface_revealed",
+                    0, "surface_id", surface_id);
+
+    wl_list_for_each(not, &ivisurf->notification_list, layout_link) {
+        if (wl_resource_get_version(not->resource) <
+            IVI_WM_SURFACE_OCCLUDED_SINCE_VERSION)
+            continue;
+
+        ctrl = wl_resource_get_user_data(not->resource);
+        if (!((not->mask | ctrl->surface_sync_all_mask) &
+              IVI_WM_PROPERTY_OCCLUSION))
+            continue;
+
+        ivi_wm_send_surface_occluded(not->resource, surface_id,
+                                     ivisurf->occluded);
+    }
+}
+
+#ifdef HAVE_WESTON_FRAME_CALLBACK
+/*
+ * The only code which moves or answers the entries of
+ * weston_surface::frame_callback_list. They are internal to libweston,
+ * struct weston_frame_callback in the versions which set
+ * HAVE_WESTON_FRAME_CALLBACK.
+ */
+static int
+hold_frame_callbacks(struct ivisurface *ivisurf, struct weston_surface *surface)
+{
+    if (wl_list_empty(&surface->frame_callback_list))
+        return 0;
+
+    wl_list_insert_list(ivisurf->throttled_callbacks.prev,
+                        &surface->frame_callback_list);
+    wl_list_init(&surface->frame_callback_list);
+    return 1;
+}
+
+/* weston answers them once the surface is composited again */
+static void
+return_frame_callbacks(struct ivisurface *ivisurf,
+                       struct weston_surface *surface)
+{
+    wl_list_insert_list(&surface->frame_callback_list,
+                        &ivisurf->throttled_callbacks);
+    wl_list_init(&ivisurf->throttled_callbacks);
+}
+
+/* done is not sent to callbacks of surfaces which are destroyed */
+static void
+finish_frame_callbacks(struct ivisurface *ivisurf, int send_done,
+                       uint32_t msecs)
+{
+    struct weston_frame_callback *cb, *next;
+
+    wl_list_for_each_safe(cb, next, &ivisurf->throttled_callbacks, link) {
+        if (send_done)
+            wl_callback_send_done(cb->resource, msecs);
+        wl_resource_destroy(cb->resource);
+    }
+}
+#else
+/* frame callbacks are never held, see occluded-frame-interval */
+static int
+hold_frame_callbacks(struct ivisurface *ivisurf, struct weston_surface *surface)
+{
+    (void)ivisurf;
+    (void)surface;
+    return 0;
+}
+
+static void
+return_frame_callbacks(struct ivisurface *ivisurf,
+                       struct weston_surface *surface)
+{
+    (void)ivisurf;
+    (void)surface;
+}
+
+static void
+finish_frame_callbacks(struct ivisurface *ivisurf, int send_done,
+                       uint32_t msecs)
+{
+    (void)ivisurf;
+    (void)send_done;
+    (void)msecs;
+}
+#endif
+
+static void
+release_throttled_callbacks(struct ivisurface *ivisurf, uint32_t msecs)
+{
+    finish_frame_callbacks(ivisurf, 1, msecs);
+}
+
+/* the time weston passes to the frame callbacks it sends on the output */
+static uint32_t
+get_surface_frame_time(struct ivisurface *ivisurf)
+{
+    struct iviscreen *iviscrn;
+
+    wl_list_for_each(iviscrn, &ivisurf->shell->list_screen, link) {
+        if (ivisurf->view_outputs & (1u << iviscrn->output->id))
+            return iviscrn->output->frame_time;
+    }
+
+    return 0;
+}
+
+static int
+throttle_timer_expired(void *data)
+{
+    struct ivishell *shell = data;
+    struct ivisurface *ivisurf;
+
+    shell->throttle_armed = 0;
+    wl_list_for_each(ivisurf, &shell->list_surface, link) {
+        if (!wl_list_empty(&ivisurf->throttled_callbacks))
+            release_throttled_callbacks(ivisurf,
+                                        get_surface_frame_time(ivisurf));
+    }
+
+    return 0;
+}
+
+/* the callbacks are answered by the timer instead of the next repaint,
+ * only for surfaces with a view, weston never answers the others */
+static void
+throttle_frame_callbacks(struct ivisurface *ivisurf,
+                         struct weston_surface *surface)
+{
+    struct ivishell *shell = ivisurf->shell;
+
+    if (!hold_frame_callbacks(ivisurf, surface))
+        return;
+
+    if (!shell->throttle_armed) {
+        shell->throttle_armed = 1;
+        wl_event_source_timer_update(shell->throttle_timer,
+                                     shell->occluded_frame_interval);
+    }
+}
+
+static uint32_t
+get_region_area(pixman_region32_t *region)
+{
+    pixman_box32_t *boxes;
+    uint64_t area = 0;
+    int count, i;
+
+    boxes = pixman_region32_rectangles(region, &count);
+    for (i = 0; i < count; i++)
+        area += (uint64_t)(boxes[i].x2 - boxes[i].x1) *
+                (boxes[i].y2 - boxes[i].y1);
+
+    return area > UINT32_MAX ? UINT32_MAX : (uint32_t)area;
+}
+
+/*
+ * The rules of analyzeOcclusion() in LayerManagerControl, applied to the
+ * views composited on the output: a surface is seen when its opacity
+ * multiplied with the one of its layer is not zero and a part of it inside
+ * the output is not covered by the opaque regions of the views above it.
+ * Invisible surfaces and layers and layers which are not in the render
+ * order of a screen have no views on any output.
+ *
+ * The covered region is kept as y-x banded rectangles by pixman, so each
+ * view is clipped against the union of all views above it in one pass
+ * instead of against every one of them.
+ */
+static void
+update_occlusion(struct ivishell *shell, struct iviscreen *iviscrn)
+{
+    const struct ivi_layout_interface *lyt = shell->interface;
+    struct weston_output *output = iviscrn->output;
+    struct weston_view *view;
+    struct wl_listener *listener;
+    struct ivisurface *ivisurf;
+    struct surface_coverage *coverage;
+    pixman_region32_t covered;
+    pixman_region32_t inside;
+    pixman_region32_t visible;
+    struct weston_surface *surface;
+    uint32_t output_bit = 1u << output->id;
+    uint32_t visible_area;
+
+    wl_list_for_each(ivisurf, &shell->list_surface, link) {
+        ivisurf->visible_outputs &= ~output_bit;
+        ivisurf->view_outputs &= ~output_bit;
+    }
+
+    iviscrn->coverage.size = 0;
+    pixman_region32_init(&covered);
+    pixman_region32_init(&inside);
+    pixman_region32_init(&visible);
+
+    /* the view list is sorted from top to bottom */
+    wl_list_for_each(view, &shell->compositor->view_list, link) {
+        if (!(view->output_mask & output_bit))
+            continue;
+
+        listener = wl_signal_get(&view->surface->commit_signal,
+                                 surface_committed);
+        if (listener != NULL) {
+            ivisurf = wl_container_of(listener, ivisurf, committed);
+            ivisurf->view_outputs |= output_bit;
+            pixman_region32_intersect(&inside, &view->transform.boundingbox,
+                                      &output->region);
+            pixman_region32_subtract(&visible, &inside, &covered);
+
+            visible_area = 0;
+            if (view->alpha > 0.0f)
+                visible_area = get_region_area(&visible);
+            if (visible_area)
+                ivisurf->visible_outputs |= output_bit;
+
+            coverage = wl_array_add(&iviscrn->coverage, sizeof *coverage);
+            if (coverage) {
+                coverage->surface_id =
+                    lyt->get_id_of_surface(ivisurf->layout_surface);
+                coverage->area = get_region_area(&inside);
+                coverage->visible_area = visible_area;
+            }
+        }
+
+        pixman_region32_union(&covered, &covered, &view->transform.opaque);
+    }
+
+    pixman_region32_fini(&visible);
+    pixman_region32_fini(&inside);
+    pixman_region32_fini(&covered);
+
+    wl_list_for_each(ivisurf, &shell->list_surface, link) {
+        if (ivisurf->view_outputs == 0 &&
+            !wl_list_empty(&ivisurf->throttled_callbacks)) {
+            surface = lyt->surface_get_weston_surface(ivisurf->layout_surface);
+            return_frame_callbacks(ivisurf, surface);
+        }
+
+        if (ivisurf->occluded == (ivisurf->visible_outputs == 0))
+            continue;
+
+        ivisurf->occluded = !ivisurf->occluded;
+        send_surface_occlusion(ivisurf);
+
+        /* as if they were sent by this repaint */
+        if (!ivisurf->occluded)
+            release_throttled_callbacks(ivisurf, output->frame_time);
+    }
+}
+
+static uint64_t
+get_presentation_usec(struct weston_compositor *compositor)
+{
+    struct timespec ts;
+
+    weston_compositor_read_presentation_clock(compositor, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+/*
+ * A repaint starts from the presentation of the previous frame, so at the
+ * frame_signal frame_time and msc belong to the presentation of the frame
+ * before. The intervals are counted between these presentations, in vblanks
+ * if the backend counts them.
+ */
+static void
+account_frame_interval(struct iviscreen *iviscrn, uint64_t period_us)
+{
+    struct weston_output *output = iviscrn->output;
+    uint64_t periods;
+
+    if (output->frame_time == iviscrn->last_frame_time)
+        return;
+
+    if (iviscrn->last_frame_time != 0) {
+        if (output->msc != iviscrn->last_msc)
+            periods = output->msc - iviscrn->last_msc;
+        else
+            periods = ((uint64_t)(output->frame_time -
+                                  iviscrn->last_frame_time) * 1000 +
+                       period_us / 2) / period_us;
+        if (periods == 0)
+            periods = 1;
+        if (periods > SCREEN_INTERVAL_BUCKETS)
+            periods = SCREEN_INTERVAL_BUCKETS;
+        iviscrn->interval_histogram[periods - 1]++;
+    }
+
+    /* a late frame is shown by the presentation this repaint started from,
+     * the vblank counter tells how many vblanks it missed */
+    if (iviscrn->late_frame && output->msc > iviscrn->last_msc + 1)
+        iviscrn->missed_vblanks += output->msc - iviscrn->last_msc - 1;
+
+    iviscrn->last_frame_time = output->frame_time;
+    iviscrn->last_msc = output->msc;
+    iviscrn->late_frame = 0;
+}
+
+/*
+ * The repaint window of weston starts repaint_msec before the vblank which
+ * follows the presentation, or right away if that point has passed. The
+ * repaint time is measured from there to the end of the composition.
+ */
+static void
+account_repaint(struct iviscreen *iviscrn, uint64_t period_us, uint64_t now_us)
+{
+    struct weston_output *output = iviscrn->output;
+    uint64_t window_us = (uint64_t)output->compositor->repaint_msec * 1000;
+    uint64_t since_presented_us, repaint_us;
+
+    since_presented_us =
+        (uint64_t)((uint32_t)(now_us / 1000) - output->frame_time) * 1000 +
+        now_us % 1000;
+
+    /* the output was idle, frame_time is not a recent vblank */
+    if (since_presented_us >= SCREEN_INTERVAL_BUCKETS * period_us)
+        return;
+
+    if (window_us > period_us)
+        window_us = period_us;
+
+    repaint_us = 0;
+    if (since_presented_us > period_us - window_us)
+        repaint_us = since_presented_us - (period_us - window_us);
+
+    ivi_stats_request_add(&iviscrn->repaint_stats, repaint_us * 1000);
+    if (repaint_us > window_us) {
+        iviscrn->over_budget++;
+        iviscrn->late_frame = 1;
+    }
+}
+
+static void
+account_screen_frame(struct iviscreen *iviscrn)
+{
+    struct weston_output *output = iviscrn->output;
+    struct weston_compositor *compositor = output->compositor;
+    struct weston_view *view;
+    uint64_t now_us = get_presentation_usec(compositor);
+    uint64_t period_us = 0;
+    uint32_t views = 0;
+
+    if (output->current_mode && output->current_mode->refresh > 0)
+        period_us = 1000000000ull / output->current_mode->refresh;
+
+    if (period_us) {
+        account_frame_interval(iviscrn, period_us);
+        account_repaint(iviscrn, period_us, now_us);
+    }
+
+    /* the view list was built for this repaint */
+    wl_list_for_each(view, &compositor->view_list, link) {
+        if (view->output_mask & (1u << output->id))
+            views++;
+    }
+    iviscrn->views_total += views;
+    if (views > iviscrn->views_max)
+        iviscrn->views_max = views;
+}
+
+static void
+screen_frame_notify(struct wl_listener *listener, void *data)
+{
+    struct iviscreen *iviscrn = wl_container_of(listener, iviscrn, frame_listener);
+    struct ivishell *shell = iviscrn->shell;
+    uint64_t *flow_id;
+    (void)data;
+
+    account_screen_frame(iviscrn);
+
+    ivi_trace_event(shell->trace, IVI_TRACE_BEGIN, "frame", 0,
+                    "screen_id", iviscrn->id_screen);
+
+    flush_pending_properties(shell);
+    check_starting_surfaces(shell, iviscrn->output);
+    update_occlusion(shell, iviscrn);
+    if (shell->stall_timer)
+        check_stalled_surfaces(shell, iviscrn->output, 1);
+
+    /* the commits were applied before this repaint */
+    wl_array_for_each(flow_id, &shell->trace_flows) {
+        ivi_trace_event(shell->trace, IVI_TRACE_FLOW_END, TRACE_COMMIT_FLOW,
+                        *flow_id, NULL, 0);
+    }
+    shell->trace_flows.size = 0;
+
+    ivi_trace_event(shell->trace, IVI_TRACE_END, "frame", 0, NULL, 0);
+}
+
+static void
+log_screen_stats(struct ivishell *shell)
+{
+    struct iviscreen *iviscrn;
+    struct ivi_stats_request *repaint;
+
+    wl_list_for_each(iviscrn, &shell->list_screen, link) {
+        repaint = &iviscrn->repaint_stats;
+        if (repaint->count == 0)
+            continue;
+
+        weston_log_continue("  screen %u: %llu frames, repaint mean/max "
+                            "%llu/%llu us, %u over budget, %u missed vblanks, "
+                            "max %u views\n", iviscrn->id_screen,
+                            (unsigned long long)repaint->count,
+                            (unsigned long long)
+                            (repaint->total_ns / repaint->count / 1000),
+                            (unsigned long long)(repaint->max_ns / 1000),
+                            iviscrn->over_budget, iviscrn->missed_vblanks,
+                            iviscrn->views_max);
+    }
 }
 
 static struct iviscreen*
@@ -1544,6 +3122,10 @@ create_screen(struct ivishell *shell, struct weston_output *output)
 
     wl_list_insert(&shell->list_screen, &iviscrn->link);
     wl_list_init(&iviscrn->resource_list);
+    wl_array_init(&iviscrn->coverage);
+
+    iviscrn->frame_listener.notify = screen_frame_notify;
+    wl_signal_add(&output->frame_signal, &iviscrn->frame_listener);
 
     return iviscrn;
 }
@@ -1552,13 +3134,22 @@ static void
 destroy_screen(struct iviscreen *iviscrn)
 {
     struct wl_resource *resource, *next;
+    struct ivisurface *ivisurf;
 
     wl_resource_for_each_safe(resource, next, &iviscrn->resource_list) {
         wl_resource_set_destructor(resource, NULL);
         wl_resource_destroy(resource);
     }
 
+    /* the id is reused by the next output */
+    wl_list_for_each(ivisurf, &iviscrn->shell->list_surface, link) {
+        ivisurf->visible_outputs &= ~(1u << iviscrn->output->id);
+        ivisurf->view_outputs &= ~(1u << iviscrn->output->id);
+    }
+
+    wl_list_remove(&iviscrn->frame_listener.link);
     wl_list_remove(&iviscrn->link);
+    wl_array_release(&iviscrn->coverage);
     free(iviscrn);
 }
 
@@ -1614,7 +3205,7 @@ create_layer(struct ivishell *shell,
     struct ivilayer *ivilayer = NULL;
     struct ivicontroller *controller = NULL;
 
-    ivilayer = calloc(1, sizeof *ivilayer);
+    ivilayer = ivi_pool_zalloc(&layer_pool);
     if (NULL == ivilayer) {
         weston_log("no memory to allocate client layer\n");
         return NULL;
@@ -1623,6 +3214,7 @@ create_layer(struct ivishell *shell,
     ivilayer->shell = shell;
     wl_list_insert(&shell->list_layer, &ivilayer->link);
     wl_list_init(&ivilayer->notification_list);
+    wl_list_init(&ivilayer->pending_link);
     ivilayer->layout_layer = layout_layer;
     ivilayer->prop = lyt->get_properties_of_layer(layout_layer);
 
@@ -1632,6 +3224,12 @@ create_layer(struct ivishell *shell,
     wl_list_for_each(controller, &shell->list_controller, link) {
         if (controller->resource)
             ivi_wm_send_layer_created(controller->resource, id_layer);
+
+        if (controller->layer_sync_all_mask &&
+            !add_notification(&controller->layer_notifications,
+                              &ivilayer->notification_list,
+                              controller->resource, 0))
+            weston_log("no memory to allocate layer notification\n");
     }
 
     return ivilayer;
@@ -1641,9 +3239,24 @@ static void
 surface_committed(struct wl_listener *listener, void *data)
 {
     struct ivisurface *ivisurf = wl_container_of(listener, ivisurf, committed);
+    const struct ivi_layout_interface *lyt = ivisurf->shell->interface;
+    struct weston_surface *surface;
     (void)data;
 
     ivisurf->frame_count++;
+
+    surface = lyt->surface_get_weston_surface(ivisurf->layout_surface);
+
+    if (get_stall_timeout(ivisurf) != 0 || ivisurf->stalled)
+        surface_commit_watchdog(ivisurf, surface);
+
+    if (ivisurf->occluded && ivisurf->view_outputs &&
+        ivisurf->shell->throttle_timer)
+        throttle_frame_callbacks(ivisurf, surface);
+
+    if (ivisurf->lifecycle_us[IVI_WM_LIFECYCLE_STAGE_FIRST_COMMIT] == 0 &&
+        surface->buffer_ref.buffer != NULL)
+        mark_lifecycle_stage(ivisurf, IVI_WM_LIFECYCLE_STAGE_FIRST_COMMIT);
 }
 
 static struct ivisurface*
@@ -1656,7 +3269,7 @@ create_surface(struct ivishell *shell,
     struct ivicontroller *controller = NULL;
     struct weston_surface *surface;
 
-    ivisurf = calloc(1, sizeof *ivisurf);
+    ivisurf = ivi_pool_zalloc(&surface_pool);
     if (ivisurf == NULL) {
         weston_log("no memory to allocate client surface\n");
         return NULL;
@@ -1666,6 +3279,11 @@ create_surface(struct ivishell *shell,
     ivisurf->layout_surface = layout_surface;
     ivisurf->prop = lyt->get_properties_of_surface(layout_surface);
     wl_list_init(&ivisurf->notification_list);
+    wl_list_init(&ivisurf->pending_link);
+    wl_list_init(&ivisurf->starting_link);
+    wl_list_init(&ivisurf->stall_link);
+    wl_list_init(&ivisurf->throttled_callbacks);
+    ivisurf->created_us = get_monotonic_usec();
 
     ivisurf->committed.notify = surface_committed;
     surface = lyt->surface_get_weston_surface(layout_surface);
@@ -1673,11 +3291,18 @@ create_surface(struct ivishell *shell,
 
     if (shell->bkgnd_surface_id != id_surface) {
         wl_list_insert(&shell->list_surface, &ivisurf->link);
+        wl_list_insert(&shell->list_starting_surface, &ivisurf->starting_link);
 
         wl_list_for_each(controller, &shell->list_controller, link) {
             if (controller->resource)
                 ivi_wm_send_surface_created(controller->resource, id_surface);
-            }
+
+            if (controller->surface_sync_all_mask &&
+                !add_notification(&controller->surface_notifications,
+                                  &ivisurf->notification_list,
+                                  controller->resource, 0))
+                weston_log("no memory to allocate surface notification\n");
+        }
 
         ivisurf->property_changed.notify = send_surface_prop;
         lyt->surface_add_listener(layout_surface, &ivisurf->property_changed);
@@ -1706,6 +3331,8 @@ layer_event_create(struct wl_listener *listener, void *data)
         weston_log("failed to create layer");
         return;
     }
+
+    bump_scene_generation(shell);
 }
 
 static void
@@ -1730,12 +3357,13 @@ layer_event_remove(struct wl_listener *listener, void *data)
     {
         wl_list_remove(&not->link);
         wl_list_remove(&not->layout_link);
-        free(not);
+        ivi_pool_free(&notification_pool, not);
     }
 
     wl_list_remove(&ivilayer->link);
+    wl_list_remove(&ivilayer->pending_link);
     wl_list_remove(&ivilayer->property_changed.link);
-    free(ivilayer);
+    ivi_pool_free(&layer_pool, ivilayer);
 
     id_layer = shell->interface->get_id_of_layer(layout_layer);
 
@@ -1743,6 +3371,8 @@ layer_event_remove(struct wl_listener *listener, void *data)
         if (controller->resource)
             ivi_wm_send_layer_destroyed(controller->resource, id_layer);
     }
+
+    bump_scene_generation(shell);
 }
 
 
@@ -1765,8 +3395,10 @@ surface_event_create(struct wl_listener *listener, void *data)
         return;
     }
 
-    if (shell->bkgnd_surface_id != id_surface)
+    if (shell->bkgnd_surface_id != id_surface) {
         wl_signal_emit(&shell->ivisurface_created_signal, ivisurf);
+        bump_scene_generation(shell);
+    }
 }
 
 static void
@@ -1792,13 +3424,20 @@ surface_event_remove(struct wl_listener *listener, void *data)
     {
         wl_list_remove(&not->link);
         wl_list_remove(&not->layout_link);
-        free(not);
+        ivi_pool_free(&notification_pool, not);
     }
 
     wl_list_remove(&ivisurf->link);
+    wl_list_remove(&ivisurf->pending_link);
+    wl_list_remove(&ivisurf->starting_link);
+    wl_list_remove(&ivisurf->stall_link);
     wl_list_remove(&ivisurf->property_changed.link);
     wl_list_remove(&ivisurf->committed.link);
-    free(ivisurf);
+
+    /* weston drops the pending callbacks of destroyed surfaces as well */
+    finish_frame_callbacks(ivisurf, 0, 0);
+
+    ivi_pool_free(&surface_pool, ivisurf);
 
     id_surface = shell->interface->get_id_of_surface(layout_surface);
 
@@ -1812,6 +3451,8 @@ surface_event_remove(struct wl_listener *listener, void *data)
         if (controller->resource)
             ivi_wm_send_surface_destroyed(controller->resource, id_surface);
     }
+
+    bump_scene_generation(shell);
 }
 
 static void
@@ -1827,6 +3468,7 @@ surface_event_configure(struct wl_listener *listener, void *data)
     struct notification *not;
     uint32_t surface_id;
     struct weston_surface *w_surface;
+    uint32_t wanted = 0;
 
     surface_id = lyt->get_id_of_surface(layout_surface);
     if (shell->bkgnd_surface_id == surface_id) {
@@ -1859,6 +3501,8 @@ surface_event_configure(struct wl_listener *listener, void *data)
         return;
     }
 
+    mark_lifecycle_stage(ivisurf, IVI_WM_LIFECYCLE_STAGE_FIRST_CONFIGURE);
+
     if (ivisurf->type == IVI_WM_SURFACE_TYPE_DESKTOP) {
         w_surface = lyt->surface_get_weston_surface(layout_surface);
         lyt->surface_set_destination_rectangle(layout_surface,
@@ -1876,9 +3520,19 @@ surface_event_configure(struct wl_listener *listener, void *data)
 
     wl_list_for_each(not, &ivisurf->notification_list, layout_link) {
         ctrl = wl_resource_get_user_data(not->resource);
+        if (is_coalescing_controller(not->resource)) {
+            wanted |= not->mask | ctrl->surface_sync_all_mask;
+            continue;
+        }
+
         send_surface_event(ctrl, ivisurf->layout_surface, surface_id, ivisurf->prop,
                            IVI_NOTIFICATION_CONFIGURE);
     }
+
+    if (wanted)
+        queue_surface_properties(ivisurf, IVI_NOTIFICATION_CONFIGURE, wanted);
+
+    bump_scene_generation(shell);
 }
 
 static int32_t
@@ -1972,6 +3626,7 @@ get_config(struct weston_compositor *compositor, struct ivishell *shell)
 	struct weston_config *config = NULL;
 	struct screen_id_info *screen_info = NULL;
 	const char *name = NULL;
+	uint32_t trace_size = 0;
 
 	config = wet_get_config(compositor);
 	if (!config)
@@ -1997,6 +3652,34 @@ get_config(struct weston_compositor *compositor, struct ivishell *shell)
                        "bkgnd-color",
                        &shell->bkgnd_color, 0xFF000000);
 
+	weston_config_section_get_uint(section,
+				       "trace-buffer-size",
+				       &trace_size, 0);
+
+	weston_config_section_get_string(section,
+                       "trace-file",
+                       &shell->trace_file, "/tmp/ivi-controller-trace.json");
+
+	weston_config_section_get_uint(section,
+				       "stall-timeout-restricted",
+				       &shell->stall_timeout_restricted, 0);
+
+	weston_config_section_get_uint(section,
+				       "stall-timeout-desktop",
+				       &shell->stall_timeout_desktop, 0);
+
+	weston_config_section_get_uint(section,
+				       "occluded-frame-interval",
+				       &shell->occluded_frame_interval, 0);
+
+	if (trace_size > 0) {
+		shell->trace = ivi_trace_create(trace_size);
+		if (shell->trace)
+			weston_log("ivi-controller: tracing into a ring of %u "
+				   "events, dumped to %s\n", trace_size,
+				   shell->trace_file);
+	}
+
 	wl_array_init(&shell->screen_ids);
 
 	while (weston_config_next_section(config, &section, &name)) {
@@ -2028,6 +3711,20 @@ get_config(struct weston_compositor *compositor, struct ivishell *shell)
 	}
 }
 
+static void
+dump_trace(struct ivishell *shell)
+{
+	if (shell->trace == NULL)
+		return;
+
+	if (ivi_trace_dump(shell->trace, shell->trace_file) < 0)
+		weston_log("ivi-controller: failed to write trace to %s\n",
+			   shell->trace_file);
+	else
+		weston_log("ivi-controller: trace written to %s\n",
+			   shell->trace_file);
+}
+
 static void
 ivi_shell_destroy(struct wl_listener *listener, void *data)
 {
@@ -2044,23 +3741,57 @@ ivi_shell_destroy(struct wl_listener *listener, void *data)
 
 	wl_list_for_each_safe(ivisurf, ivisurf_next,
 			      &shell->list_surface, link) {
+		finish_frame_callbacks(ivisurf, 0, 0);
 		wl_list_remove(&ivisurf->link);
-		free(ivisurf);
+		ivi_pool_free(&surface_pool, ivisurf);
 	}
 
 	wl_list_for_each_safe(ivilayer, ivilayer_next,
 			      &shell->list_layer, link) {
 		wl_list_remove(&ivilayer->link);
-		free(ivilayer);
+		ivi_pool_free(&layer_pool, ivilayer);
 	}
 
+	ivi_stats_log(&shell->stats);
+	log_screen_stats(shell);
+
+	if (shell->flush_idle)
+		wl_event_source_remove(shell->flush_idle);
+
+	if (shell->stall_timer)
+		wl_event_source_remove(shell->stall_timer);
+
+	if (shell->throttle_timer)
+		wl_event_source_remove(shell->throttle_timer);
+
 	wl_list_for_each_safe(iviscrn, iviscrn_next,
 			      &shell->list_screen, link) {
 		destroy_screen(iviscrn);
 	}
 
+	ivi_stats_release(&shell->stats);
+
+	dump_trace(shell);
+	ivi_trace_destroy(shell->trace);
+	free(shell->trace_file);
+	wl_array_release(&shell->trace_flows);
+	ivi_stats_table_release(&wm_stats);
+	ivi_stats_table_release(&screen_stats);
+
 	destroy_screen_ids(shell);
 	free(shell);
+
+	log_pool_stats(&surface_pool);
+	log_pool_stats(&layer_pool);
+	log_pool_stats(&notification_pool);
+	log_pool_stats(&screenshot_pool);
+
+	/* notifications and screenshots may still be owned by clients which
+	 * are torn down after the shell, only release what is unused */
+	ivi_pool_release(&surface_pool);
+	ivi_pool_release(&layer_pool);
+	ivi_pool_release(&notification_pool);
+	ivi_pool_release(&screenshot_pool);
 }
 
 void
@@ -2077,6 +3808,36 @@ init_ivi_shell(struct weston_compositor *ec, struct ivishell *shell)
     wl_list_init(&shell->list_layer);
     wl_list_init(&shell->list_screen);
     wl_list_init(&shell->list_controller);
+    wl_list_init(&shell->list_pending_surface);
+    wl_list_init(&shell->list_starting_surface);
+    wl_list_init(&shell->list_stall_candidate);
+    wl_list_init(&shell->list_pending_layer);
+    ivi_stats_init(&shell->stats);
+    wl_array_init(&shell->trace_flows);
+
+    if (shell->stall_timeout_restricted || shell->stall_timeout_desktop) {
+        shell->stall_timer =
+            wl_event_loop_add_timer(wl_display_get_event_loop(ec->wl_display),
+                                    stall_timer_expired, shell);
+        if (shell->stall_timer == NULL)
+            weston_log("ivi-controller: failed to create the stall timer\n");
+    }
+
+#ifndef HAVE_WESTON_FRAME_CALLBACK
+    if (shell->occluded_frame_interval) {
+        weston_log("ivi-controller: occluded-frame-interval is not supported "
+                   "with this libweston version\n");
+        shell->occluded_frame_interval = 0;
+    }
+#endif
+
+    if (shell->occluded_frame_interval) {
+        shell->throttle_timer =
+            wl_event_loop_add_timer(wl_display_get_event_loop(ec->wl_display),
+                                    throttle_timer_expired, shell);
+        if (shell->throttle_timer == NULL)
+            weston_log("ivi-controller: failed to create the throttle timer\n");
+    }
 
     wl_list_for_each(output, &ec->output_list, link)
         iviscrn = create_screen(shell, output);
@@ -2120,15 +3881,57 @@ init_ivi_shell(struct weston_compositor *ec, struct ivishell *shell)
     wl_signal_init(&shell->ivisurface_removed_signal);
 }
 
+static void
+stats_debug_binding(struct weston_keyboard *keyboard, uint32_t time,
+                    uint32_t key, void *data)
+{
+    struct ivishell *shell = data;
+    (void)keyboard;
+    (void)time;
+    (void)key;
+
+    ivi_stats_log(&shell->stats);
+    log_screen_stats(shell);
+}
+
+static void
+trace_debug_binding(struct weston_keyboard *keyboard, uint32_t time,
+                    uint32_t key, void *data)
+{
+    struct ivishell *shell = data;
+    (void)keyboard;
+    (void)time;
+    (void)key;
+
+    dump_trace(shell);
+}
+
 int
 setup_ivi_controller_server(struct weston_compositor *compositor,
                             struct ivishell *shell)
 {
-    if (wl_global_create(compositor->wl_display, &ivi_wm_interface, 1,
+    if (wl_global_create(compositor->wl_display, &ivi_wm_interface, 9,
                          shell, bind_ivi_controller) == NULL) {
         return -1;
     }
 
+    if (ivi_stats_table_init(&wm_stats, &ivi_wm_interface) < 0 ||
+        ivi_stats_table_init(&screen_stats, &ivi_wm_screen_interface) < 0) {
+        weston_log("ivi-controller: no memory for request statistics\n");
+    } else {
+        ivi_stats_add_table(&shell->stats, &wm_stats);
+        ivi_stats_add_table(&shell->stats, &screen_stats);
+    }
+
+    /* debug binding mod-shift-space s writes the statistics to the log */
+    weston_compositor_add_debug_binding(compositor, KEY_S,
+                                        stats_debug_binding, shell);
+
+    /* mod-shift-space t dumps the trace ring, if tracing is enabled */
+    if (shell->trace)
+        weston_compositor_add_debug_binding(compositor, KEY_T,
+                                            trace_debug_binding, shell);
+
     return 0;
 }
 
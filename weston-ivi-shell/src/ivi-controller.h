@@ -25,6 +25,10 @@
 
 #include "ivi-wm-server-protocol.h"
 #include <weston/ivi-layout-export.h>
+#include "ivi-stats.h"
+#include "ivi-trace.h"
+
+#define IVI_LIFECYCLE_STAGES (IVI_WM_LIFECYCLE_STAGE_FIRST_FRAME + 1)
 
 struct ivisurface {
     struct wl_list link;
@@ -39,6 +43,32 @@ struct ivisurface {
     enum ivi_wm_surface_type type;
     uint32_t frame_count;
     struct wl_list accepted_seat_list;
+
+    /* property changes not yet sent to version 2 controllers */
+    uint32_t pending_mask;
+    struct wl_list pending_link;
+
+    /* CLOCK_MONOTONIC us, stages stay 0 until they are reached */
+    uint64_t created_us;
+    uint64_t lifecycle_us[IVI_LIFECYCLE_STAGES];
+    /* in ivishell.list_starting_surface until its first frame */
+    struct wl_list starting_link;
+
+    /* stall watchdog, the frame callback was sent at frame_sent_us */
+    uint64_t last_commit_us;
+    uint64_t frame_sent_us;
+    int stalled;
+    /* in ivishell.list_stall_candidate while it waits for its next commit
+     * after asking for a frame callback */
+    struct wl_list stall_link;
+
+    /* bit per output id on which a part of the surface is seen */
+    uint32_t visible_outputs;
+    /* bit per output id on which the surface has a view, seen or not */
+    uint32_t view_outputs;
+    int occluded;
+    /* frame callbacks held back while the surface is occluded */
+    struct wl_list throttled_callbacks;
 };
 
 struct ivishell {
@@ -51,6 +81,19 @@ struct ivishell {
 
     struct wl_list list_controller;
 
+    struct wl_list list_pending_surface;
+    struct wl_list list_pending_layer;
+    struct wl_list list_starting_surface;
+    struct wl_list list_stall_candidate;
+
+    /* bumped on every committed change of the scene */
+    uint32_t scene_generation;
+    uint32_t scene_generation_sent;
+    int render_order_pending;
+    /* pending properties wait for a frame_signal or for flush_idle */
+    int flush_on_frame;
+    struct wl_event_source *flush_idle;
+
     struct wl_signal ivisurface_created_signal;
     struct wl_signal ivisurface_removed_signal;
 
@@ -79,6 +122,27 @@ struct ivishell {
 
     struct wl_client *client;
     char *ivi_client_name;
+
+    /* request statistics of ivi-controller and the input module */
+    struct ivi_stats stats;
+
+    /* NULL unless trace-buffer-size is set in weston.ini */
+    struct ivi_trace *trace;
+    char *trace_file;
+    /* flow ids of commits which wait for the next repaint */
+    struct wl_array trace_flows;
+
+    /* stall deadlines in ms per surface type, 0 disables the watchdog */
+    uint32_t stall_timeout_restricted;
+    uint32_t stall_timeout_desktop;
+    /* checks the surfaces when no output is repainted */
+    struct wl_event_source *stall_timer;
+    uint64_t stall_check_us;
+
+    /* ms between frame callbacks of occluded surfaces, 0 disables it */
+    uint32_t occluded_frame_interval;
+    struct wl_event_source *throttle_timer;
+    int throttle_armed;
 };
 
 #endif /* WESTON_IVI_SHELL_SRC_IVI_CONTROLLER_H_ */
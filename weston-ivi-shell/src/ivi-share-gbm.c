@@ -16,10 +16,13 @@
  * limitations under the License.
  *
  ****************************************************************************/
+#include "config.h"
+
 #include <stdio.h>
 #include <stdint.h>
 
 #include <fcntl.h>
+#include <unistd.h>
 #include <stdbool.h>
 #include <string.h>
 #include <assert.h>
@@ -89,10 +92,168 @@ struct drm_backend {
 	int32_t cursor_height;
 };
 
-uint32_t
-get_buffer_name(struct ivi_share_nativesurface *p_nativesurface)
+const struct ivi_share_dmabuf *
+get_buffer_dmabuf(struct ivi_share_nativesurface *p_nativesurface)
+{
+    struct ivi_share_buffer_cache_entry *entry = p_nativesurface->current_entry;
+
+    if (entry == NULL || entry->buffer == NULL || entry->dmabuf.fd[0] < 0)
+        return NULL;
+
+    return &entry->dmabuf;
+}
+
+/* wl_buffer object ids are reused by libwayland once a buffer is destroyed,
+ * so dmabuf consumers get names from this counter instead */
+static uint32_t next_buffer_id;
+
+static uint32_t
+alloc_buffer_id(void)
 {
-     return p_nativesurface->name;
+    if (++next_buffer_id == 0)
+        next_buffer_id = 1;
+
+    return next_buffer_id;
+}
+
+static void
+close_dmabuf(struct ivi_share_dmabuf *dmabuf)
+{
+    int i;
+
+    for (i = 0; i < IVI_SHARE_MAX_PLANES; i++) {
+        if (dmabuf->fd[i] >= 0)
+            close(dmabuf->fd[i]);
+        dmabuf->fd[i] = -1;
+    }
+}
+
+static int
+export_dmabuf(struct gbm_bo *bo, struct ivi_share_dmabuf *dmabuf)
+{
+    int plane_count = gbm_bo_get_plane_count(bo);
+    int i;
+
+    if (plane_count <= 0 || plane_count > IVI_SHARE_MAX_PLANES) {
+        weston_log("unsupported number of planes: %d\n", plane_count);
+        return -1;
+    }
+
+#ifdef HAVE_GBM_BO_GET_FD_FOR_PLANE
+    /* planes may live in separate buffer objects, each gets its own fd */
+    for (i = 0; i < plane_count; i++) {
+        dmabuf->fd[i] = gbm_bo_get_fd_for_plane(bo, i);
+        if (dmabuf->fd[i] < 0) {
+            weston_log("failed to export plane %d of gbm_bo as dmabuf\n", i);
+            close_dmabuf(dmabuf);
+            return -1;
+        }
+    }
+#else
+    /* gbm_bo_get_fd only exports the first plane */
+    if (plane_count > 1) {
+        weston_log("multi-planar buffers need gbm_bo_get_fd_for_plane\n");
+        return -1;
+    }
+
+    dmabuf->fd[0] = gbm_bo_get_fd(bo);
+    if (dmabuf->fd[0] < 0) {
+        weston_log("failed to export gbm_bo as dmabuf\n");
+        return -1;
+    }
+#endif
+
+    dmabuf->format   = gbm_bo_get_format(bo);
+    dmabuf->modifier = gbm_bo_get_modifier(bo);
+    dmabuf->n_planes = plane_count;
+
+    for (i = 0; i < plane_count; i++) {
+        dmabuf->offset[i] = gbm_bo_get_offset(bo, i);
+        dmabuf->stride[i] = gbm_bo_get_stride_for_plane(bo, i);
+    }
+
+    return 0;
+}
+
+static void
+reset_buffer_cache_entry(struct ivi_share_buffer_cache_entry *entry)
+{
+    if (entry->buffer == NULL)
+        return;
+
+    wl_list_remove(&entry->buffer_destroy_listener.link);
+    close_dmabuf(&entry->dmabuf);
+    gbm_bo_destroy(entry->bo);
+
+    memset(entry, 0, sizeof *entry);
+}
+
+static void
+buffer_cache_buffer_destroyed(struct wl_listener *listener, void *data)
+{
+    struct ivi_share_buffer_cache_entry *entry =
+        wl_container_of(listener, entry, buffer_destroy_listener);
+    (void)data;
+
+    reset_buffer_cache_entry(entry);
+}
+
+void
+release_buffer_cache(struct ivi_share_nativesurface *p_nativesurface)
+{
+    int i;
+
+    for (i = 0; i < IVI_SHARE_BUFFER_CACHE_SIZE; i++)
+        reset_buffer_cache_entry(&p_nativesurface->buffer_cache[i]);
+
+    p_nativesurface->current_entry = NULL;
+}
+
+static struct ivi_share_buffer_cache_entry *
+get_buffer_cache_entry(struct ivi_share_nativesurface *p_nativesurface,
+                       struct gbm_device *gbm, struct weston_buffer *buffer)
+{
+    struct ivi_share_buffer_cache_entry *entry = NULL;
+    struct ivi_share_buffer_cache_entry *victim = NULL;
+    struct gbm_bo *bo;
+    int i;
+
+    for (i = 0; i < IVI_SHARE_BUFFER_CACHE_SIZE; i++) {
+        entry = &p_nativesurface->buffer_cache[i];
+        if (entry->buffer == buffer) {
+            entry->last_used = ++p_nativesurface->buffer_cache_clock;
+            return entry;
+        }
+
+        /* prefer a free slot, otherwise the least recently used one */
+        if (victim == NULL ||
+            (victim->buffer != NULL &&
+             (entry->buffer == NULL || entry->last_used < victim->last_used)))
+            victim = entry;
+    }
+
+    bo = gbm_bo_import(gbm, GBM_BO_IMPORT_WL_BUFFER,
+                       buffer->legacy_buffer, GBM_BO_USE_SCANOUT);
+    if (!bo) {
+        weston_log("failed to import gbm_bo\n");
+        return NULL;
+    }
+
+    reset_buffer_cache_entry(victim);
+
+    victim->buffer    = buffer;
+    victim->bo        = bo;
+    victim->width     = gbm_bo_get_width(bo);
+    victim->height    = gbm_bo_get_height(bo);
+    victim->stride    = gbm_bo_get_stride(bo);
+    victim->buffer_id = alloc_buffer_id();
+    for (i = 0; i < IVI_SHARE_MAX_PLANES; i++)
+        victim->dmabuf.fd[i] = -1;
+    victim->last_used = ++p_nativesurface->buffer_cache_clock;
+    victim->buffer_destroy_listener.notify = buffer_cache_buffer_destroyed;
+    wl_signal_add(&buffer->destroy_signal, &victim->buffer_destroy_listener);
+
+    return victim;
 }
 
 uint32_t
@@ -113,48 +274,61 @@ update_buffer_nativesurface(struct ivi_share_nativesurface *p_nativesurface)
         return IVI_SHAREBUFFER_NOT_AVAILABLE;
     }
 
-    struct gbm_bo *bo = gbm_bo_import(backend->gbm, GBM_BO_IMPORT_WL_BUFFER,
-                                      buffer->legacy_buffer, GBM_BO_USE_SCANOUT);
-    if (!bo) {
-        weston_log("failed to import gbm_bo\n");
+    struct ivi_share_buffer_cache_entry *entry =
+        get_buffer_cache_entry(p_nativesurface, backend->gbm, buffer);
+    if (!entry) {
         return IVI_SHAREBUFFER_INVALID;
     }
 
-    struct drm_gem_flink flink = {0};
-    flink.handle = gbm_bo_get_handle(bo).u32;
-    if (drmIoctl(gbm_device_get_fd(backend->gbm), DRM_IOCTL_GEM_FLINK, &flink) != 0) {
-        weston_log("gem_flink: returned non-zero failed\n");
-        gbm_bo_destroy(bo);
-        return IVI_SHAREBUFFER_INVALID;
+    /* Global flink names are only created for consumers of the legacy gbm
+     * type. dmabuf consumers have a nativesurface of their own and identify
+     * buffers by the id given to the import, a new buffer never gets the id
+     * of an earlier one. */
+    uint32_t name;
+    if (p_nativesurface->bufferType == IVI_SHARE_SURFACE_TYPE_GBM) {
+        if (entry->flink_name == 0) {
+            struct drm_gem_flink flink = {0};
+            flink.handle = gbm_bo_get_handle(entry->bo).u32;
+            if (drmIoctl(gbm_device_get_fd(backend->gbm), DRM_IOCTL_GEM_FLINK, &flink) != 0) {
+                weston_log("gem_flink: returned non-zero failed\n");
+                return IVI_SHAREBUFFER_INVALID;
+            }
+            entry->flink_name = flink.name;
+        }
+        name = entry->flink_name;
+    } else {
+        name = entry->buffer_id;
+    }
+
+    if (p_nativesurface->bufferType == IVI_SHARE_SURFACE_TYPE_DMABUF &&
+        entry->dmabuf.fd[0] < 0) {
+        if (export_dmabuf(entry->bo, &entry->dmabuf) < 0) {
+            return IVI_SHAREBUFFER_INVALID;
+        }
     }
 
-    uint32_t name   = flink.name;
-    uint32_t width  = gbm_bo_get_width(bo);
-    uint32_t height = gbm_bo_get_height(bo);
-    uint32_t stride = gbm_bo_get_stride(bo);
     uint32_t format = IVI_SHARE_SURFACE_FORMAT_ARGB8888;
     uint32_t ret    = IVI_SHAREBUFFER_STABLE;
 
     if (name != p_nativesurface->name) {
         ret |= IVI_SHAREBUFFER_DAMAGE;
     }
-    if (width != p_nativesurface->width) {
+    if (entry->width != p_nativesurface->width) {
         ret |= IVI_SHAREBUFFER_CONFIGURE;
     }
-    if (height != p_nativesurface->height) {
+    if (entry->height != p_nativesurface->height) {
         ret |= IVI_SHAREBUFFER_CONFIGURE;
     }
-    if (stride != p_nativesurface->stride) {
+    if (entry->stride != p_nativesurface->stride) {
         ret |= IVI_SHAREBUFFER_CONFIGURE;
     }
 
+    p_nativesurface->current_entry = entry;
     p_nativesurface->name   = name;
-    p_nativesurface->width  = width;
-    p_nativesurface->height = height;
-    p_nativesurface->stride = stride;
+    p_nativesurface->width  = entry->width;
+    p_nativesurface->height = entry->height;
+    p_nativesurface->stride = entry->stride;
     p_nativesurface->format = format;
 
-    gbm_bo_destroy(bo);
-
     return ret;
 }
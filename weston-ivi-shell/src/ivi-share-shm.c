@@ -0,0 +1,236 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2026 The wayland-ivi-extension contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ****************************************************************************/
+/*
+ * shm share type: the content of the shared surface is copied into a ring
+ * of shared memory slots. wl_shm buffers are copied directly, any other
+ * buffer is read back through the renderer, so this works without a GPU
+ * and on the headless and pixman backends.
+ */
+
+#define _GNU_SOURCE
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "wayland-server.h"
+#include "ivi-share-server-protocol.h"
+#include "ivi-share.h"
+
+static int
+create_shm_file(off_t size)
+{
+    int fd;
+
+#ifdef HAVE_MEMFD_CREATE
+    fd = memfd_create("ivi-share", MFD_CLOEXEC);
+    if (fd < 0)
+        return -1;
+#else
+    const char template[] = "/ivi-share-XXXXXX";
+    const char *runtimedir;
+    char *tmpname;
+
+    runtimedir = getenv("XDG_RUNTIME_DIR");
+    if (runtimedir == NULL)
+        return -1;
+
+    tmpname = malloc(strlen(runtimedir) + sizeof(template));
+    if (tmpname == NULL)
+        return -1;
+
+    fd = mkostemp(strcat(strcpy(tmpname, runtimedir), template), O_CLOEXEC);
+    if (fd < 0) {
+        free(tmpname);
+        return -1;
+    }
+
+    unlink(tmpname);
+    free(tmpname);
+#endif
+
+#ifdef HAVE_POSIX_FALLOCATE
+    if (posix_fallocate(fd, 0, size)) {
+#else
+    if (ftruncate(fd, size) < 0) {
+#endif
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void
+release_shm_slot(struct ivi_share_shm_slot *shm_slot)
+{
+    if (shm_slot->fd < 0)
+        return;
+
+    munmap(shm_slot->data, shm_slot->size);
+    close(shm_slot->fd);
+    shm_slot->fd = -1;
+    shm_slot->size = 0;
+    shm_slot->data = NULL;
+}
+
+void
+release_shm_slots(struct ivi_share_nativesurface *p_nativesurface)
+{
+    int i;
+
+    for (i = 0; i < MAX_BUFFER_REFERENCE; i++)
+        release_shm_slot(&p_nativesurface->shm_slots[i]);
+}
+
+static uint32_t
+to_share_format(uint32_t shm_format)
+{
+    switch (shm_format) {
+    case WL_SHM_FORMAT_ARGB8888:
+        return IVI_SHARE_SURFACE_FORMAT_ARGB8888;
+    case WL_SHM_FORMAT_XRGB8888:
+        return IVI_SHARE_SURFACE_FORMAT_XRGB8888;
+    default:
+        return IVI_SHARE_SURFACE_FORMAT_UNKNOWN;
+    }
+}
+
+uint32_t
+update_buffer_nativesurface_shm(struct ivi_share_nativesurface *p_nativesurface)
+{
+    if (NULL == p_nativesurface || NULL == p_nativesurface->surface) {
+        return IVI_SHAREBUFFER_NOT_AVAILABLE;
+    }
+
+    struct weston_buffer *buffer = p_nativesurface->surface->buffer_ref.buffer;
+    if (!buffer) {
+        return IVI_SHAREBUFFER_NOT_AVAILABLE;
+    }
+
+    uint32_t width, height, stride, format;
+    struct wl_shm_buffer *shm_buffer = wl_shm_buffer_get(buffer->resource);
+    if (shm_buffer) {
+        width  = wl_shm_buffer_get_width(shm_buffer);
+        height = wl_shm_buffer_get_height(shm_buffer);
+        stride = wl_shm_buffer_get_stride(shm_buffer);
+        format = wl_shm_buffer_get_format(shm_buffer);
+    } else {
+        int32_t content_width, content_height;
+
+        /* read back by the renderer as PIXMAN_a8b8g8r8 */
+        weston_surface_get_content_size(p_nativesurface->surface,
+                                        &content_width, &content_height);
+        if (content_width <= 0 || content_height <= 0) {
+            return IVI_SHAREBUFFER_NOT_AVAILABLE;
+        }
+        width  = content_width;
+        height = content_height;
+        stride = width * 4;
+        format = WL_SHM_FORMAT_ABGR8888;
+    }
+
+    uint32_t ret = IVI_SHAREBUFFER_STABLE;
+
+    /* every commit is a new frame, the same wl_shm buffer is usually
+     * reattached after drawing into it */
+    if (p_nativesurface->committed || p_nativesurface->shm_frame == 0) {
+        p_nativesurface->committed = false;
+        if (++p_nativesurface->shm_frame == 0)
+            p_nativesurface->shm_frame = 1;
+    }
+
+    if (p_nativesurface->shm_frame != p_nativesurface->name) {
+        ret |= IVI_SHAREBUFFER_DAMAGE;
+    }
+    if ((width != p_nativesurface->width) ||
+        (height != p_nativesurface->height) ||
+        (stride != p_nativesurface->stride) ||
+        (format != p_nativesurface->shm_format)) {
+        ret |= IVI_SHAREBUFFER_CONFIGURE;
+    }
+
+    p_nativesurface->name       = p_nativesurface->shm_frame;
+    p_nativesurface->width      = width;
+    p_nativesurface->height     = height;
+    p_nativesurface->stride     = stride;
+    p_nativesurface->shm_format = format;
+    p_nativesurface->format     = to_share_format(format);
+
+    return ret;
+}
+
+/* Returns 1 if the slot had to be (re)allocated, 0 if it was reused and -1
+ * on failure. */
+int
+copy_to_shm_slot(struct ivi_share_nativesurface *p_nativesurface, int slot)
+{
+    struct ivi_share_shm_slot *shm_slot = &p_nativesurface->shm_slots[slot];
+    struct weston_buffer *buffer = p_nativesurface->surface->buffer_ref.buffer;
+    uint32_t size = p_nativesurface->stride * p_nativesurface->height;
+    struct wl_shm_buffer *shm_buffer;
+    int allocated = 0;
+
+    if (buffer == NULL || size == 0)
+        return -1;
+
+    if (shm_slot->fd < 0 || shm_slot->size < size) {
+        release_shm_slot(shm_slot);
+
+        shm_slot->fd = create_shm_file(size);
+        if (shm_slot->fd < 0) {
+            weston_log("Buffer Sharing, failed to create shm file of %u bytes\n",
+                       size);
+            return -1;
+        }
+
+        shm_slot->data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                              shm_slot->fd, 0);
+        if (shm_slot->data == MAP_FAILED) {
+            weston_log("Buffer Sharing, failed to mmap shm file: %m\n");
+            close(shm_slot->fd);
+            shm_slot->fd = -1;
+            shm_slot->data = NULL;
+            return -1;
+        }
+
+        shm_slot->size = size;
+        allocated = 1;
+    }
+
+    shm_buffer = wl_shm_buffer_get(buffer->resource);
+    if (shm_buffer) {
+        wl_shm_buffer_begin_access(shm_buffer);
+        memcpy(shm_slot->data, wl_shm_buffer_get_data(shm_buffer), size);
+        wl_shm_buffer_end_access(shm_buffer);
+    } else if (weston_surface_copy_content(p_nativesurface->surface,
+                                           shm_slot->data, size, 0, 0,
+                                           p_nativesurface->width,
+                                           p_nativesurface->height) < 0) {
+        weston_log("Buffer Sharing, failed to read back surface %u\n",
+                   p_nativesurface->surface_id);
+        return -1;
+    }
+
+    return allocated;
+}
@@ -19,8 +19,10 @@
 #include <stdio.h>
 
 #include <fcntl.h>
+#include <unistd.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 
 #include "ivi-share.h"
 #include "ivi-share-server-protocol.h"
@@ -39,6 +41,27 @@ struct ivi_share_nativesurface_client_link
     struct wl_list link;                         /* ivi_share_nativesurface link */
     struct ivi_share_nativesurface *parent;
     bool empty;
+    uint32_t type;                               /* IVI_SHARE_SURFACE_TYPE_* */
+    uint32_t held_refs;                          /* bitmask of held buffer_refs */
+    uint32_t shm_slots_sent;                     /* bitmask of announced shm_slots */
+    bool damage_full;                            /* no frame since configure */
+    pixman_region32_t damage;                    /* damage since the last frame sent */
+    uint32_t frame_interval;                     /* minimum msec between frames, 0 = off */
+    uint32_t last_frame_msec;
+    bool frame_pending;                          /* a throttled frame is outstanding */
+    struct wl_event_source *frame_timer;
+    struct weston_seat *seat;                    /* cached seat for touch redirection */
+    struct wl_listener seat_destroy_listener;
+    struct wl_list release_fences;               /* share_release_fence list */
+};
+
+struct share_release_fence
+{
+    struct ivi_share_nativesurface_client_link *client_link;
+    struct wl_event_source *source;
+    int32_t fd;
+    uint32_t name;
+    struct wl_list link;                         /* client_link release_fences */
 };
 
 struct shell_surface
@@ -58,14 +81,21 @@ struct redirect_target {
     struct wl_list link;
 };
 
-struct update_sharing_surface_content {
-    struct wl_listener listener;
-    struct ivi_shell_share_ext *shell_ext;
-};
-
 static void
 send_to_client(struct ivi_share_nativesurface *p_nativesurface, uint32_t send_flag);
 
+static void
+update_nativesurface(struct ivi_share_nativesurface *p_nativesurface);
+
+static void
+send_damage_to_clients(struct ivi_share_nativesurface *p_nativesurface, int slot,
+                       uint32_t name,
+                       struct ivi_share_nativesurface_client_link *target);
+
+static void
+send_current_buffer(struct ivi_share_nativesurface *p_nativesurface,
+                    struct ivi_share_nativesurface_client_link *client_link);
+
 static void
 free_nativesurface(struct ivi_share_nativesurface *nativesurf)
 {
@@ -73,8 +103,21 @@ free_nativesurface(struct ivi_share_nativesurface *nativesurf)
         return;
     }
 
+    if (nativesurf->total_frames_skipped != 0) {
+        weston_log("Buffer Sharing surface %u: %llu frames sent, %llu skipped\n",
+                   nativesurf->surface_id,
+                   (unsigned long long)nativesurf->total_frames_sent,
+                   (unsigned long long)nativesurf->total_frames_skipped);
+    }
+
     nativesurf->surface_destroy_listener.notify = NULL;
     wl_list_remove(&nativesurf->surface_destroy_listener.link);
+    wl_list_remove(&nativesurf->surface_commit_listener.link);
+#ifdef IVI_SHARE_GBM
+    release_buffer_cache(nativesurf);
+#endif
+    release_shm_slots(nativesurf);
+    pixman_region32_fini(&nativesurf->damage);
     free(nativesurf);
 }
 
@@ -120,6 +163,75 @@ get_weston_seat(struct weston_compositor *compositor,
     return NULL;
 }
 
+static void
+reset_cached_seat(struct ivi_share_nativesurface_client_link *client_link)
+{
+    if (client_link->seat == NULL)
+        return;
+
+    wl_list_remove(&client_link->seat_destroy_listener.link);
+    client_link->seat = NULL;
+}
+
+static void
+cached_seat_destroyed(struct wl_listener *listener, void *data)
+{
+    struct ivi_share_nativesurface_client_link *client_link =
+        container_of(listener, struct ivi_share_nativesurface_client_link,
+                     seat_destroy_listener);
+    (void)data;
+
+    reset_cached_seat(client_link);
+}
+
+/* The seat lookup walks all seats and their resources, so it is only done
+ * once per share surface and whenever the cached seat lost touch. */
+static struct weston_seat *
+get_cached_seat(struct ivi_share_nativesurface_client_link *client_link)
+{
+    struct weston_seat *seat;
+
+    if (client_link->parent == NULL || client_link->parent->surface == NULL)
+        return NULL;
+
+    if (client_link->seat != NULL && client_link->seat->touch_state != NULL)
+        return client_link->seat;
+
+    reset_cached_seat(client_link);
+
+    seat = get_weston_seat(client_link->parent->shell_ext->wc, client_link);
+    if (seat == NULL)
+        return NULL;
+
+    client_link->seat = seat;
+    client_link->seat_destroy_listener.notify = cached_seat_destroyed;
+    wl_signal_add(&seat->destroy_signal, &client_link->seat_destroy_listener);
+
+    return seat;
+}
+
+/* wl_touch of the producer of the shared surface */
+static struct wl_resource *
+get_target_touch_resource(struct ivi_share_nativesurface_client_link *client_link)
+{
+    struct weston_seat *seat = get_cached_seat(client_link);
+    struct wl_resource *target_resource = NULL;
+    struct wl_client *target_client;
+
+    if (seat == NULL || seat->touch_state == NULL) {
+        return NULL;
+    }
+
+    target_client = wl_resource_get_client(client_link->parent->surface->resource);
+    wl_list_for_each(target_resource, &seat->touch_state->resource_list, link) {
+        if (wl_resource_get_client(target_resource) == target_client) {
+            return target_resource;
+        }
+    }
+
+    return NULL;
+}
+
 static uint32_t
 get_event_time()
 {
@@ -130,6 +242,64 @@ get_event_time()
     return (tv.tv_sec * 1000 + tv.tv_usec / 1000);
 }
 
+static uint32_t
+get_monotonic_msec()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static void
+send_redirect_touch_down(struct ivi_share_nativesurface_client_link *client_link,
+                         struct wl_client *client,
+                         struct wl_resource *resource,
+                         struct wl_resource *target_resource,
+                         uint32_t time, int32_t id,
+                         wl_fixed_t x, wl_fixed_t y)
+{
+    struct ivi_shell_share_ext *shell_ext = client_link->parent->shell_ext;
+    struct redirect_target *redirect_target = NULL;
+    uint32_t new_serial = wl_display_next_serial(shell_ext->wc->wl_display);
+
+    wl_touch_send_down(target_resource, new_serial, time,
+                       client_link->parent->surface->resource, id, x, y);
+
+    redirect_target = malloc(sizeof *redirect_target);
+    if (redirect_target == NULL) {
+        return;
+    }
+    redirect_target->client = client;
+    redirect_target->resource = resource;
+    redirect_target->target_resource = target_resource;
+    redirect_target->id = id;
+    wl_list_insert(&shell_ext->list_redirect_target, &redirect_target->link);
+}
+
+static void
+send_redirect_touch_up(struct ivi_shell_share_ext *shell_ext,
+                       struct wl_client *client,
+                       struct wl_resource *resource,
+                       uint32_t time, int32_t id)
+{
+    struct redirect_target *redirect_target = NULL;
+    struct redirect_target *next = NULL;
+
+    wl_list_for_each_safe(redirect_target, next, &shell_ext->list_redirect_target, link) {
+        if (client == redirect_target->client &&
+            resource == redirect_target->resource &&
+            id == redirect_target->id) {
+            uint32_t new_serial = wl_display_next_serial(shell_ext->wc->wl_display);
+            wl_touch_send_up(redirect_target->target_resource, new_serial, time, id);
+            wl_list_remove(&redirect_target->link);
+            free(redirect_target);
+            break;
+        }
+    }
+}
+
 static void
 share_surface_redirect_touch_down(struct wl_client *client,
                                   struct wl_resource *resource,
@@ -139,39 +309,20 @@ share_surface_redirect_touch_down(struct wl_client *client,
                                   wl_fixed_t y)
 {
     struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
-    struct weston_seat *seat = NULL;
     struct wl_resource *target_resource = NULL;
-    uint32_t time = get_event_time();
-    struct redirect_target *redirect_target = NULL;
-    struct wl_resource *surface_resource;
 
     if (client_link->parent == NULL) {
         weston_log("share_surface_redirect_touch_down: No parent surface\n");
         return;
     }
-    surface_resource = client_link->parent->surface->resource;
 
-    seat = get_weston_seat(client_link->parent->shell_ext->wc, client_link);
-    if (seat == NULL || seat->touch_state == NULL) {
+    target_resource = get_target_touch_resource(client_link);
+    if (target_resource == NULL) {
         return;
     }
 
-    wl_list_for_each(target_resource, &seat->touch_state->resource_list, link) {
-        if (wl_resource_get_client(target_resource) == wl_resource_get_client(surface_resource)) {
-            uint32_t new_serial =
-                wl_display_next_serial(client_link->parent->shell_ext->wc->wl_display);
-            wl_touch_send_down(target_resource, new_serial, time, surface_resource, id, x, y);
-
-            redirect_target = malloc(sizeof *redirect_target);
-            redirect_target->client = client;
-            redirect_target->resource = resource;
-            redirect_target->target_resource = target_resource;
-            redirect_target->id = id;
-            wl_list_insert(&client_link->parent->shell_ext->list_redirect_target, &redirect_target->link);
-
-            break;
-        }
-    }
+    send_redirect_touch_down(client_link, client, resource, target_resource,
+                             get_event_time(), id, x, y);
 }
 
 static void
@@ -181,21 +332,14 @@ share_surface_redirect_touch_up(struct wl_client *client,
                                 int32_t id)
 {
     struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
-    struct redirect_target *redirect_target = NULL;
-    struct redirect_target *next = NULL;
-    uint32_t new_serial = wl_display_next_serial(client_link->parent->shell_ext->wc->wl_display);
-    uint32_t time = get_event_time();
 
-    wl_list_for_each_safe(redirect_target, next, &client_link->parent->shell_ext->list_redirect_target, link) {
-        if (client == redirect_target->client &&
-            resource == redirect_target->resource &&
-            id == redirect_target->id) {
-            wl_touch_send_up(redirect_target->target_resource, new_serial, time, id);
-            wl_list_remove(&redirect_target->link);
-            free(redirect_target);
-            break;
-        }
+    if (client_link->parent == NULL) {
+        weston_log("share_surface_redirect_touch_up: No parent surface\n");
+        return;
     }
+
+    send_redirect_touch_up(client_link->parent->shell_ext, client, resource,
+                           get_event_time(), id);
 }
 
 static void
@@ -206,27 +350,16 @@ share_surface_redirect_touch_motion(struct wl_client *client,
                                     wl_fixed_t y)
 {
     struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
-    struct weston_seat *seat = NULL;
     struct wl_resource *target_resource = NULL;
-    uint32_t time = get_event_time();
-    struct wl_resource *surface_resource;
 
     if (client_link->parent == NULL) {
         weston_log("share_surface_redirect_touch_motion: No parent surface\n");
         return;
     }
-    surface_resource = client_link->parent->surface->resource;
 
-    seat = get_weston_seat(client_link->parent->shell_ext->wc, client_link);
-    if (seat == NULL || seat->touch_state == NULL) {
-        return;
-    }
-
-    wl_list_for_each(target_resource, &seat->touch_state->resource_list, link) {
-        if (wl_resource_get_client(target_resource) == wl_resource_get_client(surface_resource)) {
-            wl_touch_send_motion(target_resource, time, id, x, y);
-            break;
-        }
+    target_resource = get_target_touch_resource(client_link);
+    if (target_resource != NULL) {
+        wl_touch_send_motion(target_resource, get_event_time(), id, x, y);
     }
 }
 
@@ -235,20 +368,10 @@ share_surface_redirect_touch_frame(struct wl_client *client,
                                    struct wl_resource *resource)
 {
     struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
-    struct weston_seat *seat = NULL;
-    struct wl_resource *target_resource = NULL;
-    struct wl_resource *surface_resource = client_link->parent->surface->resource;
+    struct wl_resource *target_resource = get_target_touch_resource(client_link);
 
-    seat = get_weston_seat(client_link->parent->shell_ext->wc, client_link);
-    if (seat == NULL || seat->touch_state == NULL) {
-        return;
-    }
-
-    wl_list_for_each(target_resource, &seat->touch_state->resource_list, link) {
-        if (wl_resource_get_client(target_resource) == wl_resource_get_client(surface_resource)) {
-            wl_touch_send_frame(target_resource);
-            break;
-        }
+    if (target_resource != NULL) {
+        wl_touch_send_frame(target_resource);
     }
 }
 
@@ -257,51 +380,98 @@ share_surface_redirect_touch_cancel(struct wl_client *client,
                                     struct wl_resource *resource)
 {
     struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
-    struct weston_seat *seat = NULL;
+    struct wl_resource *target_resource = get_target_touch_resource(client_link);
+
+    if (target_resource != NULL) {
+        wl_touch_send_cancel(target_resource);
+    }
+}
+
+static void
+share_surface_redirect_touch_frame_batch(struct wl_client *client,
+                                         struct wl_resource *resource,
+                                         struct wl_array *points)
+{
+    struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
+    struct ivi_shell_share_ext *shell_ext;
     struct wl_resource *target_resource = NULL;
     uint32_t time = get_event_time();
-    struct wl_resource *surface_resource = client_link->parent->surface->resource;
+    int32_t *point;
 
-    seat = get_weston_seat(client_link->parent->shell_ext->wc, client_link);
-    if (seat == NULL || seat->touch_state == NULL) {
+    /* type, id, x and y of each touch point */
+    if (points->size % (4 * sizeof(int32_t)) != 0) {
+        wl_resource_post_error(resource, IVI_SHARE_SURFACE_ERROR_INVALID_TOUCH_BATCH,
+                               "touch batch size %zu is not a multiple of a point",
+                               points->size);
         return;
     }
 
-    wl_list_for_each(target_resource, &seat->touch_state->resource_list, link) {
-        if (wl_resource_get_client(target_resource) == wl_resource_get_client(surface_resource)) {
-            wl_touch_send_cancel(target_resource);
+    if (client_link->parent == NULL) {
+        weston_log("share_surface_redirect_touch_frame_batch: No parent surface\n");
+        return;
+    }
+    shell_ext = client_link->parent->shell_ext;
+
+    target_resource = get_target_touch_resource(client_link);
+
+    for (point = points->data;
+         (const char *)point < (const char *)points->data + points->size;
+         point += 4) {
+        switch ((uint32_t)point[0]) {
+        case IVI_SHARE_SURFACE_TOUCH_POINT_TYPE_DOWN:
+            if (target_resource != NULL)
+                send_redirect_touch_down(client_link, client, resource,
+                                         target_resource, time, point[1],
+                                         point[2], point[3]);
+            break;
+        case IVI_SHARE_SURFACE_TOUCH_POINT_TYPE_UP:
+            send_redirect_touch_up(shell_ext, client, resource, time, point[1]);
             break;
+        case IVI_SHARE_SURFACE_TOUCH_POINT_TYPE_MOTION:
+            if (target_resource != NULL)
+                wl_touch_send_motion(target_resource, time, point[1],
+                                     point[2], point[3]);
+            break;
+        default:
+            wl_resource_post_error(resource, IVI_SHARE_SURFACE_ERROR_INVALID_TOUCH_BATCH,
+                                   "unknown touch point type %u",
+                                   (uint32_t)point[0]);
+            return;
         }
     }
+
+    if (target_resource != NULL) {
+        wl_touch_send_frame(target_resource);
+    }
 }
 
 static void
-share_surface_release_shared_name(struct wl_client *client,
-                                  struct wl_resource *resource,
-                                  uint32_t name)
+release_shared_name(struct ivi_share_nativesurface_client_link *client_link,
+                    uint32_t name)
 {
-    struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
     struct ivi_share_nativesurface *p_nativesurface = client_link->parent;
+    bool is_released = false;
     int i;
 
     if (p_nativesurface == NULL)
         return;
 
-    bool is_released = false;
-
     for (i = 0; i < MAX_BUFFER_REFERENCE; i++) {
         struct ivi_share_buffer_reference *buffer_ref = &p_nativesurface->buffer_refs[i];
-        if ((buffer_ref->name == name) && (buffer_ref->client_count != 0)) {
-            if (!buffer_ref->next_to_release)
-                weston_log("unexpected buffer released from consumer\n");
-
-            buffer_ref->client_count--;
-            if (buffer_ref->client_count == 0) {
-                weston_buffer_reference(&buffer_ref->ref, NULL);
-                buffer_ref->name = 0;
-                buffer_ref->next_to_release = false;
-                is_released = true;
-            }
+        if ((buffer_ref->name != name) ||
+            !(client_link->held_refs & IVI_BIT(i)))
+            continue;
+
+        if (!buffer_ref->next_to_release)
+            weston_log("unexpected buffer released from consumer\n");
+
+        client_link->held_refs &= ~IVI_BIT(i);
+        buffer_ref->client_count--;
+        if (buffer_ref->client_count == 0) {
+            weston_buffer_reference(&buffer_ref->ref, NULL);
+            buffer_ref->name = 0;
+            buffer_ref->next_to_release = false;
+            is_released = true;
         }
     }
 
@@ -312,8 +482,174 @@ share_surface_release_shared_name(struct wl_client *client,
         }
     }
 
-    p_nativesurface->send_flag = update_buffer_nativesurface(p_nativesurface);
-    send_to_client(p_nativesurface, p_nativesurface->send_flag);
+    update_nativesurface(p_nativesurface);
+}
+
+static void
+share_surface_release_shared_name(struct wl_client *client,
+                                  struct wl_resource *resource,
+                                  uint32_t name)
+{
+    struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
+
+    release_shared_name(client_link, name);
+}
+
+static void
+destroy_release_fence(struct share_release_fence *fence)
+{
+    wl_event_source_remove(fence->source);
+    close(fence->fd);
+    wl_list_remove(&fence->link);
+    free(fence);
+}
+
+static int
+release_fence_signalled(int fd, uint32_t mask, void *data)
+{
+    struct share_release_fence *fence = data;
+    struct ivi_share_nativesurface_client_link *client_link = fence->client_link;
+    uint32_t name = fence->name;
+
+    /* sync_file fds become readable once signalled; errors release as well,
+     * the buffer would be stuck otherwise */
+    destroy_release_fence(fence);
+    release_shared_name(client_link, name);
+
+    return 0;
+}
+
+static void
+share_surface_release_shared_name_with_fence(struct wl_client *client,
+                                             struct wl_resource *resource,
+                                             uint32_t name,
+                                             int32_t fence_fd)
+{
+    struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
+    struct share_release_fence *fence;
+    struct wl_event_loop *loop;
+
+    if (client_link->parent == NULL) {
+        close(fence_fd);
+        return;
+    }
+
+    fence = calloc(1, sizeof *fence);
+    if (fence == NULL) {
+        close(fence_fd);
+        wl_client_post_no_memory(client);
+        return;
+    }
+
+    loop = wl_display_get_event_loop(client_link->parent->shell_ext->wc->wl_display);
+    fence->source = wl_event_loop_add_fd(loop, fence_fd, WL_EVENT_READABLE,
+                                         release_fence_signalled, fence);
+    if (fence->source == NULL) {
+        weston_log("Buffer Sharing, failed to wait for release fence\n");
+        close(fence_fd);
+        free(fence);
+        release_shared_name(client_link, name);
+        return;
+    }
+
+    fence->client_link = client_link;
+    fence->fd = fence_fd;
+    fence->name = name;
+    wl_list_insert(&client_link->release_fences, &fence->link);
+}
+
+static void
+share_surface_set_buffer_count(struct wl_client *client,
+                               struct wl_resource *resource,
+                               uint32_t count)
+{
+    struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
+    struct ivi_share_nativesurface *p_nativesurface = client_link->parent;
+
+    if ((count == 0) || (count > MAX_BUFFER_REFERENCE)) {
+        wl_resource_post_error(resource, IVI_SHARE_SURFACE_ERROR_INVALID_BUFFER_COUNT,
+                               "buffer count %u is not in range 1..%d",
+                               count, MAX_BUFFER_REFERENCE);
+        return;
+    }
+
+    if ((p_nativesurface == NULL) || (p_nativesurface->surface == NULL))
+        return;
+
+    if (count > p_nativesurface->buffer_ref_depth) {
+        p_nativesurface->buffer_ref_depth = count;
+
+        /* a frame may have been waiting for a free slot */
+        if (p_nativesurface->damage_pending)
+            update_nativesurface(p_nativesurface);
+    }
+}
+
+static int
+frame_timer_expired(void *data)
+{
+    struct ivi_share_nativesurface_client_link *client_link = data;
+    struct ivi_share_nativesurface *p_nativesurface = client_link->parent;
+    uint32_t name;
+    int i;
+
+    if (!client_link->frame_pending || (p_nativesurface == NULL) ||
+        (p_nativesurface->surface == NULL))
+        return 0;
+
+    /* hand out the newest buffer, preferably from the ring if the other
+     * consumers still hold it */
+    name = get_buffer_name(p_nativesurface);
+    for (i = 0; i < MAX_BUFFER_REFERENCE; i++) {
+        if (p_nativesurface->buffer_refs[i].name == name) {
+            send_damage_to_clients(p_nativesurface, i, name, client_link);
+            return 0;
+        }
+    }
+
+    for (i = 0; i < (int)p_nativesurface->buffer_ref_depth; i++) {
+        if (p_nativesurface->buffer_refs[i].client_count == 0) {
+            send_damage_to_clients(p_nativesurface, i, name, client_link);
+            return 0;
+        }
+    }
+
+    /* ring is full, try again later */
+    wl_event_source_timer_update(client_link->frame_timer,
+                                 client_link->frame_interval);
+    return 0;
+}
+
+static void
+share_surface_set_max_frame_rate(struct wl_client *client,
+                                 struct wl_resource *resource,
+                                 uint32_t fps)
+{
+    struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
+    struct wl_event_loop *loop;
+
+    if (fps == 0) {
+        client_link->frame_interval = 0;
+        if (client_link->frame_timer != NULL) {
+            wl_event_source_remove(client_link->frame_timer);
+            client_link->frame_timer = NULL;
+        }
+        if (client_link->frame_pending && (client_link->parent != NULL))
+            frame_timer_expired(client_link);
+        return;
+    }
+
+    client_link->frame_interval = (fps >= 1000) ? 1 : 1000 / fps;
+
+    if (client_link->frame_timer == NULL) {
+        loop = wl_display_get_event_loop(wl_client_get_display(client));
+        client_link->frame_timer = wl_event_loop_add_timer(loop, frame_timer_expired,
+                                                           client_link);
+        if (client_link->frame_timer == NULL) {
+            weston_log("Buffer Sharing, failed to create frame rate timer\n");
+            client_link->frame_interval = 0;
+        }
+    }
 }
 
 static const
@@ -324,7 +660,11 @@ struct ivi_share_surface_interface share_surface_implementation = {
     share_surface_redirect_touch_motion,
     share_surface_redirect_touch_frame,
     share_surface_redirect_touch_cancel,
-    share_surface_release_shared_name
+    share_surface_release_shared_name,
+    share_surface_set_buffer_count,
+    share_surface_release_shared_name_with_fence,
+    share_surface_set_max_frame_rate,
+    share_surface_redirect_touch_frame_batch
 };
 
 static struct shell_surface *
@@ -363,6 +703,8 @@ remove_nativesurface(struct ivi_share_nativesurface *nativesurf)
         /* Initialize information about shared surface */
         p_link->parent = NULL;
         p_link->firstSendConfigureComp = false;
+        p_link->held_refs = 0;
+        reset_cached_seat(p_link);
         wl_list_remove(&p_link->link);
         wl_list_init(&p_link->link);
     }
@@ -388,6 +730,62 @@ nativesurface_destroy(struct wl_listener *listener, void *data)
     }
 }
 
+uint32_t
+get_buffer_name(struct ivi_share_nativesurface *p_nativesurface)
+{
+    return p_nativesurface->name;
+}
+
+static void
+update_nativesurface(struct ivi_share_nativesurface *p_nativesurface)
+{
+    if (p_nativesurface->bufferType == IVI_SHARE_SURFACE_TYPE_SHM)
+        p_nativesurface->send_flag = update_buffer_nativesurface_shm(p_nativesurface);
+    else
+#ifdef IVI_SHARE_GBM
+        p_nativesurface->send_flag = update_buffer_nativesurface(p_nativesurface);
+#else
+        p_nativesurface->send_flag = IVI_SHAREBUFFER_NOT_AVAILABLE;
+#endif
+    send_to_client(p_nativesurface, p_nativesurface->send_flag);
+}
+
+static void
+accumulate_damage(struct ivi_share_nativesurface *p_nativesurface)
+{
+    struct weston_surface *surface = p_nativesurface->surface;
+    pixman_box32_t *rects;
+    int n_rects, i;
+
+    /* surface->damage holds the commits since the last repaint, in surface
+     * coordinates; consumers work on buffer contents */
+    rects = pixman_region32_rectangles(&surface->damage, &n_rects);
+    for (i = 0; i < n_rects; i++) {
+        pixman_box32_t box = weston_surface_to_buffer_rect(surface, rects[i]);
+
+        pixman_region32_union_rect(&p_nativesurface->damage,
+                                   &p_nativesurface->damage,
+                                   box.x1, box.y1,
+                                   box.x2 - box.x1, box.y2 - box.y1);
+    }
+}
+
+static void
+nativesurface_commit(struct wl_listener *listener, void *data)
+{
+    struct ivi_share_nativesurface *nativesurf =
+        container_of(listener, struct ivi_share_nativesurface,
+                     surface_commit_listener);
+    (void)data;
+
+    nativesurf->committed = true;
+    accumulate_damage(nativesurf);
+
+    /* only surfaces which actually committed are looked at, so idle shared
+     * surfaces and additional outputs do not cost anything */
+    update_nativesurface(nativesurf);
+}
+
 struct ivi_share_nativesurface*
 alloc_share_nativesurface(struct weston_surface *surface, uint32_t id, uint32_t surface_id,
                           uint32_t bufferType, uint32_t format,
@@ -405,21 +803,30 @@ alloc_share_nativesurface(struct weston_surface *surface, uint32_t id, uint32_t
     nativesurface->format = format;
     nativesurface->surface_id = surface_id;
     nativesurface->shell_ext = shell_ext;
+    nativesurface->buffer_ref_depth = DEFAULT_BUFFER_REFERENCE;
+    for (int i = 0; i < MAX_BUFFER_REFERENCE; i++) {
+        nativesurface->shm_slots[i].fd = -1;
+    }
+    pixman_region32_init(&nativesurface->damage);
     wl_list_init(&nativesurface->client_list);
+    /* placeholders without a surface are freed the same way */
+    wl_list_init(&nativesurface->surface_destroy_listener.link);
+    wl_list_init(&nativesurface->surface_commit_listener.link);
 
     if (NULL != surface) {
         nativesurface->surface_destroy_listener.notify = nativesurface_destroy;
         wl_signal_add(&surface->destroy_signal, &nativesurface->surface_destroy_listener);
+        nativesurface->surface_commit_listener.notify = nativesurface_commit;
+        wl_signal_add(&surface->commit_signal, &nativesurface->surface_commit_listener);
     }
 
     return nativesurface;
 }
 
 static void
-destroy_buffer_ref(struct ivi_share_buffer_reference *buf_ref, int version)
+destroy_buffer_ref(struct ivi_share_buffer_reference *buf_ref, bool held)
 {
-    if ((buf_ref->client_count != 0) &&
-        (version >= IVI_SHARE_SURFACE_RELEASE_SHARED_NAME_SINCE_VERSION))
+    if ((buf_ref->client_count != 0) && held)
         buf_ref->client_count--;
 
     if (buf_ref->client_count == 0) {
@@ -433,23 +840,47 @@ static void
 destroy_client_link(struct wl_resource *resource)
 {
     struct ivi_share_nativesurface_client_link *client_link = wl_resource_get_user_data(resource);
-    int version = wl_resource_get_version(resource);
     struct ivi_share_nativesurface *p_nativesurface = client_link->parent;
+    struct share_release_fence *fence, *fence_next;
+
+    /* buffers still waiting for a fence are released with the link */
+    wl_list_for_each_safe(fence, fence_next, &client_link->release_fences, link)
+        destroy_release_fence(fence);
+
+    if (client_link->frame_timer != NULL) {
+        wl_event_source_remove(client_link->frame_timer);
+        client_link->frame_timer = NULL;
+    }
+    pixman_region32_fini(&client_link->damage);
+    reset_cached_seat(client_link);
 
     if (p_nativesurface == NULL)
         return;
 
     for (int i = 0; i < MAX_BUFFER_REFERENCE; i++) {
-        destroy_buffer_ref(&p_nativesurface->buffer_refs[i], version);
+        destroy_buffer_ref(&p_nativesurface->buffer_refs[i],
+                           client_link->held_refs & IVI_BIT(i));
     }
 
     wl_list_remove(&client_link->link);
     free(client_link);
+
+    /* nobody is interested in this surface anymore, stop following its
+     * commits */
+    if (wl_list_empty(&p_nativesurface->client_list) &&
+        (p_nativesurface->surface != NULL)) {
+        for (int i = 0; i < MAX_BUFFER_REFERENCE; i++) {
+            weston_buffer_reference(&p_nativesurface->buffer_refs[i].ref, NULL);
+        }
+        wl_list_remove(&p_nativesurface->link);
+        free_nativesurface(p_nativesurface);
+    }
 }
 
 static struct ivi_share_nativesurface_client_link *
 add_nativesurface_client(struct ivi_share_nativesurface *nativesurface,
-                         uint32_t id, struct wl_client *client, uint32_t version)
+                         uint32_t id, struct wl_client *client, uint32_t version,
+                         uint32_t type)
 {
     struct ivi_share_nativesurface_client_link *link = malloc(sizeof(*link));
     if (NULL == link) {
@@ -461,6 +892,17 @@ add_nativesurface_client(struct ivi_share_nativesurface *nativesurface,
     link->firstSendConfigureComp = false;
     link->parent = nativesurface;
     link->empty = (nativesurface->surface == NULL) ? true : false;
+    link->type = type;
+    link->held_refs = 0;
+    link->shm_slots_sent = 0;
+    link->damage_full = true;
+    pixman_region32_init(&link->damage);
+    link->frame_interval = 0;
+    link->last_frame_msec = 0;
+    link->frame_pending = false;
+    link->frame_timer = NULL;
+    link->seat = NULL;
+    wl_list_init(&link->release_fences);
 
     wl_resource_set_implementation(link->resource, &share_surface_implementation,
                                    link, destroy_client_link);
@@ -484,16 +926,47 @@ create_empty_nativesurface_client(struct wl_client *client,
         return NULL;
     }
 
-    return add_nativesurface_client(nativesurf, id, client, version);
+    return add_nativesurface_client(nativesurf, id, client, version,
+                                    IVI_SHARE_SURFACE_TYPE_GBM);
+}
+
+static uint32_t
+get_buffer_type(uint32_t type)
+{
+    /* every type gets a nativesurface of its own: shm consumers need a copy
+     * of the content, and dmabuf consumers must not be handed the global
+     * flink names which are created while a gbm consumer is attached */
+    if (type == IVI_SHARE_SURFACE_TYPE_SHM || type == IVI_SHARE_SURFACE_TYPE_DMABUF)
+        return type;
+
+    return IVI_SHARE_SURFACE_TYPE_GBM;
+}
+
+static bool
+is_share_type_supported(uint32_t type)
+{
+    switch (type) {
+#ifdef IVI_SHARE_GBM
+    case IVI_SHARE_SURFACE_TYPE_GBM:
+    case IVI_SHARE_SURFACE_TYPE_DMABUF:
+        return true;
+#endif
+    case IVI_SHARE_SURFACE_TYPE_SHM:
+        return true;
+    default:
+        return false;
+    }
 }
 
 static struct ivi_share_nativesurface*
-find_nativesurface(struct shell_surface *shsurf, struct ivi_shell_share_ext *shell_ext)
+find_nativesurface(struct shell_surface *shsurf, struct ivi_shell_share_ext *shell_ext,
+                   uint32_t bufferType)
 {
     struct ivi_share_nativesurface *nativesurf = NULL;
 
     wl_list_for_each(nativesurf, &shell_ext->list_nativesurface, link) {
-        if (shsurf->surface_id == nativesurf->surface_id) {
+        if ((shsurf->surface_id == nativesurf->surface_id) &&
+            (bufferType == nativesurf->bufferType)) {
             return nativesurf;
         }
     }
@@ -505,7 +978,7 @@ get_shared_client_input_caps(struct ivi_share_nativesurface_client_link *client_
                              struct ivi_shell_share_ext *shell_ext)
 {
     uint32_t caps = 0;
-    struct weston_seat *seat = get_weston_seat(shell_ext->wc, client_link);
+    struct weston_seat *seat = get_cached_seat(client_link);
     struct wl_client *creator = wl_resource_get_client(client_link->parent->surface->resource);
 
     if ((seat != NULL) && (seat->touch_state != NULL)) {
@@ -539,8 +1012,8 @@ send_share_surface_state(struct ivi_share_nativesurface_client_link *client_link
 }
 
 static void
-share_get_ivi_share_surface(struct wl_client *client, struct wl_resource *resource,
-                            uint32_t id, uint32_t surface_id)
+get_share_surface(struct wl_client *client, struct wl_resource *resource,
+                  uint32_t id, uint32_t surface_id, uint32_t type)
 {
     struct ivi_shell_share_ext *shell_ext = wl_resource_get_user_data(resource);
     struct ivi_layout_surface *layout_surface;
@@ -550,6 +1023,24 @@ share_get_ivi_share_surface(struct wl_client *client, struct wl_resource *resour
     struct ivi_share_nativesurface_client_link *client_link = NULL;
     uint32_t caps = 0;
     uint32_t version = wl_resource_get_version(resource);
+    uint32_t bufferType = get_buffer_type(type);
+    uint64_t frames_sent;
+
+    if (!is_share_type_supported(type)) {
+        client_link = create_empty_nativesurface_client(client, id, version, shell_ext);
+        if (NULL == client_link) {
+            wl_client_post_no_memory(client);
+            return;
+        }
+        /* older clients do not know unsupported_type */
+        if (version >= IVI_SHARE_SURFACE_SHARE_SURFACE_STATE_UNSUPPORTED_TYPE_SINCE_VERSION)
+            send_share_surface_state(client_link,
+                                     IVI_SHARE_SURFACE_SHARE_SURFACE_STATE_UNSUPPORTED_TYPE);
+        else
+            send_share_surface_state(client_link,
+                                     IVI_SHARE_SURFACE_SHARE_SURFACE_STATE_INVALID_SURFACE);
+        return;
+    }
 
     layout_surface = shell_ext->controller_interface->get_surface_from_id(surface_id);
     surface = shell_ext->controller_interface->surface_get_weston_surface(layout_surface);
@@ -570,10 +1061,10 @@ share_get_ivi_share_surface(struct wl_client *client, struct wl_resource *resour
         shsurf->surface_id = surface_id;
     }
 
-    nativesurf = find_nativesurface(shsurf, shell_ext);
+    nativesurf = find_nativesurface(shsurf, shell_ext, bufferType);
     if (nativesurf == NULL) {
         nativesurf = alloc_share_nativesurface(shsurf->surface, id, shsurf->surface_id,
-                                               (int32_t)IVI_SHARE_SURFACE_TYPE_GBM,
+                                               bufferType,
                                                (int32_t)IVI_SHARE_SURFACE_FORMAT_ARGB8888,
                                                shell_ext);
 
@@ -587,14 +1078,45 @@ share_get_ivi_share_surface(struct wl_client *client, struct wl_resource *resour
         wl_list_insert(&shell_ext->list_nativesurface, &nativesurf->link);
     }
 
-    client_link = add_nativesurface_client(nativesurf, id, client, version);
+    client_link = add_nativesurface_client(nativesurf, id, client, version, type);
+    if (NULL == client_link) {
+        wl_client_post_no_memory(client);
+        return;
+    }
 
     caps = get_shared_client_input_caps(client_link, shell_ext);
     ivi_share_surface_send_input_capabilities(client_link->resource, caps);
+
+    /* the producer may be idle, hand out its current buffer right away */
+    frames_sent = nativesurf->total_frames_sent;
+    update_nativesurface(nativesurf);
+
+    /* an unchanged buffer already has a slot and is not sent again by
+     * update_nativesurface, the new consumer still needs it */
+    if (nativesurf->total_frames_sent == frames_sent)
+        send_current_buffer(nativesurf, client_link);
+}
+
+static void
+share_get_ivi_share_surface(struct wl_client *client, struct wl_resource *resource,
+                            uint32_t id, uint32_t surface_id)
+{
+    get_share_surface(client, resource, id, surface_id,
+                      IVI_SHARE_SURFACE_TYPE_GBM);
+}
+
+static void
+share_get_ivi_share_surface_with_type(struct wl_client *client,
+                                      struct wl_resource *resource,
+                                      uint32_t id, uint32_t surface_id,
+                                      uint32_t type)
+{
+    get_share_surface(client, resource, id, surface_id, type);
 }
 
 static struct ivi_share_interface g_share_implementation = {
-    share_get_ivi_share_surface
+    share_get_ivi_share_surface,
+    share_get_ivi_share_surface_with_type
 };
 
 static struct ivi_shell_share_ext*
@@ -618,15 +1140,15 @@ init_ivi_shell_share_ext(struct weston_compositor *wc,
 }
 
 static void
-send_configure(struct wl_resource *p_resource, uint32_t id,
+send_configure(struct ivi_share_nativesurface_client_link *p_link, uint32_t id,
                struct ivi_share_nativesurface *p_nativesurface)
 {
-    if ((NULL == p_resource) || (NULL == p_nativesurface)) {
+    if ((NULL == p_link->resource) || (NULL == p_nativesurface)) {
         return;
     }
 
-    ivi_share_surface_send_configure(p_resource,
-                                     p_nativesurface->bufferType,
+    ivi_share_surface_send_configure(p_link->resource,
+                                     p_link->type,
                                      p_nativesurface->width,
                                      p_nativesurface->height,
                                      p_nativesurface->stride / 4,
@@ -642,6 +1164,103 @@ send_damage(struct wl_resource *p_resource, uint32_t id, uint32_t name)
     ivi_share_surface_send_damage(p_resource, name);
 }
 
+#ifdef IVI_SHARE_GBM
+static void
+send_dmabuf_damage(struct wl_resource *p_resource,
+                   struct ivi_share_nativesurface *p_nativesurface,
+                   uint32_t name)
+{
+    const struct ivi_share_dmabuf *dmabuf = get_buffer_dmabuf(p_nativesurface);
+    uint32_t i;
+
+    if (!p_resource)
+        return;
+
+    if (dmabuf == NULL) {
+        weston_log("Buffer Sharing, no dmabuf exported for buffer %u\n", name);
+        return;
+    }
+
+    for (i = 0; i < dmabuf->n_planes; i++) {
+        ivi_share_surface_send_dmabuf_plane(p_resource, i, dmabuf->fd[i],
+                                            dmabuf->offset[i],
+                                            dmabuf->stride[i],
+                                            (uint32_t)(dmabuf->modifier >> 32),
+                                            (uint32_t)(dmabuf->modifier & 0xffffffff));
+    }
+
+    ivi_share_surface_send_dmabuf_damage(p_resource, name,
+                                         p_nativesurface->width,
+                                         p_nativesurface->height,
+                                         dmabuf->format,
+                                         dmabuf->n_planes);
+}
+#endif
+
+static void
+send_shm_damage(struct ivi_share_nativesurface_client_link *p_link,
+                struct ivi_share_nativesurface *p_nativesurface,
+                int slot, uint32_t name)
+{
+    struct ivi_share_shm_slot *shm_slot = &p_nativesurface->shm_slots[slot];
+
+    if (!p_link->resource)
+        return;
+
+    if (!(p_link->shm_slots_sent & IVI_BIT(slot))) {
+        ivi_share_surface_send_shm_pool(p_link->resource, slot,
+                                        shm_slot->fd, shm_slot->size);
+        p_link->shm_slots_sent |= IVI_BIT(slot);
+    }
+
+    ivi_share_surface_send_shm_damage(p_link->resource, name, slot,
+                                      p_nativesurface->width,
+                                      p_nativesurface->height,
+                                      p_nativesurface->stride,
+                                      p_nativesurface->shm_format);
+}
+
+static void
+send_damage_region(struct ivi_share_nativesurface_client_link *p_link)
+{
+    pixman_box32_t *rects;
+    struct wl_array array;
+    int32_t *r;
+    int n_rects, i;
+
+    if (!p_link->resource ||
+        (wl_resource_get_version(p_link->resource) <
+         IVI_SHARE_SURFACE_DAMAGE_REGION_SINCE_VERSION))
+        return;
+
+    /* the consumer has no previous content to update */
+    if (p_link->damage_full)
+        return;
+
+    rects = pixman_region32_rectangles(&p_link->damage, &n_rects);
+    if (n_rects > IVI_SHARE_MAX_DAMAGE_RECTS) {
+        rects = pixman_region32_extents(&p_link->damage);
+        n_rects = 1;
+    }
+
+    wl_array_init(&array);
+    r = wl_array_add(&array, n_rects * 4 * sizeof(int32_t));
+    if (r == NULL) {
+        wl_array_release(&array);
+        return;
+    }
+
+    for (i = 0; i < n_rects; i++) {
+        *r++ = rects[i].x1;
+        *r++ = rects[i].y1;
+        *r++ = rects[i].x2 - rects[i].x1;
+        *r++ = rects[i].y2 - rects[i].y1;
+    }
+
+    ivi_share_surface_send_damage_region(p_link->resource, &array);
+    wl_array_release(&array);
+}
+
 static void
 bind_share_interface(struct wl_client *p_client, void *p_data,
                      uint32_t version, uint32_t id)
@@ -660,25 +1279,121 @@ bind_share_interface(struct wl_client *p_client, void *p_data,
                                    shell_ext, NULL);
 }
 
+static bool
+is_frame_throttled(struct ivi_share_nativesurface_client_link *p_link, uint32_t now)
+{
+    uint32_t elapsed = now - p_link->last_frame_msec;
+
+    if ((p_link->frame_interval == 0) || (p_link->frame_timer == NULL) ||
+        (elapsed >= p_link->frame_interval))
+        return false;
+
+    /* deliver the newest frame once the interval has passed, the producer
+     * may not commit again */
+    if (!p_link->frame_pending) {
+        p_link->frame_pending = true;
+        wl_event_source_timer_update(p_link->frame_timer,
+                                     p_link->frame_interval - elapsed);
+    }
+
+    return true;
+}
+
 static void
-send_damage_to_clients(struct ivi_share_nativesurface *p_nativesurface, struct ivi_share_buffer_reference *buf_ref, uint32_t name)
+send_frame_to_client(struct ivi_share_nativesurface_client_link *p_link,
+                     struct ivi_share_nativesurface *p_nativesurface,
+                     int slot, uint32_t now)
 {
-    struct ivi_share_nativesurface_client_link *p_link = NULL;
+    struct ivi_share_buffer_reference *buf_ref = &p_nativesurface->buffer_refs[slot];
+    uint32_t version = wl_resource_get_version(p_link->resource);
+
+    if (version >= IVI_SHARE_SURFACE_RELEASE_SHARED_NAME_SINCE_VERSION) {
+        buf_ref->client_count++;
+        p_link->held_refs |= IVI_BIT(slot);
+    }
+
+    if ((p_nativesurface->frames_skipped != 0) &&
+        (version >= IVI_SHARE_SURFACE_FRAMES_SKIPPED_SINCE_VERSION))
+        ivi_share_surface_send_frames_skipped(p_link->resource,
+                                              p_nativesurface->frames_skipped);
+
+    send_damage_region(p_link);
+    pixman_region32_clear(&p_link->damage);
+    p_link->damage_full = false;
+    p_link->frame_pending = false;
+    p_link->last_frame_msec = now;
+
+    if (p_link->type == IVI_SHARE_SURFACE_TYPE_SHM)
+        send_shm_damage(p_link, p_nativesurface, slot, buf_ref->name);
+#ifdef IVI_SHARE_GBM
+    else if (p_link->type == IVI_SHARE_SURFACE_TYPE_DMABUF)
+        send_dmabuf_damage(p_link->resource, p_nativesurface, buf_ref->name);
+#endif
+    else
+        send_damage(p_link->resource, p_nativesurface->id, buf_ref->name);
+}
 
-    buf_ref->name = name;
-    weston_buffer_reference(&buf_ref->ref, p_nativesurface->surface->buffer_ref.buffer);
+/* Sends the buffer in the given slot to all consumers, or only to target if
+ * it is not NULL. Consumers limited by set_max_frame_rate get it later. */
+static void
+send_damage_to_clients(struct ivi_share_nativesurface *p_nativesurface, int slot,
+                       uint32_t name,
+                       struct ivi_share_nativesurface_client_link *target)
+{
+    struct ivi_share_nativesurface_client_link *p_link = NULL;
+    struct ivi_share_buffer_reference *buf_ref = &p_nativesurface->buffer_refs[slot];
+    uint32_t now = get_monotonic_msec();
+    uint32_t sent = 0;
+
+    if (buf_ref->name != name) {
+        if (p_nativesurface->bufferType == IVI_SHARE_SURFACE_TYPE_SHM) {
+            /* the content is copied, the producer buffer is not held */
+            int ret = copy_to_shm_slot(p_nativesurface, slot);
+            if (ret < 0)
+                return;
+
+            if (ret > 0) {
+                /* new memory behind the slot, announce it again */
+                wl_list_for_each(p_link, &p_nativesurface->client_list, link)
+                    p_link->shm_slots_sent &= ~IVI_BIT(slot);
+            }
+        } else {
+            weston_buffer_reference(&buf_ref->ref, p_nativesurface->surface->buffer_ref.buffer);
+        }
+        buf_ref->name = name;
+    }
 
     wl_list_for_each(p_link, &p_nativesurface->client_list, link)
     {
-        if (wl_resource_get_version(p_link->resource) >= IVI_SHARE_SURFACE_RELEASE_SHARED_NAME_SINCE_VERSION)
-            buf_ref->client_count++;
+        if ((target != NULL) && (p_link != target))
+            continue;
 
-        send_damage(p_link->resource, p_nativesurface->id, buf_ref->name);
+        pixman_region32_union(&p_link->damage, &p_link->damage,
+                              &p_nativesurface->damage);
+        if ((target == NULL) && is_frame_throttled(p_link, now))
+            continue;
+
+        send_frame_to_client(p_link, p_nativesurface, slot, now);
+        sent++;
+    }
+
+    if (sent == 0) {
+        /* every consumer is throttled, do not keep the buffer from the
+         * producer */
+        destroy_buffer_ref(buf_ref, false);
+    }
+
+    if (target == NULL) {
+        pixman_region32_clear(&p_nativesurface->damage);
+        if (sent != 0) {
+            p_nativesurface->frames_skipped = 0;
+            p_nativesurface->total_frames_sent++;
+        }
     }
 }
 
 static void
-update_buffer_refs(struct ivi_share_nativesurface *p_nativesurface)
+update_buffer_refs(struct ivi_share_nativesurface *p_nativesurface, bool new_frame)
 {
     uint32_t name = get_buffer_name(p_nativesurface);
     int i;
@@ -692,15 +1407,48 @@ update_buffer_refs(struct ivi_share_nativesurface *p_nativesurface)
     }
 
     for (i = 0; i < MAX_BUFFER_REFERENCE; i++) {
-        struct ivi_share_buffer_reference *buffer_ref = &p_nativesurface->buffer_refs[i];
-        if (buffer_ref->name == name)
+        if (p_nativesurface->buffer_refs[i].name == name) {
+            p_nativesurface->damage_pending = false;
             return;
+        }
+    }
+
+    for (i = 0; i < (int)p_nativesurface->buffer_ref_depth; i++) {
+        struct ivi_share_buffer_reference *buffer_ref = &p_nativesurface->buffer_refs[i];
 
         if (buffer_ref->client_count == 0) {
-            send_damage_to_clients(p_nativesurface, buffer_ref, name);
-            if (!existance_next_to_release)
+            send_damage_to_clients(p_nativesurface, i, name, NULL);
+            if (!existance_next_to_release && (buffer_ref->name != 0))
                 buffer_ref->next_to_release = true;
 
+            p_nativesurface->damage_pending = false;
+            return;
+        }
+    }
+
+    /* all buffers are held by consumers, deliver the latest buffer as soon
+     * as one is released */
+    if (new_frame) {
+        p_nativesurface->frames_skipped++;
+        p_nativesurface->total_frames_skipped++;
+    }
+    p_nativesurface->damage_pending = true;
+}
+
+/* sends the buffer which is already shared with the other consumers */
+static void
+send_current_buffer(struct ivi_share_nativesurface *p_nativesurface,
+                    struct ivi_share_nativesurface_client_link *client_link)
+{
+    uint32_t name = get_buffer_name(p_nativesurface);
+    int i;
+
+    if ((name == 0) || !client_link->firstSendConfigureComp)
+        return;
+
+    for (i = 0; i < MAX_BUFFER_REFERENCE; i++) {
+        if (p_nativesurface->buffer_refs[i].name == name) {
+            send_damage_to_clients(p_nativesurface, i, name, client_link);
             return;
         }
     }
@@ -728,45 +1476,17 @@ send_to_client(struct ivi_share_nativesurface *p_nativesurface, uint32_t send_fl
     {
         if ((!p_link->firstSendConfigureComp) ||
             (IVI_SHAREBUFFER_CONFIGURE & send_flag) == IVI_SHAREBUFFER_CONFIGURE) {
-            send_configure(p_link->resource, p_nativesurface->id,
+            send_configure(p_link, p_nativesurface->id,
                            p_nativesurface);
             p_link->firstSendConfigureComp = true;
+            p_link->damage_full = true;
         }
     }
 
     if ((IVI_SHAREBUFFER_DAMAGE & send_flag) == IVI_SHAREBUFFER_DAMAGE) {
-        update_buffer_refs(p_nativesurface);
-    }
-}
-
-static void
-send_nativesurface_event(struct wl_listener *listener, void *data)
-{
-    struct update_sharing_surface_content *surface_content =
-        container_of(listener, struct update_sharing_surface_content, listener);
-    struct ivi_shell_share_ext *shell_ext = surface_content->shell_ext;
-    if (wl_list_empty(&shell_ext->list_nativesurface)) {
-        return;
-    }
-
-    struct ivi_share_nativesurface *p_nativesurface = NULL;
-    struct ivi_share_nativesurface *p_next = NULL;
-    wl_list_for_each_safe(p_nativesurface, p_next, &shell_ext->list_nativesurface, link)
-    {
-        if (NULL == p_nativesurface) {
-            continue;
-        }
-
-        if (wl_list_empty(&p_nativesurface->client_list) ||
-            (0 == p_nativesurface->id)) {
-            weston_log("Buffer Sharing warning, Unnecessary nativesurface exists.\n");
-            wl_list_remove(&p_nativesurface->link);
-            free_nativesurface(p_nativesurface);
-            continue;
-        }
-
-        p_nativesurface->send_flag = update_buffer_nativesurface(p_nativesurface);
-        send_to_client(p_nativesurface, p_nativesurface->send_flag);
+        update_buffer_refs(p_nativesurface, true);
+    } else if (p_nativesurface->damage_pending) {
+        update_buffer_refs(p_nativesurface, false);
     }
 }
 
@@ -779,7 +1499,7 @@ buffer_sharing_init(struct weston_compositor *wc,
         return -1;
     }
 
-    if (NULL == wl_global_create(wc->wl_display, &ivi_share_interface, 2,
+    if (NULL == wl_global_create(wc->wl_display, &ivi_share_interface, 8,
                                  shell_ext, bind_share_interface)) {
         weston_log("Buffer Sharing, Failed to global create\n");
         return -1;
@@ -837,20 +1557,6 @@ setup_buffer_sharing(struct weston_compositor *wc,
         return init_ret;
     }
 
-    struct weston_output *output = NULL;
-
-    wl_list_for_each(output, &wc->output_list, link) {
-        struct update_sharing_surface_content *surf_content = malloc(sizeof *surf_content);
-        if (surf_content == NULL) {
-            weston_log("Failed to allocate surf_content. Buffer Sharing can't use.\n");
-            return -1;
-        }
-
-        surf_content->shell_ext = shell_ext;
-        surf_content->listener.notify = send_nativesurface_event;
-        wl_signal_add(&output->frame_signal, &surf_content->listener);
-    }
-
     shell_ext->surface_created_listener.notify = add_weston_surf_data;
     wl_signal_add(&wc->create_surface_signal, &shell_ext->surface_created_listener);
     return 0;
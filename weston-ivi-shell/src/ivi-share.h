@@ -28,7 +28,8 @@
  */
 #define IVI_BIT(x) (1 << (x))
 
-#define MAX_BUFFER_REFERENCE 2
+#define MAX_BUFFER_REFERENCE 8     /* upper limit of the reference ring depth */
+#define DEFAULT_BUFFER_REFERENCE 2
 
 struct ivi_share_buffer_reference
 {
@@ -38,13 +39,54 @@ struct ivi_share_buffer_reference
 	bool next_to_release;
 };
 
+#define IVI_SHARE_MAX_DAMAGE_RECTS 16  /* more are sent as their extents    */
+
+#define IVI_SHARE_MAX_PLANES 4
+#define IVI_SHARE_BUFFER_CACHE_SIZE 4
+
+struct gbm_bo;
+
+struct ivi_share_dmabuf
+{
+    uint32_t format;                /* DRM fourcc                                 */
+    uint64_t modifier;
+    uint32_t n_planes;
+    int32_t fd[IVI_SHARE_MAX_PLANES]; /* -1 if not exported                       */
+    uint32_t offset[IVI_SHARE_MAX_PLANES];
+    uint32_t stride[IVI_SHARE_MAX_PLANES];
+};
+
+/* memory a shm consumer reads the copied surface content from */
+struct ivi_share_shm_slot
+{
+    int32_t fd;                     /* -1 if not allocated                        */
+    uint32_t size;
+    void *data;
+};
+
+/* import of a producer buffer, kept while the buffer is alive so that
+ * cycling through the same swapchain buffers needs no further imports */
+struct ivi_share_buffer_cache_entry
+{
+    struct weston_buffer *buffer;   /* NULL if the entry is unused                */
+    struct wl_listener buffer_destroy_listener;
+    struct gbm_bo *bo;
+    uint32_t flink_name;            /* 0 until a gbm consumer needs it            */
+    uint32_t buffer_id;             /* unique per import, names it for dmabuf     */
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    struct ivi_share_dmabuf dmabuf; /* exported on demand for dmabuf consumers    */
+    uint32_t last_used;
+};
+
 struct ivi_share_nativesurface
 {
     struct weston_surface *surface; /* resource                                   */
     uint32_t id;                    /* object id                                  */
     struct wl_list link;            /* link                                       */
     struct wl_list client_list;     /* ivi_nativesurface_client_link list         */
-    uint32_t bufferType;            /* buffer type (GBM only)                     */
+    uint32_t bufferType;            /* share type of all consumers in client_list */
     uint32_t name;                  /* buffer name                                */
     uint32_t width;                 /* buffer width                               */
     uint32_t height;                /* buffer height                              */
@@ -53,8 +95,22 @@ struct ivi_share_nativesurface
     uint32_t surface_id;
     uint32_t send_flag;
     struct wl_listener surface_destroy_listener;
+    struct wl_listener surface_commit_listener;
     struct ivi_shell_share_ext *shell_ext;
     struct ivi_share_buffer_reference buffer_refs[MAX_BUFFER_REFERENCE];
+    uint32_t buffer_ref_depth;      /* slots of buffer_refs handed out            */
+    bool damage_pending;            /* current buffer not delivered, ring full    */
+    uint32_t frames_skipped;        /* skipped since the last delivered frame     */
+    uint64_t total_frames_sent;
+    uint64_t total_frames_skipped;
+    bool committed;                 /* producer committed since the last update   */
+    struct ivi_share_shm_slot shm_slots[MAX_BUFFER_REFERENCE];
+    uint32_t shm_format;            /* wl_shm format of the copied content        */
+    uint32_t shm_frame;
+    pixman_region32_t damage;       /* buffer damage since the last sent frame    */
+    struct ivi_share_buffer_cache_entry buffer_cache[IVI_SHARE_BUFFER_CACHE_SIZE];
+    struct ivi_share_buffer_cache_entry *current_entry;
+    uint32_t buffer_cache_clock;
 };
 
 struct ivi_shell_share_ext
@@ -81,4 +137,16 @@ int32_t setup_buffer_sharing(struct weston_compositor *wc,
                              const struct ivi_layout_interface *interface);
 
 uint32_t get_buffer_name(struct ivi_share_nativesurface *p_nativesurface);
+
+#ifdef IVI_SHARE_GBM
+/* gbm and dmabuf share types, DRM backend only */
+const struct ivi_share_dmabuf *
+get_buffer_dmabuf(struct ivi_share_nativesurface *p_nativesurface);
+void release_buffer_cache(struct ivi_share_nativesurface *p_nativesurface);
 uint32_t update_buffer_nativesurface(struct ivi_share_nativesurface *p_nativesurface);
+#endif
+
+/* shm share type, works with any renderer and backend */
+uint32_t update_buffer_nativesurface_shm(struct ivi_share_nativesurface *p_nativesurface);
+int copy_to_shm_slot(struct ivi_share_nativesurface *p_nativesurface, int slot);
+void release_shm_slots(struct ivi_share_nativesurface *p_nativesurface);
@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2026 The wayland-ivi-extension contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <weston.h>
+
+#include "ivi-stats.h"
+
+static uint64_t
+get_monotonic_nsec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint32_t
+get_bucket(uint64_t ns)
+{
+    uint64_t us = ns / 1000;
+    uint32_t bucket;
+
+    if (us == 0)
+        return 0;
+
+    /* position of the highest set bit, counted from 1 */
+    bucket = 64 - __builtin_clzll(us);
+    return bucket < IVI_STATS_BUCKETS ? bucket : IVI_STATS_BUCKETS - 1;
+}
+
+static void
+destroy_client(struct ivi_stats_client *stats_client)
+{
+    wl_list_remove(&stats_client->link);
+    wl_list_remove(&stats_client->destroy_listener.link);
+    free(stats_client);
+}
+
+static void
+client_destroyed(struct wl_listener *listener, void *data)
+{
+    struct ivi_stats_client *stats_client =
+        wl_container_of(listener, stats_client, destroy_listener);
+    (void)data;
+
+    destroy_client(stats_client);
+}
+
+static struct ivi_stats_client *
+get_client(struct ivi_stats *stats, struct wl_client *client)
+{
+    struct ivi_stats_client *stats_client;
+    gid_t gid;
+    uid_t uid;
+
+    /* controllers are few and usually send bursts, keep the last one first */
+    wl_list_for_each(stats_client, &stats->clients, link) {
+        if (stats_client->client != client)
+            continue;
+
+        if (stats->clients.next != &stats_client->link) {
+            wl_list_remove(&stats_client->link);
+            wl_list_insert(&stats->clients, &stats_client->link);
+        }
+        return stats_client;
+    }
+
+    stats_client = calloc(1, sizeof *stats_client);
+    if (stats_client == NULL)
+        return NULL;
+
+    stats_client->client = client;
+    wl_client_get_credentials(client, &stats_client->pid, &uid, &gid);
+
+    stats_client->destroy_listener.notify = client_destroyed;
+    wl_client_add_destroy_listener(client, &stats_client->destroy_listener);
+    wl_list_insert(&stats->clients, &stats_client->link);
+
+    return stats_client;
+}
+
+void
+ivi_stats_init(struct ivi_stats *stats)
+{
+    wl_list_init(&stats->tables);
+    wl_list_init(&stats->clients);
+}
+
+void
+ivi_stats_release(struct ivi_stats *stats)
+{
+    struct ivi_stats_table *table, *next_table;
+    struct ivi_stats_client *stats_client, *next_client;
+
+    /* tables belong to their modules, which may unregister them later */
+    wl_list_for_each_safe(table, next_table, &stats->tables, link) {
+        wl_list_remove(&table->link);
+        wl_list_init(&table->link);
+    }
+
+    wl_list_for_each_safe(stats_client, next_client, &stats->clients, link)
+        destroy_client(stats_client);
+}
+
+int
+ivi_stats_table_init(struct ivi_stats_table *table,
+                     const struct wl_interface *interface)
+{
+    int i;
+
+    wl_list_init(&table->link);
+    table->interface = interface->name;
+    table->request_count = interface->method_count;
+    table->requests = calloc(interface->method_count,
+                             sizeof *table->requests);
+    if (table->requests == NULL) {
+        table->request_count = 0;
+        return -1;
+    }
+
+    for (i = 0; i < interface->method_count; i++)
+        table->requests[i].name = interface->methods[i].name;
+
+    return 0;
+}
+
+void
+ivi_stats_table_release(struct ivi_stats_table *table)
+{
+    wl_list_remove(&table->link);
+    wl_list_init(&table->link);
+    free(table->requests);
+    table->requests = NULL;
+    table->request_count = 0;
+}
+
+void
+ivi_stats_add_table(struct ivi_stats *stats, struct ivi_stats_table *table)
+{
+    wl_list_insert(stats->tables.prev, &table->link);
+}
+
+void
+ivi_stats_request_add(struct ivi_stats_request *request, uint64_t ns)
+{
+    request->count++;
+    request->total_ns += ns;
+    if (ns > request->max_ns)
+        request->max_ns = ns;
+    request->histogram[get_bucket(ns)]++;
+}
+
+struct ivi_stats_scope
+ivi_stats_scope_begin(struct ivi_stats *stats, struct ivi_stats_table *table,
+                      uint32_t opcode, struct wl_client *client)
+{
+    struct ivi_stats_scope scope = {
+        .stats = stats,
+        .table = table,
+        .opcode = opcode,
+        .client = client,
+        .start_ns = get_monotonic_nsec(),
+    };
+
+    return scope;
+}
+
+void
+ivi_stats_scope_end(struct ivi_stats_scope *scope)
+{
+    struct ivi_stats_request *request;
+    struct ivi_stats_client *stats_client;
+    uint64_t ns;
+
+    if (scope->opcode >= scope->table->request_count)
+        return;
+
+    ns = get_monotonic_nsec() - scope->start_ns;
+
+    request = &scope->table->requests[scope->opcode];
+    ivi_stats_request_add(request, ns);
+
+    if (scope->client == NULL || scope->stats == NULL)
+        return;
+
+    stats_client = get_client(scope->stats, scope->client);
+    if (stats_client != NULL)
+        stats_client->requests++;
+}
+
+void
+ivi_stats_log(struct ivi_stats *stats)
+{
+    struct ivi_stats_table *table;
+    struct ivi_stats_request *request;
+    struct ivi_stats_client *stats_client;
+    char line[IVI_STATS_BUCKETS * 11 + 1];
+    uint32_t i;
+    int b, len;
+
+    weston_log("ivi-controller: request statistics "
+               "(count, mean/max us, histogram of log2 us)\n");
+
+    wl_list_for_each(table, &stats->tables, link) {
+        for (i = 0; i < table->request_count; i++) {
+            request = &table->requests[i];
+            if (request->count == 0)
+                continue;
+
+            len = 0;
+            for (b = 0; b < IVI_STATS_BUCKETS; b++)
+                len += snprintf(line + len, sizeof line - len, " %u",
+                                request->histogram[b]);
+
+            weston_log_continue("  %s.%s: %llu, %llu/%llu,%s\n",
+                                table->interface, request->name,
+                                (unsigned long long)request->count,
+                                (unsigned long long)
+                                (request->total_ns / request->count / 1000),
+                                (unsigned long long)(request->max_ns / 1000),
+                                line);
+        }
+    }
+
+    wl_list_for_each(stats_client, &stats->clients, link) {
+        weston_log_continue("  client pid %d: %llu requests\n",
+                            (int)stats_client->pid,
+                            (unsigned long long)stats_client->requests);
+    }
+}
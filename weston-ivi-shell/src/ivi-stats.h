@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 The wayland-ivi-extension contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef WESTON_IVI_SHELL_SRC_IVI_STATS_H_
+#define WESTON_IVI_SHELL_SRC_IVI_STATS_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <wayland-server.h>
+
+/*
+ * Per request call counts and handler latency histograms. Every module
+ * which implements a protocol interface registers a table with one entry
+ * per request of the interface. The counters are only touched from the
+ * compositor main loop, so they are plain integers without any locking.
+ * ivi-input-controller builds its own copy of ivi-stats.c and registers
+ * its table with the ivishell it is initialized with.
+ */
+
+/* bucket 0: < 1us, bucket i: [2^(i-1), 2^i) us, the last one is open */
+#define IVI_STATS_BUCKETS 16
+
+struct ivi_stats_request {
+    const char *name;
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t histogram[IVI_STATS_BUCKETS];
+};
+
+struct ivi_stats_table {
+    struct wl_list link;
+    const char *interface;
+    uint32_t request_count;
+    struct ivi_stats_request *requests;
+};
+
+struct ivi_stats_client {
+    struct wl_list link;
+    struct wl_client *client;
+    struct wl_listener destroy_listener;
+    pid_t pid;
+    uint64_t requests;
+};
+
+struct ivi_stats {
+    struct wl_list tables;
+    struct wl_list clients;
+};
+
+struct ivi_stats_scope {
+    struct ivi_stats *stats;
+    struct ivi_stats_table *table;
+    uint32_t opcode;
+    struct wl_client *client;
+    uint64_t start_ns;
+};
+
+void
+ivi_stats_init(struct ivi_stats *stats);
+
+/* unregisters all tables and frees the client entries */
+void
+ivi_stats_release(struct ivi_stats *stats);
+
+/* one entry per request of the interface, named after the protocol */
+int
+ivi_stats_table_init(struct ivi_stats_table *table,
+                     const struct wl_interface *interface);
+
+void
+ivi_stats_table_release(struct ivi_stats_table *table);
+
+void
+ivi_stats_add_table(struct ivi_stats *stats, struct ivi_stats_table *table);
+
+/* accounts one call of the given duration */
+void
+ivi_stats_request_add(struct ivi_stats_request *request, uint64_t ns);
+
+struct ivi_stats_scope
+ivi_stats_scope_begin(struct ivi_stats *stats, struct ivi_stats_table *table,
+                      uint32_t opcode, struct wl_client *client);
+
+void
+ivi_stats_scope_end(struct ivi_stats_scope *scope);
+
+void
+ivi_stats_log(struct ivi_stats *stats);
+
+/*
+ * Accounts the rest of the enclosing block, including early returns, to
+ * the given request. Must be placed in the outermost block of a handler.
+ */
+#define IVI_STATS_SCOPE(stats, table, opcode, client) \
+    struct ivi_stats_scope ivi_stats_scope_ \
+        __attribute__((cleanup(ivi_stats_scope_end))) = \
+        ivi_stats_scope_begin((stats), (table), (opcode), (client))
+
+#endif /* WESTON_IVI_SHELL_SRC_IVI_STATS_H_ */